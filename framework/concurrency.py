@@ -0,0 +1,181 @@
+# Copyright (c) 2026 The Piglit project
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Module for sizing the pool of concurrent tests.
+
+By default concurrent tests run on as many threads as there are CPUs. With
+--adaptive-concurrency the number of tests allowed to run at once, the
+width, follows the load of the machine instead: it shrinks while more
+threads are runnable than there are CPUs or memory runs low, and grows
+while CPUs sit idle. Each test also gets a thread budget of the CPUs per
+running test, passed to drivers that spawn their own worker threads, such
+as llvmpipe.
+
+The load is sampled from /proc, so on other systems the width stays at the
+number of CPUs.
+
+"""
+
+from __future__ import (
+    absolute_import, division, print_function, unicode_literals
+)
+import collections
+import contextlib
+import multiprocessing
+import threading
+import time
+
+__all__ = [
+    'Controller',
+    'Sample',
+    'next_width',
+]
+
+#: Seconds between adjustments of the width
+INTERVAL = 1.0
+
+#: Environment variables that take the per-test thread budget
+BUDGET_VARIABLES = ['LP_NUM_THREADS']
+
+#: A sample of the machine's load
+#:
+#: busy -- fraction of CPU time spent busy since the previous sample
+#: runnable -- number of threads ready to run
+#: memory -- fraction of memory still available
+Sample = collections.namedtuple('Sample', ['busy', 'runnable', 'memory'])
+
+
+def next_width(width, max_width, cpus, sample):
+    """Return the width to use after observing sample."""
+    if sample.memory < 0.1:
+        return max(1, width // 2)
+    if sample.runnable > cpus * 1.5:
+        return max(1, width - 1)
+    if sample.busy < 0.75 and sample.runnable < cpus:
+        return min(max_width, width + 1)
+    return width
+
+
+class _ProcSampler(object):
+    """Samples the load from /proc on Linux."""
+    def __init__(self):
+        self._times = self._cpu_times()
+
+    @staticmethod
+    def _cpu_times():
+        with open('/proc/stat') as f:
+            fields = [int(x) for x in f.readline().split()[1:]]
+        # idle and iowait
+        return sum(fields), fields[3] + fields[4]
+
+    def sample(self):
+        total, idle = self._cpu_times()
+        delta_total = total - self._times[0]
+        delta_idle = idle - self._times[1]
+        self._times = (total, idle)
+
+        with open('/proc/stat') as f:
+            runnable = next(int(l.split()[1]) for l in f
+                            if l.startswith('procs_running'))
+
+        meminfo = {}
+        with open('/proc/meminfo') as f:
+            for line in f:
+                key, value = line.split(':', 1)
+                meminfo[key] = int(value.split()[0])
+
+        busy = 1.0 - delta_idle / delta_total if delta_total else 1.0
+        return Sample(busy, runnable,
+                      meminfo['MemAvailable'] / meminfo['MemTotal'])
+
+
+def _make_sampler():
+    try:
+        return _ProcSampler()
+    except (IOError, OSError, IndexError, ValueError):
+        return None
+
+
+class Controller(object):
+    """Limits how many tests run at once.
+
+    Worker threads wrap each test in slot(), which blocks while the pool is
+    at its current width.
+
+    """
+    def __init__(self, adaptive=False, cpus=None):
+        self.cpus = cpus or multiprocessing.cpu_count()
+        self.width = self.cpus
+        self.max_width = self.cpus
+        self._sampler = None
+        if adaptive:
+            self._sampler = _make_sampler()
+            if self._sampler is not None:
+                self.max_width = self.cpus * 2
+
+        self._cond = threading.Condition()
+        self._running = 0
+        self._last_adjust = time.time()
+        self._start = time.time()
+        self.completed = 0
+        self.min_seen = self.max_seen = self.width
+
+    @property
+    def adaptive(self):
+        return self._sampler is not None
+
+    @contextlib.contextmanager
+    def slot(self):
+        """Wait for room in the pool, yielding the thread budget of the
+        test, or None when not adapting."""
+        with self._cond:
+            while self._running >= self.width:
+                self._cond.wait()
+            self._running += 1
+            budget = max(1, self.cpus // self.width)
+
+        try:
+            yield budget if self.adaptive else None
+        finally:
+            with self._cond:
+                self._running -= 1
+                self.completed += 1
+                self._adjust()
+                self._cond.notify_all()
+
+    def _adjust(self):
+        now = time.time()
+        if not self.adaptive or now - self._last_adjust < INTERVAL:
+            return
+        self._last_adjust = now
+
+        try:
+            sample = self._sampler.sample()
+        except (IOError, OSError, KeyError, StopIteration, ValueError):
+            return
+        self.width = next_width(self.width, self.max_width, self.cpus,
+                                sample)
+        self.min_seen = min(self.min_seen, self.width)
+        self.max_seen = max(self.max_seen, self.width)
+
+    def throughput(self):
+        """Return the tests completed per minute."""
+        elapsed = time.time() - self._start
+        return self.completed * 60 / elapsed if elapsed else 0.0
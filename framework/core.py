@@ -42,7 +42,8 @@ __all__ = [
     'parse_listfile',
 ]
 
-PLATFORMS = ["glx", "x11_egl", "wayland", "gbm", "mixed_glx_egl"]
+PLATFORMS = ["glx", "x11_egl", "wayland", "gbm", "mixed_glx_egl",
+             "surfaceless_egl"]
 
 
 class PiglitConfig(configparser.SafeConfigParser):
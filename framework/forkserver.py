@@ -0,0 +1,327 @@
+# Copyright (c) 2026 The Piglit project
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Client for the fork server of piglit's GL test binaries.
+
+A GL test binary started with "-fork-server <socket>" stays resident and
+forks a fresh process for every request on the socket, so the cost of
+loading the binary and its libraries is paid once per binary rather than
+once per test. This module keeps a server for each binary that runs more
+than one test, up to MAX_SERVERS of them, and runs tests through it; see
+tests/util/piglit-fork-server.c for the protocol.
+
+A server is started with the runner's environment rather than with that of
+the test that happened to start it, and each forked test gets its own
+environment from the request. The window system platform is chosen once by
+the server though, so a test asking for a different PIGLIT_PLATFORM runs
+directly.
+
+"""
+
+from __future__ import (
+    absolute_import, division, print_function, unicode_literals
+)
+import atexit
+import collections
+import errno
+import os
+import select
+import shutil
+import signal
+import socket
+import subprocess
+import tempfile
+import threading
+import time
+
+import six
+
+__all__ = [
+    'ForkServerUnavailable',
+    'ForkServerTimeout',
+    'Run',
+    'run',
+]
+
+#: How long to wait for a new server to start listening, in seconds
+STARTUP_TIMEOUT = 5
+
+#: Most servers kept running at once, the least recently used one is
+#: stopped to make room for a new one
+MAX_SERVERS = 16
+
+#: Seconds a timed out test gets to exit after SIGTERM before it is killed,
+#: as in framework.test.base
+_KILL_GRACE = 1.0
+
+#: Symbol that the binaries built with PIGLIT_GL_TEST_CONFIG_BEGIN refer to
+_HOOK = b'piglit_gl_fork_server'
+
+#: The outcome of a test run through a fork server
+Run = collections.namedtuple('Run', ['pid', 'out', 'err', 'returncode',
+                                     'utime', 'stime', 'maxrss'])
+
+
+class ForkServerUnavailable(Exception):
+    """The binary can't be run through a fork server, run it directly."""
+
+
+class ForkServerTimeout(Exception):
+    """The test exceeded its timeout and was killed."""
+    def __init__(self, out, err):
+        super(ForkServerTimeout, self).__init__()
+        self.out = out
+        self.err = err
+
+
+class _Server(object):
+    """A running fork server for one binary.
+
+    users counts the runs in progress, a server that is evicted while it has
+    users is stopped by the last of them.
+
+    """
+    def __init__(self, binary, cwd, env):
+        self.users = 0
+        self.evicted = False
+        self.dir = tempfile.mkdtemp(prefix='piglit-fork-server-')
+        self.socket = os.path.join(self.dir, 'socket')
+        try:
+            with open(os.devnull, 'w') as null:
+                self.proc = subprocess.Popen(
+                    [binary, '-fork-server', self.socket],
+                    stdin=null, stdout=null, stderr=null, cwd=cwd, env=env)
+        except OSError:
+            shutil.rmtree(self.dir, ignore_errors=True)
+            raise
+
+        deadline = time.time() + STARTUP_TIMEOUT
+        while not os.path.exists(self.socket):
+            if self.proc.poll() is not None or time.time() > deadline:
+                self.stop()
+                raise ForkServerUnavailable()
+            time.sleep(0.01)
+
+    def stop(self):
+        if self.proc.poll() is None:
+            self.proc.kill()
+            self.proc.wait()
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+
+def _has_hook(binary):
+    """Return whether binary can serve test runs.
+
+    Binaries that don't use the GL test framework would run as a normal
+    test with "-fork-server <socket>" as their arguments, until
+    STARTUP_TIMEOUT, so they are recognized by the hook's symbol instead.
+
+    """
+    try:
+        with open(binary, 'rb') as f:
+            return _HOOK in f.read()
+    except (IOError, OSError):
+        return False
+
+
+# _LOCK protects the module state below, each binary's lock is held while
+# its server starts so that other binaries aren't held up
+_LOCK = threading.Lock()
+_STARTING = collections.defaultdict(threading.Lock)
+_SERVERS = collections.OrderedDict()
+_SEEN = set()
+_UNAVAILABLE = set()
+
+
+def _get_server(binary, cwd, env):
+    """Return the server for binary, starting it if needed.
+
+    The first test of a binary runs directly, as does every test of a
+    binary that only runs one. A binary whose server fails to start is
+    remembered and never tried again. The caller must hand the server back
+    with _release().
+
+    """
+    with _LOCK:
+        if binary in _UNAVAILABLE:
+            raise ForkServerUnavailable()
+        if binary not in _SEEN:
+            _SEEN.add(binary)
+            raise ForkServerUnavailable()
+        starting = _STARTING[binary]
+
+    with starting:
+        with _LOCK:
+            server = _SERVERS.pop(binary, None)
+            if server is not None:
+                _SERVERS[binary] = server
+                server.users += 1
+
+        if server is None:
+            try:
+                if not _has_hook(binary):
+                    raise ForkServerUnavailable()
+                server = _Server(binary, cwd, env)
+            except (OSError, ForkServerUnavailable):
+                with _LOCK:
+                    _UNAVAILABLE.add(binary)
+                raise ForkServerUnavailable()
+
+            evicted = []
+            with _LOCK:
+                server.users += 1
+                _SERVERS[binary] = server
+                while len(_SERVERS) > MAX_SERVERS:
+                    old = _SERVERS.popitem(last=False)[1]
+                    old.evicted = True
+                    if not old.users:
+                        evicted.append(old)
+            for old in evicted:
+                old.stop()
+
+    if server.proc.poll() is not None:
+        _release(server)
+        raise ForkServerUnavailable()
+    return server
+
+
+def _release(server):
+    """Hand back a server returned by _get_server()."""
+    with _LOCK:
+        server.users -= 1
+        stop = server.evicted and not server.users
+    if stop:
+        server.stop()
+
+
+@atexit.register
+def _stop_servers():
+    with _LOCK:
+        for server in six.itervalues(_SERVERS):
+            server.stop()
+        _SERVERS.clear()
+        _SEEN.clear()
+        _UNAVAILABLE.clear()
+
+
+def _encode(value):
+    if isinstance(value, six.text_type):
+        value = value.encode('utf-8')
+    return value + b'\0'
+
+
+def _read_file(path):
+    with open(path, 'rb') as f:
+        return f.read()
+
+
+def _signal(pid, sig):
+    try:
+        os.killpg(pid, sig)
+    except OSError:
+        # The test may not have created its session yet.
+        try:
+            os.kill(pid, sig)
+        except OSError as e:
+            if e.errno != errno.ESRCH:
+                raise
+
+
+def _kill(pid, sock):
+    """Stop the test pid, which has outlived its timeout.
+
+    It gets SIGTERM, then SIGKILL once the server reports that it exited, by
+    replying on sock, or _KILL_GRACE runs out, whichever comes first.
+
+    """
+    _signal(pid, signal.SIGTERM)
+    select.select([sock], [], [], _KILL_GRACE)
+    _signal(pid, signal.SIGKILL)
+
+
+def run(command, cwd, env, timeout=None, server_env=None):
+    """Run command through the fork server of command[0].
+
+    env is the environment of the test, server_env the one a new server is
+    started with, os.environ by default. Returns a Run. Raises
+    ForkServerUnavailable if the test should be run directly instead, and
+    ForkServerTimeout if it didn't finish within timeout seconds.
+
+    """
+    if server_env is None:
+        server_env = os.environ
+    if env.get('PIGLIT_PLATFORM') != server_env.get('PIGLIT_PLATFORM'):
+        raise ForkServerUnavailable()
+
+    cwd = cwd or os.getcwd()
+    server = _get_server(command[0], cwd, server_env)
+    try:
+        return _run(server, command, cwd, env, timeout)
+    finally:
+        _release(server)
+
+
+def _run(server, command, cwd, env, timeout):
+    """Run command through server, see run()."""
+    fd, out_path = tempfile.mkstemp(dir=server.dir, suffix='.out')
+    os.close(fd)
+    fd, err_path = tempfile.mkstemp(dir=server.dir, suffix='.err')
+    os.close(fd)
+
+    request = [cwd, out_path, err_path, str(len(command))] + list(command)
+    request += ['{}={}'.format(k, v) for k, v in six.iteritems(env)]
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    reply = sock.makefile('rb')
+    try:
+        try:
+            sock.connect(server.socket)
+            sock.sendall(b''.join(_encode(f) for f in request))
+            sock.shutdown(socket.SHUT_WR)
+
+            # The pid comes back right away, the rest when the test exits.
+            pid = int(reply.readline().split()[1])
+        except (socket.error, IndexError, ValueError):
+            raise ForkServerUnavailable()
+
+        sock.settimeout(timeout)
+        try:
+            fields = dict(l.decode('utf-8').split(' ', 1)
+                          for l in reply.read().splitlines())
+        except socket.timeout:
+            _kill(pid, sock)
+            raise ForkServerTimeout(_read_file(out_path),
+                                    _read_file(err_path))
+
+        if 'exit' in fields:
+            returncode = int(fields['exit'])
+        elif 'signal' in fields:
+            returncode = -int(fields['signal'])
+        else:
+            raise ForkServerUnavailable()
+        utime, stime, maxrss = fields.get('rusage', '0 0 0').split()
+
+        return Run(pid, _read_file(out_path), _read_file(err_path),
+                   returncode, float(utime), float(stime), int(maxrss))
+    finally:
+        reply.close()
+        sock.close()
+        os.unlink(out_path)
+        os.unlink(err_path)
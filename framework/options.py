@@ -172,12 +172,17 @@ class _Options(object):  # pylint: disable=too-many-instance-attributes
 
     Options are as follows:
     concurrent -- True if concurrency is to be used
+    adaptive_concurrency -- True to size the concurrent pool from the load
     execute -- False for dry run
     include_filter -- list of compiled regex which include exclusively tests
                       that match
     exclude_filter -- list of compiled regex which exclude tests that match
     valgrind -- True if valgrind is to be used
     dmesg -- True if dmesg checking is desired. This forces concurrency off
+    trace -- directory to collect the startup traces of tests in, or None
+    fork_server -- True if GL tests are to be run through fork servers
+    output_limit -- bytes of stdout and stderr kept per test, 0 for all
+    output_dir -- directory to write the full output over the limit to
     env -- environment variables set for each test before run
 
     """
@@ -186,6 +191,7 @@ class _Options(object):  # pylint: disable=too-many-instance-attributes
 
     def __init__(self):
         self.concurrent = True
+        self.adaptive_concurrency = False
         self.execute = True
         self._include_filter = _ReList()
         self._exclude_filter = _ReList()
@@ -193,6 +199,10 @@ class _Options(object):  # pylint: disable=too-many-instance-attributes
         self.valgrind = False
         self.dmesg = False
         self.sync = False
+        self.trace = None
+        self.fork_server = False
+        self.output_limit = 0
+        self.output_dir = None
 
         # env is used to set some base environment variables that are not going
         # to change across runs, without sending them to os.environ which is
@@ -35,10 +35,11 @@ import multiprocessing.dummy
 import importlib
 import contextlib
 import itertools
+import time
 
 import six
 
-from framework import grouptools, exceptions, options
+from framework import concurrency, grouptools, exceptions, options
 from framework.dmesg import get_dmesg
 from framework.log import LogManager
 from framework.test.base import Test
@@ -50,6 +51,14 @@ __all__ = [
 ]
 
 
+def _set_thread_budget(test, budget):
+    """Pass the thread budget to test, unless the variables are set."""
+    for name in concurrency.BUDGET_VARIABLES:
+        if (name not in os.environ and name not in options.OPTIONS.env and
+                name not in test.env):
+            test.env[name] = str(budget)
+
+
 class TestDict(dict):  # pylint: disable=too-few-public-methods
     """A special kind of dict for tests.
 
@@ -264,33 +273,53 @@ class TestProfile(object):
                 test.execute(name, log.get(), self.dmesg)
                 w(test.result)
 
-        def run_threads(pool, testlist):
+        def test_in_slot(pair):
+            """Run a test once the controller has room for it"""
+            with controller.slot() as budget:
+                if budget is not None:
+                    _set_thread_budget(pair[1], budget)
+                test(pair)
+
+        def run_threads(pool, testlist, func=test):
             """ Open a pool, close it, and join it """
-            pool.imap(test, testlist, chunksize)
+            pool.imap(func, testlist, chunksize)
             pool.close()
             pool.join()
 
         # Multiprocessing.dummy is a wrapper around Threading that provides a
         # multiprocessing compatible API
         #
-        # The default value of pool is the number of virtual processor cores
+        # The concurrent pool has a thread for the widest the controller may
+        # let it get, by default the number of virtual processor cores
+        controller = concurrency.Controller(
+            adaptive=options.OPTIONS.adaptive_concurrency)
         single = multiprocessing.dummy.Pool(1)
-        multi = multiprocessing.dummy.Pool()
+        multi = multiprocessing.dummy.Pool(controller.max_width)
+        start = time.time()
 
         if options.OPTIONS.concurrent == "all":
-            run_threads(multi, six.iteritems(self.test_list))
+            run_threads(multi, six.iteritems(self.test_list), test_in_slot)
         elif options.OPTIONS.concurrent == "none":
             run_threads(single, six.iteritems(self.test_list))
         else:
             # Filter and return only thread safe tests to the threaded pool
             run_threads(multi, (x for x in six.iteritems(self.test_list)
-                                if x[1].run_concurrent))
+                                if x[1].run_concurrent), test_in_slot)
             # Filter and return the non thread safe tests to the single pool
             run_threads(single, (x for x in six.iteritems(self.test_list)
                                  if not x[1].run_concurrent))
 
         log.get().summary()
 
+        elapsed = time.time() - start
+        if self.test_list and elapsed:
+            message = 'Throughput: {:.1f} tests/minute'.format(
+                len(self.test_list) * 60 / elapsed)
+            if controller.adaptive:
+                message += ', concurrent tests: {}-{} of {} CPUs'.format(
+                    controller.min_seen, controller.max_seen, controller.cpus)
+            print(message)
+
         self._post_run_hook()
 
     def filter_tests(self, function):
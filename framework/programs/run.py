@@ -35,6 +35,7 @@ import six
 from framework import core, backends, exceptions, options
 import framework.results
 import framework.profile
+import framework.trace
 from . import parsers
 
 __all__ = ['run',
@@ -130,6 +131,11 @@ def _run_parser(input_):
                         choices=core.PLATFORMS,
                         default=_default_platform(),
                         help="Name of windows system passed to waffle")
+    parser.add_argument("--adaptive-concurrency",
+                        action="store_true",
+                        help="Adjust the number of concurrent tests to the "
+                             "load and memory of the machine, and limit the "
+                             "threads drivers like llvmpipe start per test")
     parser.add_argument("--valgrind",
                         action="store_true",
                         help="Run tests in valgrind's memcheck")
@@ -140,6 +146,23 @@ def _run_parser(input_):
     parser.add_argument("-s", "--sync",
                         action="store_true",
                         help="Sync results to disk after every test")
+    parser.add_argument("--trace",
+                        action="store_true",
+                        help="Record the startup phases of each test and "
+                             "write them to a timeline in the results "
+                             "folder")
+    parser.add_argument("--fork-server",
+                        action="store_true",
+                        help="Keep GL test binaries resident and fork them "
+                             "for each test instead of starting them anew")
+    parser.add_argument("--output-limit",
+                        type=int,
+                        default=0,
+                        metavar="<bytes>",
+                        help="Keep only the head and tail of each test's "
+                             "stdout and stderr within this size, writing "
+                             "the full output to compressed files in the "
+                             "results folder")
     parser.add_argument("--junit_suffix",
                         type=str,
                         default="",
@@ -235,12 +258,15 @@ def run(input_):
 
     # Pass arguments into Options
     options.OPTIONS.concurrent = args.concurrency
+    options.OPTIONS.adaptive_concurrency = args.adaptive_concurrency
     options.OPTIONS.exclude_filter = args.exclude_tests
     options.OPTIONS.include_filter = args.include_tests
     options.OPTIONS.execute = args.execute
     options.OPTIONS.valgrind = args.valgrind
     options.OPTIONS.dmesg = args.dmesg
     options.OPTIONS.sync = args.sync
+    options.OPTIONS.fork_server = args.fork_server
+    options.OPTIONS.output_limit = args.output_limit
 
     # Set the platform to pass to waffle
     options.OPTIONS.env['PIGLIT_PLATFORM'] = args.platform
@@ -263,6 +289,15 @@ def run(input_):
                 'option being set.')
     os.makedirs(args.results_path)
 
+    if args.trace:
+        options.OPTIONS.trace = path.join(args.results_path, 'traces')
+        os.mkdir(options.OPTIONS.trace)
+
+    if args.output_limit:
+        options.OPTIONS.output_dir = path.abspath(
+            path.join(args.results_path, 'output'))
+        os.mkdir(options.OPTIONS.output_dir)
+
     results = framework.results.TestrunResult()
     backends.set_meta(args.backend, results)
 
@@ -289,6 +324,11 @@ def run(input_):
     results.time_elapsed.end = time.time()
     backend.finalize({'time_elapsed': results.time_elapsed})
 
+    if options.OPTIONS.trace:
+        framework.trace.merge(options.OPTIONS.trace,
+                              path.join(args.results_path,
+                                        framework.trace.TIMELINE))
+
     print('Thank you for running Piglit!\n'
           'Results have been written to ' + args.results_path)
 
@@ -314,12 +354,20 @@ def resume(input_):
 
     results = backends.load(args.results_path)
     options.OPTIONS.concurrent = results.options['concurrent']
+    options.OPTIONS.adaptive_concurrency = results.options.get(
+        'adaptive_concurrency', False)
     options.OPTIONS.exclude_filter = results.options['exclude_filter']
     options.OPTIONS.include_filter = results.options['include_filter']
     options.OPTIONS.execute = results.options['execute']
     options.OPTIONS.valgrind = results.options['valgrind']
     options.OPTIONS.dmesg = results.options['dmesg']
     options.OPTIONS.sync = results.options['sync']
+    options.OPTIONS.trace = results.options.get('trace')
+    options.OPTIONS.fork_server = results.options.get('fork_server', False)
+    options.OPTIONS.output_limit = results.options.get('output_limit', 0)
+    # The results directory may have been moved since the run started
+    if options.OPTIONS.output_limit:
+        options.OPTIONS.output_dir = path.join(args.results_path, 'output')
 
     core.get_config(args.config_file)
 
@@ -350,5 +398,10 @@ def resume(input_):
 
     backend.finalize()
 
+    if options.OPTIONS.trace:
+        framework.trace.merge(options.OPTIONS.trace,
+                              path.join(args.results_path,
+                                        framework.trace.TIMELINE))
+
     print("Thank you for running Piglit!\n"
           "Results have been written to {0}".format(args.results_path))
@@ -27,6 +27,8 @@ from __future__ import (
 import collections
 import copy
 import datetime
+import gzip
+import os
 
 import six
 
@@ -148,7 +150,7 @@ class TestResult(object):
     """An object represting the result of a single test."""
     __slots__ = ['returncode', '_err', '_out', 'time', 'command', 'traceback',
                  'environment', 'subtests', 'dmesg', '__result', 'images',
-                 'exception', 'pid']
+                 'exception', 'pid', 'profile', 'spilled', 'probes']
     err = StringDescriptor('_err')
     out = StringDescriptor('_out')
 
@@ -163,6 +165,9 @@ class TestResult(object):
         self.traceback = None
         self.exception = None
         self.pid = None
+        self.profile = {}
+        self.spilled = {}
+        self.probes = []
         if result:
             self.result = result
         else:
@@ -203,6 +208,9 @@ class TestResult(object):
             'traceback': self.traceback,
             'dmesg': self.dmesg,
             'pid': self.pid,
+            'profile': self.profile,
+            'spilled': self.spilled,
+            'probes': self.probes,
         }
         return obj
 
@@ -222,7 +230,8 @@ class TestResult(object):
         inst = cls()
 
         for each in ['returncode', 'command', 'exception', 'environment',
-                     'time', 'traceback', 'result', 'dmesg', 'pid']:
+                     'time', 'traceback', 'result', 'dmesg', 'pid',
+                     'profile', 'spilled', 'probes']:
             if each in dict_:
                 setattr(inst, each, dict_[each])
 
@@ -239,6 +248,21 @@ class TestResult(object):
 
         return inst
 
+    def full_output(self, stream, results_dir):
+        """Return the complete 'out' or 'err' of the test.
+
+        Output that was truncated during the run is read back from the side
+        file listed in spilled, so summaries only pay for it when asked. The
+        listed paths are relative to results_dir, the results directory of
+        the run.
+
+        """
+        if stream in self.spilled:
+            with gzip.open(os.path.join(results_dir, self.spilled[stream]),
+                           'rb') as f:
+                return f.read().decode('utf-8', 'replace')
+        return getattr(self, stream)
+
     def update(self, dict_):
         """Update the results and subtests fields from a piglit test.
 
@@ -251,6 +275,8 @@ class TestResult(object):
             self.result = dict_['result']
         elif 'subtest' in dict_:
             self.subtests.update(dict_['subtest'])
+        elif 'profile' in dict_:
+            self.profile.update(dict_['profile'])
 
 
 @compat.python_2_bool_compatible
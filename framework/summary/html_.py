@@ -72,13 +72,23 @@ def _copy_static_files(destination):
                 os.path.join(destination, "result.css"))
 
 
-def _make_testrun_info(results, destination, exclude=None):
+def _results_dir(path):
+    """Return the results directory of the results file or directory path.
+
+    Paths in a result, like the spilled output, are relative to it.
+
+    """
+    path = os.path.abspath(path)
+    return path if os.path.isdir(path) else os.path.dirname(path)
+
+
+def _make_testrun_info(results, destination, results_dirs, exclude=None):
     """Create the pages for each results file."""
     exclude = exclude or {}
     result_css = os.path.join(destination, "result.css")
     index = os.path.join(destination, "index.html")
 
-    for each in results.results:
+    for each, results_dir in zip(results.results, results_dirs):
         name = escape_pathname(each.name)
         try:
             os.mkdir(os.path.join(destination, name))
@@ -121,6 +131,7 @@ def _make_testrun_info(results, destination, exclude=None):
                         'test_result.mako').render(
                             testname=key,
                             value=value,
+                            results_dir=results_dir,
                             css=os.path.relpath(result_css, temp_path),
                             index=os.path.relpath(index, temp_path)))
 
@@ -175,10 +186,11 @@ def html(results, destination, exclude):
     heavy lifting, this method just passes it a bunch of dicts and lists
     of dicts, which mako turns into pretty HTML.
     """
+    results_dirs = [_results_dir(i) for i in results]
     results = Results([backends.load(i) for i in results])
 
     _copy_static_files(destination)
-    _make_testrun_info(results, destination, exclude)
+    _make_testrun_info(results, destination, results_dirs, exclude)
     _make_comparison_pages(results, destination, exclude)
 
 
@@ -188,5 +200,6 @@ def feat(results, destination, feat_desc):
     feat_res = FeatResults([backends.load(i) for i in results], feat_desc)
 
     _copy_static_files(destination)
-    _make_testrun_info(feat_res, destination)
+    _make_testrun_info(feat_res, destination,
+                       [_results_dir(i) for i in results])
     _make_feature_info(feat_res, destination)
@@ -26,7 +26,10 @@ from __future__ import (
     absolute_import, division, print_function, unicode_literals
 )
 import errno
+import gzip
+import io
 import os
+import shutil
 import time
 import sys
 import traceback
@@ -34,12 +37,14 @@ import itertools
 import abc
 import copy
 import signal
+import tempfile
 import warnings
 
 import six
 from six.moves import range
+from six.moves.urllib.parse import quote
 
-from framework import exceptions, options
+from framework import exceptions, forkserver, options, trace
 from framework.results import TestResult
 
 # We're doing some special crazy here to make timeouts work on python 2. pylint
@@ -52,6 +57,7 @@ if six.PY2:
 
         import subprocess32 as subprocess
         _EXTRA_POPEN_ARGS = {'start_new_session': True}
+        _HAS_PASS_FDS = True
     except ImportError:
         # If there is no timeout support, fake it. Add a TimeoutExpired
         # exception and a Popen that accepts a timeout parameter (and ignores
@@ -72,12 +78,14 @@ if six.PY2:
         subprocess.TimeoutExpired = TimeoutExpired
         subprocess.Popen = Popen
         _EXTRA_POPEN_ARGS = {}
+        _HAS_PASS_FDS = False
 
         warnings.warn('Timeouts are not available')
 elif six.PY3:
     # In python3.2+ this all just works, no need for the madness above.
     import subprocess
     _EXTRA_POPEN_ARGS = {}
+    _HAS_PASS_FDS = os.name == 'posix'
 
     if sys.platform == 'win32':
         # There is no implementation in piglit to make timeouts work in
@@ -116,6 +124,91 @@ __all__ = [
 # PIGLIT_NO_TIMEOUT to anything that bool() will resolve as True
 _SUPPRESS_TIMEOUT = bool(os.environ.get('PIGLIT_NO_TIMEOUT', False))
 
+# Seconds a timed out test gets to exit after SIGTERM before it is killed
+_KILL_GRACE = 1.0
+
+
+def _stop(proc):
+    """Stop the process group of proc, which has outlived its deadline.
+
+    It gets SIGTERM, then SIGKILL once it exits or _KILL_GRACE runs out,
+    whichever comes first, so that no children are left holding the output
+    pipes open.
+
+    """
+    # XXX: This is probably broken on windows, since os.getpgid doesn't
+    # exist on windows. What is the right way to handle this?
+    try:
+        pgid = os.getpgid(proc.pid)
+        os.killpg(pgid, signal.SIGTERM)
+    except OSError:
+        proc.kill()
+        return
+
+    try:
+        proc.wait(timeout=_KILL_GRACE)
+    except subprocess.TimeoutExpired:
+        pass
+
+    try:
+        os.killpg(pgid, signal.SIGKILL)
+    except OSError as e:
+        if e.errno != errno.ESRCH:
+            raise
+
+
+def _read_bounded(file_, limit, spill_path=None, keep_piglit=False,
+                  spill_name=None):
+    """Read the head and tail of file_, at most limit bytes in all.
+
+    If the contents don't fit, a marker replaces the middle. The whole
+    contents are then compressed into spill_path, if given. The marker
+    refers to it as spill_name, which defaults to spill_path and is returned
+    as the second value. With keep_piglit the PIGLIT: lines of the middle
+    are kept, so that results reported there are not lost.
+
+    Lines are never cut in half, so the result may be somewhat shorter than
+    limit.
+
+    """
+    file_.seek(0, os.SEEK_END)
+    size = file_.tell()
+    file_.seek(0)
+    if size <= limit:
+        return file_.read(), None
+
+    head = file_.read(limit // 2)
+    head = head[:head.rfind(b'\n') + 1]
+
+    tail_start = size - limit // 2
+    file_.seek(tail_start)
+    tail = file_.read()
+    newline = tail.find(b'\n')
+    tail = tail[newline + 1:]
+    tail_start += newline + 1
+
+    kept = []
+    if keep_piglit:
+        file_.seek(len(head))
+        pos = len(head)
+        while pos < tail_start:
+            line = file_.readline()
+            pos += len(line)
+            if line.startswith(b'PIGLIT:'):
+                kept.append(line)
+
+    if spill_path:
+        file_.seek(0)
+        with gzip.open(spill_path, 'wb') as f:
+            shutil.copyfileobj(file_, f)
+        spill_name = spill_name or spill_path
+
+    marker = '[{} bytes of output omitted{}]\n'.format(
+        tail_start - len(head) - sum(len(l) for l in kept),
+        ', see ' + spill_name if spill_path else '')
+    return (head + marker.encode('utf-8') + b''.join(kept) + tail,
+            spill_name if spill_path else None)
+
 
 class TestIsSkip(exceptions.PiglitException):
     """Exception raised in is_skip() if the test is a skip."""
@@ -171,6 +264,18 @@ class Test(object):
     __slots__ = ['run_concurrent', 'env', 'result', 'cwd', '_command']
     timeout = None
 
+    # True if the test binary can serve runs with -fork-server
+    _fork_server = False
+
+    # True if the test binary writes result records to PIGLIT_RESULT_FD,
+    # which are then left in _records
+    _result_channel = False
+    _records = b''
+
+    # Prefix of the files in options.OPTIONS.output_dir that output over
+    # options.OPTIONS.output_limit is written to, or None to drop it
+    _spill_prefix = None
+
     def __init__(self, command, run_concurrent=False, timeout=None):
         assert isinstance(command, list), command
 
@@ -196,6 +301,12 @@ class Test(object):
 
         """
         log.start(path)
+        if options.OPTIONS.trace:
+            self.env['PIGLIT_TRACE'] = trace.trace_path(options.OPTIONS.trace,
+                                                        path)
+        if options.OPTIONS.output_dir:
+            self._spill_prefix = quote(path, safe='')
+
         # Run the test
         if options.OPTIONS.execute:
             try:
@@ -232,7 +343,7 @@ class Test(object):
         elif self.result.returncode != 0:
             if self.result.result == 'pass':
                 self.result.result = 'warn'
-            else:
+            elif self.result.result != 'timeout':
                 self.result.result = 'fail'
 
     def run(self):
@@ -303,15 +414,45 @@ class Test(object):
                                           six.iteritems(self.env)):
             fullenv[key] = str(value)
 
+        # Tests built on the piglit framework stop themselves just before
+        # the deadline, with a backtrace, rather than getting killed.
+        deadline = None
+        if self.timeout and not _SUPPRESS_TIMEOUT:
+            deadline = time.time() + self.timeout
+            fullenv['PIGLIT_DEADLINE'] = '{:.3f}'.format(deadline)
+
+        if (self._fork_server and options.OPTIONS.fork_server and
+                not options.OPTIONS.valgrind):
+            try:
+                self._run_forked(fullenv, deadline)
+                return
+            except forkserver.ForkServerUnavailable:
+                pass
+
+        popen_args = dict(_EXTRA_POPEN_ARGS)
+        channel = None
+        if self._result_channel and _HAS_PASS_FDS:
+            channel = tempfile.TemporaryFile()
+            fullenv['PIGLIT_RESULT_FD'] = str(channel.fileno())
+            popen_args['pass_fds'] = (channel.fileno(),)
+
+        # With an output limit the output goes to files rather than into
+        # memory, and only what is kept of it is read back.
+        captures = None
+        if options.OPTIONS.output_limit:
+            captures = {'out': tempfile.TemporaryFile(),
+                        'err': tempfile.TemporaryFile()}
 
         try:
             proc = subprocess.Popen(self.command,
-                                    stdout=subprocess.PIPE,
-                                    stderr=subprocess.PIPE,
+                                    stdout=(captures['out'] if captures
+                                            else subprocess.PIPE),
+                                    stderr=(captures['err'] if captures
+                                            else subprocess.PIPE),
                                     cwd=self.cwd,
                                     env=fullenv,
                                     universal_newlines=True,
-                                    **_EXTRA_POPEN_ARGS)
+                                    **popen_args)
 
             self.result.pid = proc.pid
             if not _SUPPRESS_TIMEOUT:
@@ -332,28 +473,101 @@ class Test(object):
             # 3.x, since # TimeoutExpired is never raised by the python 2.7
             # fallback code.
 
-            proc.terminate()
-
-            # XXX: This is probably broken on windows, since os.getpgid doesn't
-            # exist on windows. What is the right way to handle this?
-            if proc.poll() is None:
-                time.sleep(3)
-                os.killpg(os.getpgid(proc.pid), signal.SIGKILL)
+            _stop(proc)
 
             # Since the process isn't running it's safe to get any remaining
             # stdout/stderr values out and store them.
-            self.result.out, self.result.err = proc.communicate()
-
-            raise TestRunError(
-                'Test run time exceeded timeout value ({} seconds)\n'.format(
-                    self.timeout),
-                'timeout')
+            out, err = proc.communicate()
+            if captures is None:
+                self.result.out, self.result.err = out, err
+
+            raise self._timeout_error(deadline)
+        finally:
+            if channel is not None:
+                channel.seek(0)
+                self._records = channel.read()
+                channel.close()
+            if captures is not None:
+                for stream, file_ in six.iteritems(captures):
+                    self._set_output(stream, file_)
+                    file_.close()
 
         # The setter handles the bytes/unicode conversion
-        self.result.out = out
-        self.result.err = err
+        if captures is None:
+            self.result.out = out
+            self.result.err = err
         self.result.returncode = returncode
 
+    def _set_output(self, stream, file_):
+        """ Store the output in file_ as result.out or result.err
+
+        Only the head and tail within options.OPTIONS.output_limit are kept,
+        the full output is compressed into a side file listed in
+        result.spilled. The listed path is relative to the results directory,
+        which options.OPTIONS.output_dir is a subdirectory of, so that the
+        results can be moved.
+
+        """
+        spill_path = spill_name = None
+        if self._spill_prefix:
+            spill_name = '{}.{}.gz'.format(self._spill_prefix, stream)
+            spill_path = os.path.join(options.OPTIONS.output_dir, spill_name)
+            spill_name = os.path.join(
+                os.path.basename(options.OPTIONS.output_dir), spill_name)
+
+        # Without records PIGLIT: lines carry the results
+        data, spilled = _read_bounded(
+            file_, options.OPTIONS.output_limit, spill_path,
+            keep_piglit=(stream == 'out' and not self._records),
+            spill_name=spill_name)
+        setattr(self.result, stream, data)
+        if spilled:
+            self.result.spilled[stream] = spilled
+
+    def _run_forked(self, fullenv, deadline):
+        """ Run the test command through the fork server of its binary
+
+        Raises forkserver.ForkServerUnavailable if the command has to be run
+        directly instead.
+
+        """
+        # The server outlives this test, so it only gets the environment
+        # that all tests share.
+        server_env = dict()
+        for key, value in itertools.chain(six.iteritems(os.environ),
+                                          six.iteritems(options.OPTIONS.env)):
+            server_env[key] = str(value)
+
+        try:
+            run = forkserver.run(self.command, self.cwd, fullenv,
+                                 None if _SUPPRESS_TIMEOUT else self.timeout,
+                                 server_env=server_env)
+        except forkserver.ForkServerTimeout as e:
+            self.result.out, self.result.err = e.out, e.err
+            raise self._timeout_error(deadline)
+
+        self.result.pid = run.pid
+        if options.OPTIONS.output_limit:
+            self._set_output('out', io.BytesIO(run.out))
+            self._set_output('err', io.BytesIO(run.err))
+        else:
+            self.result.out = run.out
+            self.result.err = run.err
+        self.result.returncode = run.returncode
+
+    def _timeout_error(self, deadline):
+        """ Return the TestRunError for a test stopped at deadline
+
+        How long the test outlived its deadline is part of the message, as
+        that time is wasted.
+
+        """
+        return TestRunError(
+            'Test run time exceeded timeout value ({} seconds), stopped '
+            '{:.2f} seconds after it\n'.format(
+                self.timeout, time.time() - deadline),
+            'timeout')
+
     def __eq__(self, other):
         return self.command == other.command
 
@@ -25,7 +25,9 @@
 from __future__ import (
     absolute_import, division, print_function, unicode_literals
 )
+import collections
 import os
+import struct
 import sys
 import glob
 try:
@@ -38,10 +40,12 @@ from .base import Test, WindowResizeMixin, ValgrindMixin, TestIsSkip
 
 
 __all__ = [
+    'PiglitBaseTest',
     'PiglitCLTest',
     'PiglitGLTest',
     'CL_CONCURRENT',
     'TEST_BIN_DIR',
+    'parse_records',
 ]
 
 if 'PIGLIT_BUILD_DIR' in os.environ:
@@ -53,6 +57,35 @@ else:
 CL_CONCURRENT = (not sys.platform.startswith('linux') or
                  glob.glob('/dev/dri/render*'))
 
+# Record types and header of the result channel, see piglit-util.h
+RECORD_RESULT = 1
+RECORD_SUBTEST = 2
+RECORD_TIME = 3
+RECORD_PROBE = 4
+RECORD_TIMEOUT = 5
+_RECORD_HEADER = struct.Struct(str('=BBHIq'))
+# Indexed by enum piglit_result
+_RECORD_RESULTS = ['pass', 'fail', 'skip', 'warn']
+
+Record = collections.namedtuple('Record', ['type', 'result', 'value', 'text'])
+
+
+def parse_records(data):
+    """Split the contents of a result channel into a list of Records."""
+    records = []
+    offset = 0
+    while offset + _RECORD_HEADER.size <= len(data):
+        type_, result, size, _, value = _RECORD_HEADER.unpack_from(data,
+                                                                   offset)
+        offset += _RECORD_HEADER.size
+        text = data[offset:offset + size].decode('utf-8', 'replace')
+        offset += size
+
+        if result < len(_RECORD_RESULTS):
+            result = _RECORD_RESULTS[result]
+        records.append(Record(type_, result, value, text))
+    return records
+
 
 class PiglitBaseTest(ValgrindMixin, Test):
     """
@@ -60,7 +93,14 @@ class PiglitBaseTest(ValgrindMixin, Test):
 
     Expect one line prefixed PIGLIT: in the output, which contains a result
     dictionary. The plain output is appended to this dictionary
+
+    When the test wrote records to the result channel, the results and
+    subtests are taken from those instead, the subtest run times are stored
+    in the profile and the probe failures in probes. Unlike the output, the
+    probe failures are never cut by the output limit.
     """
+    _result_channel = True
+
     def __init__(self, command, run_concurrent=True, **kwargs):
         super(PiglitBaseTest, self).__init__(command, run_concurrent, **kwargs)
 
@@ -71,6 +111,28 @@ class PiglitBaseTest(ValgrindMixin, Test):
         outlines = self.result.out.split('\n')
         outpiglit = (s[7:] for s in outlines if s.startswith('PIGLIT:'))
 
+        records = parse_records(self._records)
+        if records:
+            for record in records:
+                if record.type == RECORD_RESULT:
+                    self.result.result = record.result
+                elif record.type == RECORD_TIMEOUT:
+                    self.result.result = 'timeout'
+                    if record.text:
+                        self.result.subtests[record.text] = 'timeout'
+                elif record.type == RECORD_SUBTEST:
+                    self.result.subtests[record.text] = record.result
+                elif record.type == RECORD_TIME:
+                    self.result.profile['time: ' + record.text] = \
+                        record.value / 1e9
+                elif record.type == RECORD_PROBE:
+                    self.result.probes.append(record.text)
+
+            # Only the lines the records don't carry need decoding
+            outpiglit = (
+                s for s in outpiglit
+                if not s.startswith((' {"result"', ' {"subtest"')))
+
         # FIXME: handle this properly. It needs a method in TestResult probably
         for piglit in outpiglit:
             self.result.update(json.loads(piglit))
@@ -97,6 +159,8 @@ class PiglitGLTest(WindowResizeMixin, PiglitBaseTest):
     options are mutually exclusive.
 
     """
+    _fork_server = True
+
     def __init__(self, command, require_platforms=None, exclude_platforms=None,
                  **kwargs):
         # TODO: There is a design flaw in python2, keyword args can be
@@ -146,8 +210,13 @@ class PiglitGLTest(WindowResizeMixin, PiglitBaseTest):
 
     @PiglitBaseTest.command.getter
     def command(self):
-        """ Automatically add -auto and -fbo as appropriate """
-        if not self.run_concurrent:
+        """ Automatically add -auto and -fbo as appropriate
+
+        Without a window system every test has to draw to an FBO.
+
+        """
+        platform = options.OPTIONS.env.get('PIGLIT_PLATFORM')
+        if not self.run_concurrent and platform != 'surfaceless_egl':
             return super(PiglitGLTest, self).command + ['-auto']
         else:
             return super(PiglitGLTest, self).command + ['-auto', '-fbo']
@@ -0,0 +1,93 @@
+# Copyright (c) 2026 The Piglit project
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Module for collecting the startup traces of test binaries.
+
+When PIGLIT_TRACE names a file, piglit's GL test binaries write the time
+spent in each startup phase to it as a Chrome trace. With --trace the runner
+gives every test its own trace file, and merges them into one timeline, which
+can be loaded in chrome://tracing or Perfetto, at the end of the run.
+
+"""
+
+from __future__ import (
+    absolute_import, division, print_function, unicode_literals
+)
+import json
+import os
+
+from six.moves.urllib.parse import quote, unquote
+
+__all__ = [
+    'TIMELINE',
+    'merge',
+    'trace_path',
+]
+
+#: Name of the merged timeline in the results directory
+TIMELINE = 'trace.json'
+
+
+def trace_path(directory, name):
+    """Return the path of the trace file for the test called name."""
+    return os.path.join(directory, quote(name, safe='') + '.json')
+
+
+def merge(directory, out_path):
+    """Merge the trace files in directory into out_path.
+
+    Each test becomes a process of the timeline, named after the test. The
+    pids recorded by the tests are replaced with one synthetic pid per trace
+    file, since the operating system reuses pids across a run. Trace files
+    that can't be read, for example because the test crashed while writing
+    it, are skipped.
+
+    """
+    events = []
+    pid = 0
+
+    for filename in sorted(os.listdir(directory)):
+        if not filename.endswith('.json'):
+            continue
+
+        try:
+            with open(os.path.join(directory, filename), 'r') as f:
+                test_events = json.load(f)['traceEvents']
+        except (IOError, ValueError, KeyError, TypeError):
+            continue
+
+        if not test_events:
+            continue
+
+        pid += 1
+        events.append({
+            'name': 'process_name',
+            'ph': 'M',
+            'pid': pid,
+            'args': {'name': unquote(filename[:-len('.json')])},
+        })
+        for event in test_events:
+            if event.get('ph') == 'M' and event.get('name') == 'process_name':
+                continue
+            event['pid'] = pid
+            events.append(event)
+
+    with open(out_path, 'w') as f:
+        json.dump({'traceEvents': events, 'displayTimeUnit': 'ms'}, f)
@@ -1,3 +1,7 @@
+<%!
+  import os.path
+  from six.moves.urllib.parse import quote
+%>
 <?xml version="1.0" encoding="UTF-8"?>
 <!DOCTYPE html PUBLIC "-//W3C//DTD XHTML 1.0 Strict//END"
  "http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd">
@@ -53,14 +57,28 @@
         <td>Stdout</td>
         <td>
           <pre>${value.out | h}</pre>
+        % if 'out' in value.spilled:
+          <a href="file://${quote(os.path.join(results_dir, value.spilled['out']))}">Full output</a>
+        % endif
         </td>
       </tr>
       <tr>
         <td>Stderr</td>
         <td>
           <pre>${value.err | h}</pre>
+        % if 'err' in value.spilled:
+          <a href="file://${quote(os.path.join(results_dir, value.spilled['err']))}">Full output</a>
+        % endif
         </td>
       </tr>
+    % if value.probes:
+      <tr>
+        <td>Probe failures</td>
+        <td>
+          <pre>${'\n'.join(value.probes) | h}</pre>
+        </td>
+      </tr>
+    % endif
     % if value.environment:
       <tr>
         <td>Environment</td>
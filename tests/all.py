@@ -12,8 +12,9 @@ from six.moves import range
 
 from framework import grouptools
 from framework.profile import TestProfile
-from framework.test import (PiglitGLTest, GleanTest, ShaderTest,
-                            GLSLParserTest, GLSLParserNoConfigError)
+from framework.test import (PiglitGLTest, PiglitBaseTest, GleanTest,
+                            ShaderTest, GLSLParserTest,
+                            GLSLParserNoConfigError)
 from .py_modules.constants import TESTS_DIR, GENERATED_TESTS_DIR
 
 __all__ = ['profile']
@@ -2689,6 +2690,7 @@ with profile.group_manager(
       'GL_TEXTURE_INTERNAL_FORMAT query')
     g(['arb_texture_compression-invalid-formats', 'unknown'],
       'unknown formats')
+    g(['arb_texture_compression-random-blocks'], 'random blocks')
     g(['fbo-generatemipmap-formats', 'GL_ARB_texture_compression'],
       'fbo-generatemipmap-formats')
     add_texwrap_format_tests(g, 'GL_ARB_texture_compression')
@@ -3231,6 +3233,13 @@ with profile.group_manager(
       'getteximage-invalid-format-for-packed-type')
     add_msaa_formats_tests(g, 'GL_EXT_packed_float')
     add_texwrap_format_tests(g, 'GL_EXT_packed_float')
+
+# These check the packed-float codecs in tests/util and need no GL context.
+with profile.group_manager(
+        PiglitBaseTest,
+        grouptools.join('spec', 'ext_packed_float'),
+        run_concurrent=True) as g:
+    g(['ext_packed_float-codec'], 'codec')
     add_fbo_formats_tests(g, 'GL_EXT_packed_float')
 
 with profile.group_manager(
@@ -3312,6 +3321,12 @@ with profile.group_manager(
       'fbo-generatemipmap-formats')
     add_texwrap_format_tests(g, 'GL_EXT_texture_shared_exponent')
 
+with profile.group_manager(
+        PiglitBaseTest,
+        grouptools.join('spec', 'ext_texture_shared_exponent'),
+        run_concurrent=True) as g:
+    g(['ext_texture_shared_exponent-codec'], 'codec')
+
 with profile.group_manager(
         PiglitGLTest,
         grouptools.join('spec', 'ext_texture_snorm')) as g:
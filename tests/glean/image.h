@@ -63,6 +63,8 @@ class Image {
 		vbPixelSizeInBytes = 2,
 		vbPacker = 4,
 		vbUnpacker = 8,
+		vbPackerFloat = 16,
+		vbUnpackerFloat = 32,
 		vbAll = ~0
 	};
 	int _invalid;
@@ -80,6 +82,12 @@ class Image {
 	typedef void Packer(GLsizei n, char* nextPixel, double* rgba);
 	Packer* _packer;
 	Packer* validatePacker();
+	typedef void UnpackerFloat(GLsizei n, float* rgba, char* nextPixel);
+	UnpackerFloat* _unpackerFloat;
+	UnpackerFloat* validateUnpackerFloat();
+	typedef void PackerFloat(GLsizei n, char* nextPixel, float* rgba);
+	PackerFloat* _packerFloat;
+	PackerFloat* validatePackerFloat();
 
 	// For now, we will require that:
 	// 1.  All images are in native byte order (so that byte swapping
@@ -160,7 +168,9 @@ class Image {
 			  vbRowSizeInBytes
 			| vbPixelSizeInBytes
 			| vbPacker
-			| vbUnpacker);
+			| vbUnpacker
+			| vbPackerFloat
+			| vbUnpackerFloat);
 	}
 
 	inline GLenum type() const	// Pixel data type.  Currently
@@ -174,7 +184,9 @@ class Image {
 			  vbRowSizeInBytes
 			| vbPixelSizeInBytes
 			| vbPacker
-			| vbUnpacker);
+			| vbUnpacker
+			| vbPackerFloat
+			| vbUnpackerFloat);
 	}
 
 	inline char* pixels() 		// The pixels.
@@ -201,10 +213,13 @@ class Image {
 	// XXX Utilities to determine component size in bits/bytes?
 	// XXX Component range (min neg, max neg, min pos, max pos, eps?)
 
-	// Pixel packing/unpacking utilities:
+	// Pixel packing/unpacking utilities.  The float versions avoid
+	// the conversion to double when the caller doesn't need it.
 
 	void unpack(GLsizei n, double* rgba, char* nextPixel);
 	void pack(GLsizei n, char* nextPixel, double* rgba);
+	void unpack(GLsizei n, float* rgba, char* nextPixel);
+	void pack(GLsizei n, char* nextPixel, float* rgba);
 	// XXX get(x, y, double* rgba);
 	// XXX put(x, y, double* rgba);
 
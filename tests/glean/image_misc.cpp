@@ -48,6 +48,8 @@ Image::Image() {
 	_alignment = 4;
 	_packer = 0;
 	_unpacker = 0;
+	_packerFloat = 0;
+	_unpackerFloat = 0;
 	_invalid = vbAll;
 } // Image::Image
 
@@ -61,6 +63,8 @@ Image::Image(int aWidth, int aHeight, GLenum aFormat, GLenum aType) {
 	_alignment = 4;
 	_packer = 0;
 	_unpacker = 0;
+	_packerFloat = 0;
+	_unpackerFloat = 0;
 	_invalid = vbAll;
 	reserve();
 } // Image::Image(aWidth, aHeight, aFormat, aType)
@@ -76,6 +80,8 @@ Image::Image(int aWidth, int aHeight, GLenum aFormat, GLenum aType,
 	_alignment = 4;
 	_packer = 0;
 	_unpacker = 0;
+	_packerFloat = 0;
+	_unpackerFloat = 0;
 	_invalid = vbAll;
 	reserve();
 	int i;		// VC++ 6 doesn't handle the definition of variables in a 
@@ -106,6 +112,8 @@ Image::Image(Image& i) {
 	_pixels = 0;
 	_packer = 0;
 	_unpacker = 0;
+	_packerFloat = 0;
+	_unpackerFloat = 0;
 	_invalid = vbAll;
 	reserve();
 	memcpy(pixels(), i.pixels(), height() * rowSizeInBytes());
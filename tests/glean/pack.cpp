@@ -32,96 +32,160 @@
 // Data packing utilities.  Note that these map component values per
 // the usual OpenGL conversions.  Also, see comments in unpack.cpp.
 
+#include <string.h>
 #include "image.h"
 
 namespace {
 
-#define SCALE (static_cast<double>(num) / static_cast<double>(denom))
-#define BIAS (static_cast<double>(bias) / static_cast<double>(denom))
+// Component conversion, the inverse of the one in unpack.cpp:
+// (denom * v - bias) / num.
+template<class component, int num, unsigned int denom, int bias, class T>
+struct Convert
+{
+	static inline component pack(T v)
+	{
+		return static_cast<component>(
+			static_cast<double>(denom) / num * v
+			- static_cast<double>(bias) / num);
+	}
+};
+
+template<class component, int num, unsigned int denom, class T>
+struct Convert<component, num, denom, 0, T>
+{
+	static inline component pack(T v)
+	{
+		return static_cast<component>(
+			static_cast<double>(denom) / num * v);
+	}
+};
 
-// The original implementation of packing functions (using function
-// templates) wouldn't compile under VC6, but this slight variant
-// using static member functions in a class template will compile.
+// Pixel layouts.
+template<GLenum format>
+struct Pixel;
 
-template<class component, int num, unsigned int denom, int bias>
-class Pack
+template<>
+struct Pixel<GL_LUMINANCE>
 {
-public :
-	// pack_l
-	static void pack_l(GLsizei n, char* dst, double* rgba) 
+	enum { channels = 1 };
+	template<class C, class component, class T>
+	static inline void pack(component* out, const T* rgba)
 	{
-		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias)
-				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
-			else
-				out[0] = static_cast<component>(SCALE * rgba[0]);
-			out += 1;
-		}
+		out[0] = C::pack(rgba[0]);
 	}
+};
 
-	// pack_la
-	static void pack_la(GLsizei n, char* dst, double* rgba) 
+template<>
+struct Pixel<GL_LUMINANCE_ALPHA>
+{
+	enum { channels = 2 };
+	template<class C, class component, class T>
+	static inline void pack(component* out, const T* rgba)
 	{
-		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
-				out[1] = static_cast<component>(SCALE * rgba[3] - BIAS);
-			} else {
-				out[0] = static_cast<component>(SCALE * rgba[0]);
-				out[1] = static_cast<component>(SCALE * rgba[3]);
-			}
-			out += 2;
-		}
+		out[0] = C::pack(rgba[0]);
+		out[1] = C::pack(rgba[3]);
 	}
+};
 
-	// pack_rga
-	static void pack_rgb(GLsizei n, char* dst, double* rgba) 
+template<>
+struct Pixel<GL_RGB>
+{
+	enum { channels = 3 };
+	template<class C, class component, class T>
+	static inline void pack(component* out, const T* rgba)
 	{
-		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
-				out[1] = static_cast<component>(SCALE * rgba[1] - BIAS);
-				out[2] = static_cast<component>(SCALE * rgba[2] - BIAS);
-			} else {
-				out[0] = static_cast<component>(SCALE * rgba[0]);
-				out[1] = static_cast<component>(SCALE * rgba[1]);
-				out[2] = static_cast<component>(SCALE * rgba[2]);
-			}
-			out += 3;
-		}
+		out[0] = C::pack(rgba[0]);
+		out[1] = C::pack(rgba[1]);
+		out[2] = C::pack(rgba[2]);
 	}
+};
 
-	// pack_rgba
-	static void pack_rgba(GLsizei n, char* dst, double* rgba) 
+template<>
+struct Pixel<GL_RGBA>
+{
+	enum { channels = 4 };
+	template<class C, class component, class T>
+	static inline void pack(component* out, const T* rgba)
+	{
+		out[0] = C::pack(rgba[0]);
+		out[1] = C::pack(rgba[1]);
+		out[2] = C::pack(rgba[2]);
+		out[3] = C::pack(rgba[3]);
+	}
+};
+
+template<GLenum format, class component, int num, unsigned int denom,
+	 int bias, class T>
+struct Pack
+{
+	static void pack(GLsizei n, char* dst, T* rgba)
 	{
+		typedef Convert<component, num, denom, bias, T> C;
 		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
-				out[1] = static_cast<component>(SCALE * rgba[1] - BIAS);
-				out[2] = static_cast<component>(SCALE * rgba[2] - BIAS);
-				out[3] = static_cast<component>(SCALE * rgba[3] - BIAS);
-			} else {
-				out[0] = static_cast<component>(SCALE * rgba[0]);
-				out[1] = static_cast<component>(SCALE * rgba[1]);
-				out[2] = static_cast<component>(SCALE * rgba[2]);
-				out[3] = static_cast<component>(SCALE * rgba[3]);
-			}
-			out += 4;
-		}
+		T* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4, out += Pixel<format>::channels)
+			Pixel<format>::template pack<C>(out, rgba);
 	}
+};
 
-};	// class Pack
+// RGBA floats packed from floats are a plain copy.
+template<>
+struct Pack<GL_RGBA, GLfloat, 1, 1, 0, GLfloat>
+{
+	static void pack(GLsizei n, char* dst, GLfloat* rgba)
+	{
+		memcpy(dst, rgba, 4 * n * sizeof(GLfloat));
+	}
+};
 
-#undef SCALE
-#undef BIAS
+template<class T>
+struct PackFunc
+{
+	typedef void type(GLsizei n, char* nextPixel, T* rgba);
+};
+
+// The template arguments are the same as for unpacking.
+template<GLenum format, class T>
+typename PackFunc<T>::type*
+selectPacker(GLenum type)
+{
+	switch (type) {
+	case GL_BYTE:
+		return Pack<format, GLbyte, 2, 255, 1, T>::pack;
+	case GL_UNSIGNED_BYTE:
+		return Pack<format, GLubyte, 1, 255, 0, T>::pack;
+	case GL_SHORT:
+		return Pack<format, GLshort, 2, 65535, 1, T>::pack;
+	case GL_UNSIGNED_SHORT:
+		return Pack<format, GLushort, 1, 65535, 0, T>::pack;
+	case GL_INT:
+		return Pack<format, GLint, 2, 4294967295U, 1, T>::pack;
+	case GL_UNSIGNED_INT:
+		return Pack<format, GLuint, 1, 4294967295U, 0, T>::pack;
+	case GL_FLOAT:
+		return Pack<format, GLfloat, 1, 1, 0, T>::pack;
+	default:
+		throw GLEAN::Image::BadType(type);
+	}
+}
+
+template<class T>
+typename PackFunc<T>::type*
+selectPacker(GLenum format, GLenum type)
+{
+	switch (format) {
+	case GL_LUMINANCE:
+		return selectPacker<GL_LUMINANCE, T>(type);
+	case GL_LUMINANCE_ALPHA:
+		return selectPacker<GL_LUMINANCE_ALPHA, T>(type);
+	case GL_RGB:
+		return selectPacker<GL_RGB, T>(type);
+	case GL_RGBA:
+		return selectPacker<GL_RGBA, T>(type);
+	default:
+		throw GLEAN::Image::BadFormat(format);
+	}
+}
 
 }; // anonymous namespace
 
@@ -136,127 +200,28 @@ Image::pack(GLsizei n, char* nextPixel, double* rgba) {
 	(*(valid(vbPacker)? _packer: validatePacker())) (n, nextPixel, rgba);
 }
 
+void
+Image::pack(GLsizei n, char* nextPixel, float* rgba) {
+	(*(valid(vbPackerFloat)? _packerFloat: validatePackerFloat()))
+		(n, nextPixel, rgba);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // validatePacker - select appropriate pixel-packing utility
 ///////////////////////////////////////////////////////////////////////////////
 
 Image::Packer*
 Image::validatePacker() {
-	switch (format()) {
-	case GL_LUMINANCE:
-		switch (type()) {
-		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_l;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_l;
-			break;
-		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_l;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_l;
-			break;
-		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_l;
-			break;
-		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_l;
-			break;
-		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_l;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_LUMINANCE_ALPHA:
-		switch (type()) {
-		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_la;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_la;
-			break;
-		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_la;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_la;
-			break;
-		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_la;
-			break;
-		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_la;
-			break;
-		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_la;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_RGB:
-		switch (type()) {
-		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_rgb;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_rgb;
-			break;
-		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_rgb;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_rgb;
-			break;
-		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_rgb;
-			break;
-		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_rgb;
-			break;
-		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_rgb;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_RGBA:
-		switch (type()) {
-		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_rgba;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_rgba;
-			break;
-		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_rgba;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_rgba;
-			break;
-		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_rgba;
-			break;
-		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_rgba;
-			break;
-		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_rgba;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	default:
-		throw BadFormat(format());
-	}
-
+	_packer = selectPacker<double>(format(), type());
 	validate(vbPacker);
 	return _packer;
 }
 
+Image::PackerFloat*
+Image::validatePackerFloat() {
+	_packerFloat = selectPacker<float>(format(), type());
+	validate(vbPackerFloat);
+	return _packerFloat;
+}
+
 }; // namespace GLEAN
@@ -71,21 +71,21 @@ Image::reg(Image& ref) {
 	int wr4 = 4 * wr;		// Width of ref image, in RGBA samples.
 	int dw4 = 4 * dw;		// Difference in widths, in samples.
 
-	double** testPix;		// Buffers containing all the rows of
+	float** testPix;		// Buffers containing all the rows of
 					// the test image that need to be
 					// accessed concurrently.
 	// XXX sure would be nice to use auto_ptr to allocate this stuff,
 	// but it isn't supported in the STL that came with egcs 1.1.2.
 	
-	// XXX testPix = new (double*) [dh + 1];
+	// XXX testPix = new (float*) [dh + 1];
 	// VC 6 seems to misinterpret this as a c-style cast
-	testPix = new double* [dh + 1];
+	testPix = new float* [dh + 1];
 
 	
 	for (/*int */i = 0; i <= dh; ++i)
-		testPix[i] = new double [wt4];
+		testPix[i] = new float [wt4];
 
-	double* refPix = new double [wr4];
+	float* refPix = new float [wr4];
 					// Buffer containing the one row of
 					// the reference image that's accessed
 					// at any given time.
@@ -31,6 +31,7 @@
 #include <cassert>
 #include <cmath>
 #include "tpixelformats.h"
+#include "image.h"
 #include "../util/rgb9e5.h"
 #include "piglit-util-gl.h"
 
@@ -783,6 +784,33 @@ MakeImage(int width, int height, GLenum format, GLenum type,
 
 		return image;
 	}
+	else if ((format == GL_RGB || format == GL_RGBA) &&
+		 type != GL_HALF_FLOAT_ARB) {
+		// Glean's Image packers handle these, a row of float RGBA
+		// at a time.
+		Image packer;
+		packer.format(format);
+		packer.type(type);
+		const int rowSize = width * packer.pixelSizeInBytes();
+		GLubyte *image = new GLubyte [height * rowSize];
+		GLfloat *rgba = new GLfloat [4 * width];
+		int x, y;
+
+		for (y = 0; y < height; y++) {
+			for (x = 0; x < width; x++) {
+				const bool fill =
+					!IsUpperRight(y * width + x, width, height);
+				rgba[4 * x + 0] = fill && fillComponent == 0;
+				rgba[4 * x + 1] = fill && fillComponent == 1;
+				rgba[4 * x + 2] = fill && fillComponent == 2;
+				rgba[4 * x + 3] = fill && fillComponent == 3;
+			}
+			packer.pack(width, (char *) image + y * rowSize, rgba);
+		}
+
+		delete [] rgba;
+		return image;
+	}
 	else {
 		const int comps = NumberOfComponentsInFormat(format);
 		const int bpp = comps * SizeofType(type);
@@ -73,6 +73,7 @@
 //
 
 #include "ttexcombine.h"
+#include "image.h"
 #include <cassert>
 #include <stdio.h>
 #include <cmath>
@@ -1170,16 +1171,20 @@ TexCombineTest::SetupColors(glmachine &machine) {
 		}
 
 		// Make a 4x4 solid color texture
-		GLfloat image[16][4];
+		Image image(4, 4, GL_RGBA, GL_FLOAT);
+		GLfloat row[4][4];
 		int i;
-		for (i = 0; i < 16; i++) {
-			image[i][0] = texColors[u % 8][0];
-			image[i][1] = texColors[u % 8][1];
-			image[i][2] = texColors[u % 8][2];
-			image[i][3] = texColors[u % 8][3];
+		for (i = 0; i < 4; i++) {
+			row[i][0] = texColors[u % 8][0];
+			row[i][1] = texColors[u % 8][1];
+			row[i][2] = texColors[u % 8][2];
+			row[i][3] = texColors[u % 8][3];
 		}
+		for (i = 0; i < 4; i++)
+			image.pack(4, image.pixels() + i * image.rowSizeInBytes(),
+				   &row[0][0]);
 		glTexImage2D(GL_TEXTURE_2D, 0, machine.TexFormat[u],
-			     4, 4, 0, GL_RGBA, GL_FLOAT, image);
+			     4, 4, 0, GL_RGBA, GL_FLOAT, image.pixels());
 
 #if 0 // Debug
 		GLfloat check[16][4];
@@ -1196,9 +1201,11 @@ TexCombineTest::SetupColors(glmachine &machine) {
 		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT,
 			      check);
 		for (i = 0;i < 16; i++) {
+			const GLfloat *texel =
+				(const GLfloat *) image.pixels() + 4 * i;
 			printf("%2d: %4f %4f %4f %4f  %4f %4f %4f %4f\n", i,
-			       image[i][0], image[i][1],
-			       image[i][2], image[i][3],
+			       texel[0], texel[1],
+			       texel[2], texel[3],
 			       check[i][0], check[i][1],
 			       check[i][2], check[i][3]);
 		}
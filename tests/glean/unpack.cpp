@@ -32,105 +32,191 @@
 // Data unpacking utilities.  Note that these map component values per
 // the usual OpenGL conventions.
 
-// XXX The construction of SCALE and BIAS is clumsy, and the need to
-// test bias is really unfortunate, but egcs 1.1.2 won't propagate
-// floating-point constant expressions from equivalent const
-// declarations.
+// Each (format, type) pair gets its own row converter, instantiated from
+// a component converter (Convert) and a pixel layout (Pixel).  Both are
+// resolved at compile time, so the inner loop has no tests on the bias
+// or the number of channels.  The converters are templated on the type
+// of the intermediate RGBA values, which may be double or float.
 
+#include <string.h>
 #include "image.h"
 
 namespace {
 
-#define SCALE (static_cast<double>(num) / static_cast<double>(denom))
-#define BIAS (static_cast<double>(bias) / static_cast<double>(denom))
-
-// See comments in pack.cpp concerning this workaround for a VC6 problem.
+// Component conversion: (num * c + bias) / denom.  Signed types use a
+// bias of 1 so that [min, max] maps onto [-1, 1].
+template<class component, int num, unsigned int denom, int bias, class T>
+struct Convert
+{
+	static inline T unpack(component c)
+	{
+		return static_cast<T>(static_cast<double>(num) / denom * c
+				      + static_cast<double>(bias) / denom);
+	}
+};
 
-template<class component, int num, unsigned int denom, int bias>
-class Unpack
+template<class component, int num, unsigned int denom, class T>
+struct Convert<component, num, denom, 0, T>
 {
-public :
-	// unpack_l
-	static void unpack_l(GLsizei n, double* rgba, char* src) 
+	static inline T unpack(component c)
 	{
-		component* in = reinterpret_cast<component*>(src);
-			// XXX It seems to me that static_cast should be sufficient,
-			// but egcs 1.1.2 thinks otherwise.
+		return static_cast<T>(static_cast<double>(num) / denom * c);
+	}
+};
 
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias)
-				rgba[0] = SCALE * in[0] + BIAS;
-			else
-				rgba[0] = SCALE * in[0];
-			rgba[1] = rgba[2] = rgba[3] = 0.0;
-			in += 1;
+// Unsigned bytes only have 256 possible values, so they go through a
+// table holding exactly what the generic conversion would produce.
+template<class T>
+struct Convert<GLubyte, 1, 255, 0, T>
+{
+	struct Table {
+		T value[256];
+		Table()
+		{
+			for (int i = 0; i < 256; ++i)
+				value[i] = static_cast<T>(1.0 / 255 * i);
 		}
+	};
+	static const Table table;
+
+	static inline T unpack(GLubyte c)
+	{
+		return table.value[c];
 	}
+};
 
-	// unpack_la
-	static void unpack_la(GLsizei n, double* rgba, char* src) 
+template<class T>
+const typename Convert<GLubyte, 1, 255, 0, T>::Table
+Convert<GLubyte, 1, 255, 0, T>::table;
+
+// Pixel layouts.  Missing components are set to zero.
+template<GLenum format>
+struct Pixel;
+
+template<>
+struct Pixel<GL_LUMINANCE>
+{
+	enum { channels = 1 };
+	template<class C, class component, class T>
+	static inline void unpack(const component* in, T* rgba)
 	{
-		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				rgba[0] = SCALE * in[0] + BIAS;
-				rgba[3] = SCALE * in[1] + BIAS;
-			} else {
-				rgba[0] = SCALE * in[0];
-				rgba[3] = SCALE * in[1];
-			}
-			rgba[1] = rgba[2] = 0.0;
-			in += 2;
-		}
+		rgba[0] = C::unpack(in[0]);
+		rgba[1] = rgba[2] = rgba[3] = 0;
 	}
+};
 
-	// unpack_rgb
-	static void unpack_rgb(GLsizei n, double* rgba, char* src) 
+template<>
+struct Pixel<GL_LUMINANCE_ALPHA>
+{
+	enum { channels = 2 };
+	template<class C, class component, class T>
+	static inline void unpack(const component* in, T* rgba)
 	{
-		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				rgba[0] = SCALE * in[0] + BIAS;
-				rgba[1] = SCALE * in[1] + BIAS;
-				rgba[2] = SCALE * in[2] + BIAS;
-			} else {
-				rgba[0] = SCALE * in[0];
-				rgba[1] = SCALE * in[1];
-				rgba[2] = SCALE * in[2];
-			}
-			rgba[3] = 0.0;
-			in += 3;
-		}
+		rgba[0] = C::unpack(in[0]);
+		rgba[1] = rgba[2] = 0;
+		rgba[3] = C::unpack(in[1]);
+	}
+};
+
+template<>
+struct Pixel<GL_RGB>
+{
+	enum { channels = 3 };
+	template<class C, class component, class T>
+	static inline void unpack(const component* in, T* rgba)
+	{
+		rgba[0] = C::unpack(in[0]);
+		rgba[1] = C::unpack(in[1]);
+		rgba[2] = C::unpack(in[2]);
+		rgba[3] = 0;
 	}
+};
 
-	// unpack_rgba
-	static void unpack_rgba(GLsizei n, double* rgba, char* src) 
+template<>
+struct Pixel<GL_RGBA>
+{
+	enum { channels = 4 };
+	template<class C, class component, class T>
+	static inline void unpack(const component* in, T* rgba)
 	{
-		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				rgba[0] = SCALE * in[0] + BIAS;
-				rgba[1] = SCALE * in[1] + BIAS;
-				rgba[2] = SCALE * in[2] + BIAS;
-				rgba[3] = SCALE * in[3] + BIAS;
-			} else {
-				rgba[0] = SCALE * in[0];
-				rgba[1] = SCALE * in[1];
-				rgba[2] = SCALE * in[2];
-				rgba[3] = SCALE * in[3];
-			}
-			in += 4;
-		}
+		rgba[0] = C::unpack(in[0]);
+		rgba[1] = C::unpack(in[1]);
+		rgba[2] = C::unpack(in[2]);
+		rgba[3] = C::unpack(in[3]);
 	}
+};
 
-};	// class Unpack
+template<GLenum format, class component, int num, unsigned int denom,
+	 int bias, class T>
+struct Unpack
+{
+	static void unpack(GLsizei n, T* rgba, char* src)
+	{
+		typedef Convert<component, num, denom, bias, T> C;
+		const component* in = reinterpret_cast<const component*>(src);
+		T* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4, in += Pixel<format>::channels)
+			Pixel<format>::template unpack<C>(in, rgba);
+	}
+};
 
-#undef SCALE
-#undef BIAS
+// RGBA floats unpacked to floats are a plain copy.
+template<>
+struct Unpack<GL_RGBA, GLfloat, 1, 1, 0, GLfloat>
+{
+	static void unpack(GLsizei n, GLfloat* rgba, char* src)
+	{
+		memcpy(rgba, src, 4 * n * sizeof(GLfloat));
+	}
+};
+
+template<class T>
+struct UnpackFunc
+{
+	typedef void type(GLsizei n, T* rgba, char* nextPixel);
+};
+
+template<GLenum format, class T>
+typename UnpackFunc<T>::type*
+selectUnpacker(GLenum type)
+{
+	switch (type) {
+	case GL_BYTE:
+		return Unpack<format, GLbyte, 2, 255, 1, T>::unpack;
+	case GL_UNSIGNED_BYTE:
+		return Unpack<format, GLubyte, 1, 255, 0, T>::unpack;
+	case GL_SHORT:
+		return Unpack<format, GLshort, 2, 65535, 1, T>::unpack;
+	case GL_UNSIGNED_SHORT:
+		return Unpack<format, GLushort, 1, 65535, 0, T>::unpack;
+	case GL_INT:
+		return Unpack<format, GLint, 2, 4294967295U, 1, T>::unpack;
+	case GL_UNSIGNED_INT:
+		return Unpack<format, GLuint, 1, 4294967295U, 0, T>::unpack;
+	case GL_FLOAT:
+		return Unpack<format, GLfloat, 1, 1, 0, T>::unpack;
+	default:
+		throw GLEAN::Image::BadType(type);
+	}
+}
+
+template<class T>
+typename UnpackFunc<T>::type*
+selectUnpacker(GLenum format, GLenum type)
+{
+	switch (format) {
+	case GL_LUMINANCE:
+		return selectUnpacker<GL_LUMINANCE, T>(type);
+	case GL_LUMINANCE_ALPHA:
+		return selectUnpacker<GL_LUMINANCE_ALPHA, T>(type);
+	case GL_RGB:
+		return selectUnpacker<GL_RGB, T>(type);
+	case GL_RGBA:
+		return selectUnpacker<GL_RGBA, T>(type);
+	default:
+		throw GLEAN::Image::BadFormat(format);
+	}
+}
 
 }; // anonymous namespace
 
@@ -146,126 +232,27 @@ Image::unpack(GLsizei n, double* rgba, char* nextPixel) {
 		(n, rgba, nextPixel);
 }
 
+void
+Image::unpack(GLsizei n, float* rgba, char* nextPixel) {
+	(*(valid(vbUnpackerFloat)? _unpackerFloat: validateUnpackerFloat()))
+		(n, rgba, nextPixel);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // validateUnpacker - select appropriate pixel-unpacking utility
 ///////////////////////////////////////////////////////////////////////////////
 Image::Unpacker*
 Image::validateUnpacker() {
-	switch (format()) {
-	case GL_LUMINANCE:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_l;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_l;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_l;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_l;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_l;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_l;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_l;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_LUMINANCE_ALPHA:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_la;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_la;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_la;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_la;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_la;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 2, 4294967295U, 0>::unpack_la;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_la;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_RGB:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_rgb;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_rgb;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_rgb;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_rgb;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_rgb;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_rgb;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_rgb;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_RGBA:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_rgba;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_rgba;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_rgba;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_rgba;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_rgba;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_rgba;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_rgba;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	default:
-		throw BadFormat(format());
-	}
-
+	_unpacker = selectUnpacker<double>(format(), type());
 	validate(vbUnpacker);
 	return _unpacker;
 }
 
+Image::UnpackerFloat*
+Image::validateUnpackerFloat() {
+	_unpackerFloat = selectUnpacker<float>(format(), type());
+	validate(vbUnpackerFloat);
+	return _unpackerFloat;
+}
+
 }; // namespace GLEAN
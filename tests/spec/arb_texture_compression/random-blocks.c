@@ -0,0 +1,281 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file random-blocks.c
+ * Check the decoding of random compressed blocks against the software
+ * codec in tests/util.
+ *
+ * For every supported format, a texture made of random blocks is
+ * uploaded and read back with glGetTexImage, and the result is compared
+ * with piglit_texcompress_decode().  Random bits reach every mode,
+ * partition and index of the formats, which fixed reference images
+ * don't.  Reserved BPTC modes are patched out since their results are
+ * not well defined.  sRGB formats are skipped because glGetTexImage may
+ * convert them to linear.
+ *
+ * The encoder is checked by compressing a smooth image, which must come
+ * back close to its original values.
+ */
+
+#include "piglit-util-gl.h"
+#include "piglit-texcompress.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_compat_version = 10;
+
+	config.window_width = 10;
+	config.window_height = 10;
+	config.window_visual = PIGLIT_GL_VISUAL_RGB;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define TEX_SIZE 256
+
+#define ENUM_AND_STRING(e) \
+	# e, e
+
+struct format_desc {
+	const char *name;
+	GLenum format;
+	/** GL version and extension that provide the format. */
+	int gl_version;
+	const char *extension;
+	/** Number of components stored by the format. */
+	unsigned components;
+	bool is_signed;
+	/** Tolerance of the decoded values. */
+	float tolerance;
+	/** Tolerance of encoding a smooth image, 0 to skip the check. */
+	float encode_tolerance;
+};
+
+static const struct format_desc formats[] = {
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGB_S3TC_DXT1_EXT), 0,
+	  "GL_EXT_texture_compression_s3tc", 3, false, 2.0 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT), 0,
+	  "GL_EXT_texture_compression_s3tc", 3, false, 2.0 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT), 0,
+	  "GL_EXT_texture_compression_s3tc", 4, false, 2.0 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT), 0,
+	  "GL_EXT_texture_compression_s3tc", 4, false, 2.0 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RED_RGTC1), 30,
+	  "GL_ARB_texture_compression_rgtc", 1, false, 2.0 / 255, 0.01 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_SIGNED_RED_RGTC1), 30,
+	  "GL_ARB_texture_compression_rgtc", 1, true, 2.0 / 127, 0.02 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RG_RGTC2), 30,
+	  "GL_ARB_texture_compression_rgtc", 2, false, 2.0 / 255, 0.01 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_SIGNED_RG_RGTC2), 30,
+	  "GL_ARB_texture_compression_rgtc", 2, true, 2.0 / 127, 0.02 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGBA_BPTC_UNORM), 42,
+	  "GL_ARB_texture_compression_bptc", 4, false, 0.5 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT), 42,
+	  "GL_ARB_texture_compression_bptc", 3, false, 0.0, 0.0 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT), 42,
+	  "GL_ARB_texture_compression_bptc", 3, true, 0.0, 0.0 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGB8_ETC2), 43,
+	  "GL_ARB_ES3_compatibility", 3, false, 0.5 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2), 43,
+	  "GL_ARB_ES3_compatibility", 3, false, 0.5 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RGBA8_ETC2_EAC), 43,
+	  "GL_ARB_ES3_compatibility", 4, false, 0.5 / 255, 0.08 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_R11_EAC), 43,
+	  "GL_ARB_ES3_compatibility", 1, false, 0.5 / 2047, 0.01 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_SIGNED_R11_EAC), 43,
+	  "GL_ARB_ES3_compatibility", 1, true, 0.5 / 1023, 0.02 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_RG11_EAC), 43,
+	  "GL_ARB_ES3_compatibility", 2, false, 0.5 / 2047, 0.01 },
+	{ ENUM_AND_STRING(GL_COMPRESSED_SIGNED_RG11_EAC), 43,
+	  "GL_ARB_ES3_compatibility", 2, true, 0.5 / 1023, 0.02 },
+};
+
+static void
+random_blocks(GLenum format, uint8_t *data, size_t size)
+{
+	unsigned block_bytes = piglit_texcompress_block_bytes(format);
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		data[i] = rand();
+
+	for (i = 0; i < size; i += block_bytes) {
+		switch (format) {
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			/* No mode bit set */
+			if (data[i] == 0)
+				data[i] = 0x80;
+			break;
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+			/* Modes 10011, 10111, 11011 and 11111 */
+			if ((data[i] & 0x13) == 0x13)
+				data[i] &= ~0x10;
+			break;
+		}
+	}
+}
+
+/**
+ * Fill \c image with gradients.  Alpha stays above 0.5 so that formats
+ * with one bit of alpha keep all texels opaque.
+ */
+static void
+smooth_image(const struct format_desc *desc, float *image)
+{
+	unsigned x, y, c;
+
+	for (y = 0; y < TEX_SIZE; y++) {
+		for (x = 0; x < TEX_SIZE; x++) {
+			float *texel = image + (y * TEX_SIZE + x) * 4;
+
+			texel[0] = 0.5f + 0.5f * sinf(x * 0.05f);
+			texel[1] = 0.5f + 0.5f * cosf(y * 0.07f);
+			texel[2] = (float) (x + y) / (2 * TEX_SIZE);
+			texel[3] = 0.5f + 0.5f * x / TEX_SIZE;
+
+			for (c = 0; c < 4 && desc->is_signed; c++)
+				texel[c] = texel[c] * 2.0f - 1.0f;
+		}
+	}
+}
+
+/**
+ * Compare the first \c components components of two images, relative to the magnitude of the values for the
+ * float formats.
+ */
+static bool
+compare(const struct format_desc *desc, const float *expected,
+	const float *observed, unsigned components, float tolerance,
+	const char *what)
+{
+	bool is_float = (desc->format == GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT ||
+			 desc->format == GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT);
+	unsigned i;
+
+	for (i = 0; i < TEX_SIZE * TEX_SIZE * 4; i++) {
+		float t = tolerance;
+
+		if (i % 4 >= components)
+			continue;
+
+		if (is_float)
+			t = MAX2(fabsf(expected[i]) / 1024, 1.0f / 16384);
+
+		if (fabsf(expected[i] - observed[i]) > t) {
+			unsigned texel = i / 4;
+
+			printf("%s: %s mismatch at %u,%u component %u:\n"
+			       "  Expected: %f\n"
+			       "  Observed: %f\n",
+			       desc->name, what, texel % TEX_SIZE,
+			       texel / TEX_SIZE, i % 4,
+			       expected[i], observed[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static enum piglit_result
+test_format(const struct format_desc *desc)
+{
+	const size_t image_bytes = TEX_SIZE * TEX_SIZE * 4 * sizeof(float);
+	size_t size = piglit_texcompress_image_size(desc->format,
+						    TEX_SIZE, TEX_SIZE);
+	uint8_t *data;
+	float *expected, *observed, *decoded;
+	bool pass = true;
+	GLuint tex;
+
+	if ((desc->gl_version == 0 ||
+	     piglit_get_gl_version() < desc->gl_version) &&
+	    !piglit_is_extension_supported(desc->extension))
+		return PIGLIT_SKIP;
+
+	data = malloc(size);
+	expected = malloc(image_bytes);
+	observed = malloc(image_bytes);
+	decoded = malloc(image_bytes);
+
+	random_blocks(desc->format, data, size);
+	piglit_texcompress_decode(desc->format, data, TEX_SIZE, TEX_SIZE,
+				  expected);
+
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glCompressedTexImage2D(GL_TEXTURE_2D, 0, desc->format,
+			       TEX_SIZE, TEX_SIZE, 0, size, data);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, observed);
+	glDeleteTextures(1, &tex);
+
+	pass = piglit_check_gl_error(GL_NO_ERROR) && pass;
+	pass = compare(desc, expected, observed, 4, desc->tolerance,
+		       "glGetTexImage") && pass;
+
+	/* The float formats interpolate on the bits of half floats, so
+	 * the error of a single-mode encoder can't be bounded usefully.
+	 */
+	if (desc->encode_tolerance > 0.0f) {
+		smooth_image(desc, expected);
+		piglit_texcompress_encode(desc->format, expected,
+					  TEX_SIZE, TEX_SIZE, data);
+		piglit_texcompress_decode(desc->format, data,
+					  TEX_SIZE, TEX_SIZE, decoded);
+		pass = compare(desc, expected, decoded, desc->components,
+			       desc->encode_tolerance, "encoding") && pass;
+	}
+
+	free(data);
+	free(expected);
+	free(observed);
+	free(decoded);
+
+	return pass ? PIGLIT_PASS : PIGLIT_FAIL;
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	/* UNREACHED */
+	return PIGLIT_FAIL;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	enum piglit_result result = PIGLIT_SKIP;
+	unsigned i;
+
+	srand(0);
+
+	for (i = 0; i < ARRAY_SIZE(formats); i++) {
+		enum piglit_result subtest = test_format(&formats[i]);
+
+		piglit_report_subtest_result(subtest, "%s", formats[i].name);
+		piglit_merge_result(&result, subtest);
+	}
+
+	piglit_report_result(result);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file codec.c
+ *
+ * Checks the r11g11b10f encoder and decoders in tests/util.  Every 11-bit
+ * and 10-bit value is decoded and re-encoded, and the batch functions are
+ * compared with the per-texel ones.  The channels are independent, so
+ * this covers all 2^32 packed values.
+ *
+ * No GL is involved, so the test doesn't create a window.
+ */
+
+#include "piglit-util.h"
+#include "r11g11b10f.h"
+
+/**
+ * Check that every value with \c bits bits decodes and re-encodes to
+ * itself.  Denormals are flushed to zero by the encoder and NaNs come
+ * back as the canonical NaN.
+ */
+static bool
+check_round_trip(unsigned bits, float (*decode)(unsigned),
+		 unsigned (*encode)(float))
+{
+	const unsigned mantissa_bits = bits - 5;
+	bool pass = true;
+	unsigned v;
+
+	for (v = 0; v < (1u << bits); v++) {
+		unsigned exponent = v >> mantissa_bits;
+		unsigned mantissa = v & ((1u << mantissa_bits) - 1);
+		unsigned expected = v;
+		float f = decode(v);
+
+		if (exponent == 0)
+			expected = 0;
+		else if (exponent == 31 && mantissa != 0)
+			expected = 31 << mantissa_bits | 1;
+
+		if (encode(f) != expected) {
+			printf("%u-bit 0x%03x decodes to %g, which encodes "
+			       "as 0x%03x\n", bits, v, f, encode(f));
+			pass = false;
+		}
+	}
+
+	return pass;
+}
+
+static bool
+check_batch(void)
+{
+	static unsigned packed[1 << 16], repacked[1 << 16];
+	static float rgb[3 << 16];
+	bool pass = true;
+	unsigned i;
+
+	/* Cover every red and blue value, and every green value across
+	 * the iterations of i >> 11.
+	 */
+	for (i = 0; i < ARRAY_SIZE(packed); i++)
+		packed[i] = (i & 0x7ff) | (i >> 5) << 11 | (i & 0x3ff) << 22;
+
+	r11g11b10f_to_float3_array(packed, rgb, ARRAY_SIZE(packed));
+	float3_to_r11g11b10f_array(rgb, repacked, ARRAY_SIZE(packed));
+
+	for (i = 0; i < ARRAY_SIZE(packed); i++) {
+		float expected[3];
+
+		r11g11b10f_to_float3(packed[i], expected);
+		if (memcmp(&rgb[3 * i], expected, sizeof(expected)) != 0) {
+			printf("0x%08x: batch decode gives %g %g %g, "
+			       "expected %g %g %g\n", packed[i],
+			       rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2],
+			       expected[0], expected[1], expected[2]);
+			pass = false;
+		}
+
+		if (repacked[i] != float3_to_r11g11b10f(&rgb[3 * i])) {
+			printf("%g %g %g: batch encode gives 0x%08x, "
+			       "expected 0x%08x\n", rgb[3 * i], rgb[3 * i + 1],
+			       rgb[3 * i + 2], repacked[i],
+			       float3_to_r11g11b10f(&rgb[3 * i]));
+			pass = false;
+		}
+
+		if (!pass)
+			break;
+	}
+
+	return pass;
+}
+
+/* Values that need clamping or flushing, which decoded values never do. */
+static bool
+check_encode_edges(void)
+{
+	static const float values[] = {
+		0.0, -0.0, -1.0, 1.0, 0.5, 64512.0, 64513.0, 65024.0,
+		65025.0, 70000.0, 1e30, 1e-10, 1.0 / (1 << 14),
+		0.99 / (1 << 14), 1.0 / (1 << 20), 3.14159, 0.99999,
+		INFINITY, -INFINITY, NAN, -NAN,
+	};
+	bool pass = true;
+	unsigned i, j, k;
+
+	for (i = 0; i < ARRAY_SIZE(values); i++) {
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			for (k = 0; k < ARRAY_SIZE(values); k++) {
+				float rgb[3] = { values[i], values[j],
+						 values[k] };
+				unsigned expected = float3_to_r11g11b10f(rgb);
+				unsigned packed;
+
+				float3_to_r11g11b10f_array(rgb, &packed, 1);
+				if (packed != expected) {
+					printf("%g %g %g: batch encode gives "
+					       "0x%08x, expected 0x%08x\n",
+					       rgb[0], rgb[1], rgb[2],
+					       packed, expected);
+					pass = false;
+				}
+			}
+		}
+	}
+
+	return pass;
+}
+
+int
+main(int argc, char **argv)
+{
+	bool pass = true, subtest;
+
+	subtest = check_round_trip(11, uf11_to_f32, f32_to_uf11) &&
+		  check_round_trip(10, uf10_to_f32, f32_to_uf10);
+	piglit_report_subtest_result(subtest ? PIGLIT_PASS : PIGLIT_FAIL,
+				     "round trip");
+	pass = pass && subtest;
+
+	subtest = check_batch();
+	piglit_report_subtest_result(subtest ? PIGLIT_PASS : PIGLIT_FAIL,
+				     "batch");
+	pass = pass && subtest;
+
+	subtest = check_encode_edges();
+	piglit_report_subtest_result(subtest ? PIGLIT_PASS : PIGLIT_FAIL,
+				     "encode edges");
+	pass = pass && subtest;
+
+	piglit_report_result(pass ? PIGLIT_PASS : PIGLIT_FAIL);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file codec.c
+ *
+ * Checks the batch rgb9e5 encoder and decoder in tests/util against the
+ * per-texel ones, and that every packed value survives a decode, encode
+ * and decode round trip.
+ *
+ * By default every 257th packed value is checked.  Pass -exhaustive to
+ * check all 2^32 of them.
+ *
+ * No GL is involved, so the test doesn't create a window.
+ */
+
+#include "piglit-util.h"
+#include "rgb9e5.h"
+
+#define CHUNK (1 << 16)
+
+static bool
+check_chunk(uint64_t first, unsigned stride, unsigned count)
+{
+	static unsigned packed[CHUNK], repacked[CHUNK];
+	static float rgb[3 * CHUNK], rgb2[3 * CHUNK];
+	bool pass = true;
+	unsigned i;
+
+	for (i = 0; i < count; i++)
+		packed[i] = first + (uint64_t)i * stride;
+
+	rgb9e5_to_float3_array(packed, rgb, count);
+	float3_to_rgb9e5_array(rgb, repacked, count);
+	rgb9e5_to_float3_array(repacked, rgb2, count);
+
+	for (i = 0; i < count; i++) {
+		float expected[3];
+		unsigned expected_packed;
+
+		/* The shared exponent of the re-encoded value may be smaller,
+		 * but the values it decodes to have to be the same.
+		 */
+		if (memcmp(&rgb[3 * i], &rgb2[3 * i], 3 * sizeof(float)) != 0) {
+			printf("0x%08x decodes to %g %g %g, but re-encodes "
+			       "as 0x%08x\n", packed[i], rgb[3 * i],
+			       rgb[3 * i + 1], rgb[3 * i + 2], repacked[i]);
+			pass = false;
+		}
+
+		/* Compare with the per-texel functions on a sample. */
+		if (i % 61 != 0)
+			continue;
+
+		rgb9e5_to_float3(packed[i], expected);
+		if (memcmp(&rgb[3 * i], expected, sizeof(expected)) != 0) {
+			printf("0x%08x: batch decode gives %g %g %g, "
+			       "expected %g %g %g\n", packed[i],
+			       rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2],
+			       expected[0], expected[1], expected[2]);
+			pass = false;
+		}
+
+		expected_packed = float3_to_rgb9e5(&rgb[3 * i]);
+		if (repacked[i] != expected_packed) {
+			printf("%g %g %g: batch encode gives 0x%08x, "
+			       "expected 0x%08x\n", rgb[3 * i], rgb[3 * i + 1],
+			       rgb[3 * i + 2], repacked[i], expected_packed);
+			pass = false;
+		}
+
+		if (!pass)
+			break;
+	}
+
+	return pass;
+}
+
+/* Values that need clamping or rounding, which decoded values never do. */
+static bool
+check_encode_edges(void)
+{
+	static const float values[] = {
+		0.0, -0.0, -1.0, 1.0, 0.5, 65408.0, 65409.0, 70000.0,
+		1e-10, 1.0 / (1 << 24), 1.5 / (1 << 24), 3.0 / (1 << 25),
+		511.5, 1023.9, 0.99999, 3.14159, 1e30,
+		INFINITY, -INFINITY, NAN,
+	};
+	bool pass = true;
+	unsigned i, j, k;
+
+	for (i = 0; i < ARRAY_SIZE(values); i++) {
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			for (k = 0; k < ARRAY_SIZE(values); k++) {
+				float rgb[3] = { values[i], values[j],
+						 values[k] };
+				unsigned expected = float3_to_rgb9e5(rgb);
+				unsigned packed;
+
+				float3_to_rgb9e5_array(rgb, &packed, 1);
+				if (packed != expected) {
+					printf("%g %g %g: batch encode gives "
+					       "0x%08x, expected 0x%08x\n",
+					       rgb[0], rgb[1], rgb[2],
+					       packed, expected);
+					pass = false;
+				}
+			}
+		}
+	}
+
+	return pass;
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned stride = 257;
+	uint64_t total, done;
+	bool pass = true, subtest;
+
+	if (argc > 1 && strcmp(argv[1], "-exhaustive") == 0)
+		stride = 1;
+
+	total = ((1ull << 32) + stride - 1) / stride;
+	for (done = 0; pass && done < total; done += CHUNK) {
+		unsigned count = MIN2(total - done, CHUNK);
+
+		pass = check_chunk(done * stride, stride, count);
+	}
+	piglit_report_subtest_result(pass ? PIGLIT_PASS : PIGLIT_FAIL,
+				     "round trip");
+
+	subtest = check_encode_edges();
+	piglit_report_subtest_result(subtest ? PIGLIT_PASS : PIGLIT_FAIL,
+				     "encode edges");
+	pass = pass && subtest;
+
+	piglit_report_result(pass ? PIGLIT_PASS : PIGLIT_FAIL);
+}
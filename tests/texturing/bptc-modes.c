@@ -34,6 +34,7 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-texcompress.h"
 
 PIGLIT_GL_TEST_CONFIG_BEGIN
 
@@ -45,61 +46,6 @@ PIGLIT_GL_TEST_CONFIG_END
 
 #define BLOCK_SIZE 4
 #define BLOCK_BYTES 16
-#define N_PARTITIONS 64
-
-struct bptc_mode {
-   int n_subsets;
-   int n_partition_bits;
-   bool has_rotation_bits;
-   bool has_index_selection_bit;
-   int n_color_bits;
-   int n_alpha_bits;
-   bool has_endpoint_pbits;
-   bool has_shared_pbits;
-   int n_index_bits;
-   int n_secondary_index_bits;
-};
-
-static const struct bptc_mode
-bptc_modes[] = {
-   /* 0 */ { 3, 4, false, false, 4, 0, true,  false, 3, 0 },
-   /* 1 */ { 2, 6, false, false, 6, 0, false, true,  3, 0 },
-   /* 2 */ { 3, 6, false, false, 5, 0, false, false, 2, 0 },
-   /* 3 */ { 2, 6, false, false, 7, 0, true,  false, 2, 0 },
-   /* 4 */ { 1, 0, true,  true,  5, 6, false, false, 2, 3 },
-   /* 5 */ { 1, 0, true,  false, 7, 8, false, false, 2, 2 },
-   /* 6 */ { 1, 0, false, false, 7, 7, true,  false, 4, 0 },
-   /* 7 */ { 2, 6, false, false, 5, 5, true,  false, 2, 0 }
-};
-
-static const uint8_t
-anchor_indices[][N_PARTITIONS] = {
-   /* Anchor index values for the second subset of two-subset partitioning */
-   {
-      0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,
-      0xf,0x2,0x8,0x2,0x2,0x8,0x8,0xf,0x2,0x8,0x2,0x2,0x8,0x8,0x2,0x2,
-      0xf,0xf,0x6,0x8,0x2,0x8,0xf,0xf,0x2,0x8,0x2,0x2,0x2,0xf,0xf,0x6,
-      0x6,0x2,0x6,0x8,0xf,0xf,0x2,0x2,0xf,0xf,0xf,0xf,0xf,0x2,0x2,0xf
-   },
-
-   /* Anchor index values for the second subset of three-subset partitioning */
-   {
-      0x3,0x3,0xf,0xf,0x8,0x3,0xf,0xf,0x8,0x8,0x6,0x6,0x6,0x5,0x3,0x3,
-      0x3,0x3,0x8,0xf,0x3,0x3,0x6,0xa,0x5,0x8,0x8,0x6,0x8,0x5,0xf,0xf,
-      0x8,0xf,0x3,0x5,0x6,0xa,0x8,0xf,0xf,0x3,0xf,0x5,0xf,0xf,0xf,0xf,
-      0x3,0xf,0x5,0x5,0x5,0x8,0x5,0xa,0x5,0xa,0x8,0xd,0xf,0xc,0x3,0x3
-   },
-
-   /* Anchor index values for the third subset of three-subset
-    * partitioning
-    */
-   {
-      0xf,0x8,0x8,0x3,0xf,0xf,0x3,0x8,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0x8,
-      0xf,0x8,0xf,0x3,0xf,0x8,0xf,0x8,0x3,0xf,0x6,0xa,0xf,0xf,0xa,0x8,
-      0xf,0x3,0xf,0xa,0xa,0x8,0x9,0xa,0x6,0xf,0x8,0xf,0x3,0x6,0x6,0x8,
-      0xf,0x3,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0x3,0xf,0xf,0x8
-   }
-};
 
 struct bptc_block {
 	int mode;
@@ -407,139 +353,24 @@ bptc_blocks[] = {
 
 #define N_BLOCKS ARRAY_SIZE(bptc_blocks)
 
-static void
-write_bits(uint8_t *out,
-	   int *offset,
-	   int value,
-	   int n_bits)
-{
-	int bit_index = *offset % 8;
-	int byte_index = *offset / 8;
-	int n_bits_in_byte = MIN2(n_bits, 8 - bit_index);
-
-	*offset += n_bits;
-
-	while (n_bits > 0) {
-		out[byte_index] |= ((value & ((1 << n_bits_in_byte) - 1)) <<
-				    bit_index);
-
-		n_bits -= n_bits_in_byte;
-		value >>= n_bits_in_byte;
-		byte_index++;
-		bit_index = 0;
-		n_bits_in_byte = MIN2(n_bits, 8);
-	}
-}
-
-static void
-write_component(uint8_t *out,
-		int *offset,
-		const struct bptc_block *block,
-		int component, int subset, int endpoint)
-{
-	write_bits(out, offset,
-		   block->endpoints[subset * 2 + endpoint][component],
-		   bptc_modes[block->mode].n_color_bits);
-}
-
-static bool
-is_anchor(const struct bptc_block *block,
-          int texel)
-{
-	if (texel == 0)
-		return true;
-
-	switch (bptc_modes[block->mode].n_subsets) {
-	case 1:
-		return false;
-	case 2:
-		return anchor_indices[0][block->partition] == texel;
-	case 3:
-		return (anchor_indices[1][block->partition] == texel ||
-			anchor_indices[2][block->partition] == texel);
-	default:
-		assert(false);
-		return false;
-	}
-}
-
 static void
 make_block(const struct bptc_block *block,
 	   uint8_t *out)
 {
-	const struct bptc_mode *mode = bptc_modes + block->mode;
-	int offset = 0;
-	int component;
-	int subset;
-	int endpoint;
-	int n_bits;
-	int i;
-
-	memset(out, 0, BLOCK_SIZE * BLOCK_SIZE);
-
-	write_bits(out, &offset, 1 << block->mode, block->mode + 1);
-
-	write_bits(out, &offset, block->partition, mode->n_partition_bits);
-
-	write_bits(out, &offset, block->rotation,
-		   mode->has_rotation_bits ? 2 : 0);
-
-	write_bits(out, &offset, block->index_selection,
-		   mode->has_index_selection_bit);
-
-	for (component = 0; component < 3; component++) {
-		for (subset = 0; subset < mode->n_subsets; subset++) {
-			for (endpoint = 0; endpoint < 2; endpoint++) {
-				write_component(out, &offset, block,
-						component, subset, endpoint);
-			}
-		}
-	}
-
-	for (subset = 0; subset < mode->n_subsets; subset++) {
-		for (endpoint = 0; endpoint < 2; endpoint++) {
-			write_bits(out, &offset,
-				   block->endpoints[subset * 2 + endpoint][3],
-				   mode->n_alpha_bits);
-		}
-	}
-
-	for (subset = 0; subset < mode->n_subsets; subset++) {
-		for (endpoint = 0; endpoint < 2; endpoint++) {
-			write_bits(out, &offset,
-				   block->pbits[subset * 2 + endpoint],
-				   mode->has_endpoint_pbits);
-		}
-	}
-
-	for (subset = 0; subset < mode->n_subsets; subset++) {
-		write_bits(out, &offset,
-			   block->pbits[subset],
-			   mode->has_shared_pbits);
-	}
-
-	for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
-		n_bits = mode->n_index_bits;
-
-		if (is_anchor(block, i))
-			n_bits--;
-
-		write_bits(out, &offset, block->primary_indices[i], n_bits);
-	}
-
-	if (mode->n_secondary_index_bits) {
-		for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
-			n_bits = mode->n_secondary_index_bits;
-
-			if (is_anchor(block, i))
-				n_bits--;
-
-			write_bits(out, &offset,
-				   block->secondary_indices[i], n_bits);
-		}
-	}
-
-	assert(offset == BLOCK_BYTES * 8);
+	struct piglit_bptc_block fields;
+
+	fields.mode = block->mode;
+	fields.partition = block->partition;
+	fields.rotation = block->rotation;
+	fields.index_selection = block->index_selection;
+	memcpy(fields.endpoints, block->endpoints, sizeof fields.endpoints);
+	memcpy(fields.pbits, block->pbits, sizeof fields.pbits);
+	memcpy(fields.primary_indices, block->primary_indices,
+	       sizeof fields.primary_indices);
+	memcpy(fields.secondary_indices, block->secondary_indices,
+	       sizeof fields.secondary_indices);
+
+	piglit_bptc_pack_block(&fields, out);
 }
 
 static GLuint
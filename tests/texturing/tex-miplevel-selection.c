@@ -1385,11 +1385,17 @@ calc_expected_level(int fetch_level, int baselevel, int maxlevel, int minlod,
 	return expected_level;
 }
 
-enum piglit_result
-piglit_display(void)
-{
+/* One combination of sampler state and fetch level, drawn as a 3x3 quad. */
+struct variant {
 	int fetch_level, baselevel, maxlevel, minlod, maxlod, bias, mipfilter;
-	int expected_level, x, y, total, failed;
+	int expected_level;
+};
+
+static int
+generate_variants(struct variant **out)
+{
+	struct variant *variants = NULL, v;
+	int count = 0, size = 0;
 	int start_bias, end_bias;
 	int end_min_lod, end_max_lod, end_mipfilter, end_fetch_level;
 
@@ -1425,118 +1431,145 @@ piglit_display(void)
 		end_fetch_level = last_level;
 	}
 
-	glClearColor(0.5, 0.5, 0.5, 0.5);
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	total = 0;
-	failed = 0;
-	for (fetch_level = 0; fetch_level <= end_fetch_level; fetch_level++)
-		for (baselevel = 0; baselevel <= last_level; baselevel++)
-			for (maxlevel = baselevel; maxlevel <= last_level; maxlevel++)
-				for (minlod = 0; minlod <= end_min_lod; minlod++)
-					for (maxlod = minlod; maxlod <= end_max_lod; maxlod++)
-						for (bias = start_bias; bias <= end_bias; bias++)
-							for (mipfilter = 0; mipfilter <= end_mipfilter; mipfilter++) {
-								expected_level = calc_expected_level(fetch_level, baselevel,
-											maxlevel, minlod, maxlod, bias,
-											mipfilter);
+	for (v.fetch_level = 0; v.fetch_level <= end_fetch_level; v.fetch_level++)
+		for (v.baselevel = 0; v.baselevel <= last_level; v.baselevel++)
+			for (v.maxlevel = v.baselevel; v.maxlevel <= last_level; v.maxlevel++)
+				for (v.minlod = 0; v.minlod <= end_min_lod; v.minlod++)
+					for (v.maxlod = v.minlod; v.maxlod <= end_max_lod; v.maxlod++)
+						for (v.bias = start_bias; v.bias <= end_bias; v.bias++)
+							for (v.mipfilter = 0; v.mipfilter <= end_mipfilter; v.mipfilter++) {
+								v.expected_level = calc_expected_level(v.fetch_level, v.baselevel,
+												       v.maxlevel, v.minlod, v.maxlod,
+												       v.bias, v.mipfilter);
 
 								/* Skip this if the offset pixel lies outside of the texture. */
 								if (has_offset &&
-								    (TEX_SIZE >> expected_level) <= 1+MAX2(offset[0], offset[1]))
+								    (TEX_SIZE >> v.expected_level) <= 1+MAX2(offset[0], offset[1]))
 									continue;
 
-								if (gltarget != GL_TEXTURE_RECTANGLE) {
-									glTexParameteri(gltarget, GL_TEXTURE_BASE_LEVEL, baselevel);
-									glTexParameteri(gltarget, GL_TEXTURE_MAX_LEVEL, maxlevel);
-									if (!no_lod_clamp) {
-										set_sampler_parameter(GL_TEXTURE_MIN_LOD, minlod);
-										set_sampler_parameter(GL_TEXTURE_MAX_LOD, maxlod);
-									}
-									if (!no_bias &&
-									    test != GL2_TEXTURE_BIAS &&
-									    test != GL2_TEXTURE_PROJ_BIAS &&
-									    test != GL3_TEXTURE_BIAS &&
-									    test != GL3_TEXTURE_PROJ_BIAS &&
-									    test != GL3_TEXTURE_OFFSET_BIAS &&
-									    test != GL3_TEXTURE_PROJ_OFFSET_BIAS)
-										set_sampler_parameter(GL_TEXTURE_LOD_BIAS, bias);
-									set_sampler_parameter(GL_TEXTURE_MIN_FILTER,
-											mipfilter ? GL_NEAREST_MIPMAP_NEAREST
-												  : GL_NEAREST);
+								if (count == size) {
+									size = size ? size * 2 : 1024;
+									variants = realloc(variants, size * sizeof(*variants));
 								}
+								variants[count++] = v;
+							}
 
-								x = (total % (piglit_width/3)) * 3;
-								y = (total / (piglit_width/3)) * 3;
+	*out = variants;
+	return count;
+}
 
-								draw_quad(x, y, 3, 3, expected_level, fetch_level,
-									  baselevel, maxlevel, bias, mipfilter);
+static void
+draw_variant(const struct variant *v, int x, int y)
+{
+	if (gltarget != GL_TEXTURE_RECTANGLE) {
+		glTexParameteri(gltarget, GL_TEXTURE_BASE_LEVEL, v->baselevel);
+		glTexParameteri(gltarget, GL_TEXTURE_MAX_LEVEL, v->maxlevel);
+		if (!no_lod_clamp) {
+			set_sampler_parameter(GL_TEXTURE_MIN_LOD, v->minlod);
+			set_sampler_parameter(GL_TEXTURE_MAX_LOD, v->maxlod);
+		}
+		if (!no_bias &&
+		    test != GL2_TEXTURE_BIAS &&
+		    test != GL2_TEXTURE_PROJ_BIAS &&
+		    test != GL3_TEXTURE_BIAS &&
+		    test != GL3_TEXTURE_PROJ_BIAS &&
+		    test != GL3_TEXTURE_OFFSET_BIAS &&
+		    test != GL3_TEXTURE_PROJ_OFFSET_BIAS)
+			set_sampler_parameter(GL_TEXTURE_LOD_BIAS, v->bias);
+		set_sampler_parameter(GL_TEXTURE_MIN_FILTER,
+				      v->mipfilter ? GL_NEAREST_MIPMAP_NEAREST
+						   : GL_NEAREST);
+	}
 
-								if (in_place_probing) {
-									unsigned char probe[3];
+	draw_quad(x, y, 3, 3, v->expected_level, v->fetch_level,
+		  v->baselevel, v->maxlevel, v->bias, v->mipfilter);
+}
 
-									glReadPixels(x+1, y+1, 1, 1, GL_RGB,
-										     GL_UNSIGNED_BYTE, probe);
+static bool
+check_variant(const struct variant *v, const unsigned char *probed)
+{
+	return check_result(probed, v->expected_level, v->fetch_level,
+			    v->baselevel, v->maxlevel, v->minlod, v->maxlod,
+			    v->bias, v->mipfilter);
+}
 
-									if (!check_result(probe, expected_level,
-											  fetch_level, baselevel,
-											  maxlevel, minlod, maxlod,
-											  bias, mipfilter)) {
-										failed++;
-										if (failed > 100) {
-											printf("Stopping after 100 failures\n");
-											goto end;
-										}
-									}
-								}
-								total++;
-							}
+enum piglit_result
+piglit_display(void)
+{
+	struct variant *variants;
+	unsigned char *pix = NULL;
+	int columns = piglit_width / 3;
+	int quads_per_frame = columns * (piglit_height / 3);
+	int total, checked = 0, failed = 0, first, i;
 
-	if (!in_place_probing) {
-		unsigned char *pix, *p;
+	total = generate_variants(&variants);
 
+	if (!in_place_probing)
 		pix = malloc(piglit_width * piglit_height * 4);
-		glReadPixels(0, 0, piglit_width, piglit_height, GL_RGBA, GL_UNSIGNED_BYTE, pix);
-
-		total = 0;
-		for (fetch_level = 0; fetch_level <= end_fetch_level; fetch_level++)
-			for (baselevel = 0; baselevel <= last_level; baselevel++)
-				for (maxlevel = baselevel; maxlevel <= last_level; maxlevel++)
-					for (minlod = 0; minlod <= end_min_lod; minlod++)
-						for (maxlod = minlod; maxlod <= end_max_lod; maxlod++)
-							for (bias = start_bias; bias <= end_bias; bias++)
-								for (mipfilter = 0; mipfilter <= end_mipfilter; mipfilter++) {
-									expected_level = calc_expected_level(fetch_level,
-												baselevel, maxlevel, minlod,
-												maxlod, bias, mipfilter);
-
-									/* Skip this if the offset pixel lies outside of the texture. */
-									if (has_offset &&
-									    (TEX_SIZE >> expected_level) <= 1+MAX2(offset[0], offset[1]))
-										continue;
-
-									x = (total % (piglit_width/3)) * 3 + 1;
-									y = (total / (piglit_width/3)) * 3 + 1;
-									p = pix + (y*piglit_width + x)*4;
-
-									if (!check_result(p, expected_level, fetch_level,
-											  baselevel, maxlevel, minlod,
-											  maxlod, bias, mipfilter)) {
-										failed++;
-										if (failed > 100) {
-											printf("Stopping after 100 failures\n");
-											goto end;
-										}
-									}
-									total++;
-								}
-		free(pix);
+
+	glClearColor(0.5, 0.5, 0.5, 0.5);
+
+	/* Pack as many quads into the window as fit, then check the whole
+	 * frame with a single readback. */
+	for (first = 0; first < total; first += quads_per_frame) {
+		int count = MIN2(quads_per_frame, total - first);
+
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		for (i = 0; i < count; i++) {
+			const struct variant *v = &variants[first + i];
+			int x = (i % columns) * 3;
+			int y = (i / columns) * 3;
+
+			draw_variant(v, x, y);
+
+			if (in_place_probing) {
+				unsigned char probe[3];
+
+				glReadPixels(x+1, y+1, 1, 1, GL_RGB,
+					     GL_UNSIGNED_BYTE, probe);
+
+				checked++;
+				if (!check_variant(v, probe)) {
+					failed++;
+					if (failed > 100) {
+						printf("Stopping after 100 failures\n");
+						goto end;
+					}
+				}
+			}
+		}
+
+		if (in_place_probing)
+			continue;
+
+		/* Only read back the rows that were drawn to. */
+		glReadPixels(0, 0, piglit_width, (count + columns - 1) / columns * 3,
+			     GL_RGBA, GL_UNSIGNED_BYTE, pix);
+
+		for (i = 0; i < count; i++) {
+			int x = (i % columns) * 3 + 1;
+			int y = (i / columns) * 3 + 1;
+
+			checked++;
+			if (!check_variant(&variants[first + i],
+					   pix + (y*piglit_width + x)*4)) {
+				failed++;
+				if (failed > 100) {
+					printf("Stopping after 100 failures\n");
+					goto end;
+				}
+			}
+		}
 	}
 
 end:
+	free(pix);
+	free(variants);
+
 	if (!piglit_check_gl_error(GL_NO_ERROR))
 		piglit_report_result(PIGLIT_FAIL);
-	printf("Summary: %i/%i passed\n", total-failed, total);
+	printf("Summary: %i/%i passed\n", checked-failed, checked);
 
 	piglit_present_results();
 
@@ -22,8 +22,11 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-format-convert.h"
 
 #define BENCHMARK_ITERATIONS 1000
+#define BENCHMARK_MAX_SIZES 8
+#define BENCHMARK_MAX_SAMPLES 64
 
 PIGLIT_GL_TEST_CONFIG_BEGIN
 
@@ -186,13 +189,6 @@ valid_combination(GLenum format, GLenum type)
 	}
 }
 
-static float
-un_to_float(unsigned char bits, unsigned int color)
-{
-	unsigned int max = ~0u >> (sizeof(max) * 8 - bits);
-	return (float)color / (float)max;
-}
-
 static float
 sn_to_float(unsigned char bits, int color)
 {
@@ -202,136 +198,6 @@ sn_to_float(unsigned char bits, int color)
 	return (float)color / (float)max;
 }
 
-static float
-srgb_to_linear(float s)
-{
-	if (s > 0.0405)
-		return pow((s + 0.055) / 1.055, 2.4);
-	else
-		return s / 12.92;
-}
-
-#define UNPACK(val, len, off) ((val) >> off) & ~(~0ul << len)
-
-static void
-to_float(void *data, int num_chan, GLenum type, float *out)
-{
-	int i;
-
-	switch (type) {
-	case GL_UNSIGNED_BYTE_3_3_2:
-		assert(num_chan == 3);
-		out[0] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 5));
-		out[1] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 2));
-		out[2] = un_to_float(2, UNPACK(*(GLubyte *)data, 2, 0));
-		break;
-	case GL_UNSIGNED_BYTE_2_3_3_REV:
-		assert(num_chan == 3);
-		out[0] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 0));
-		out[1] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 3));
-		out[2] = un_to_float(2, UNPACK(*(GLubyte *)data, 2, 6));
-		break;
-	case GL_UNSIGNED_SHORT_5_6_5:
-		assert(num_chan == 3);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
-		out[1] = un_to_float(6, UNPACK(*(GLushort *)data, 6, 5));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
-		break;
-	case GL_UNSIGNED_SHORT_5_6_5_REV:
-		assert(num_chan == 3);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
-		out[1] = un_to_float(6, UNPACK(*(GLushort *)data, 6, 5));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
-		break;
-	case GL_UNSIGNED_SHORT_4_4_4_4:
-		assert(num_chan == 4);
-		out[0] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 12));
-		out[1] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 8));
-		out[2] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 4));
-		out[3] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 0));
-		break;
-	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-		assert(num_chan == 4);
-		out[0] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 0));
-		out[1] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 4));
-		out[2] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 8));
-		out[3] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 12));
-		break;
-	case GL_UNSIGNED_SHORT_5_5_5_1:
-		assert(num_chan == 4);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
-		out[1] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 6));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 1));
-		out[3] = un_to_float(1, UNPACK(*(GLushort *)data, 1, 0));
-		break;
-	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-		assert(num_chan == 4);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
-		out[1] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 5));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 10));
-		out[3] = un_to_float(1, UNPACK(*(GLushort *)data, 1, 15));
-		break;
-	case GL_UNSIGNED_INT_10_10_10_2:
-		assert(num_chan == 4);
-		out[0] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 22));
-		out[1] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 12));
-		out[2] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 2));
-		out[3] = un_to_float(2, UNPACK(*(GLuint *)data, 2, 0));
-		break;
-	case GL_UNSIGNED_INT_2_10_10_10_REV:
-		assert(num_chan == 4);
-		out[0] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 0));
-		out[1] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 10));
-		out[2] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 20));
-		out[3] = un_to_float(2, UNPACK(*(GLuint *)data, 2, 30));
-		break;
-	case GL_UNSIGNED_INT_8_8_8_8:
-		assert(num_chan == 4);
-		out[0] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 24));
-		out[1] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 16));
-		out[2] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 8));
-		out[3] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 0));
-		break;
-	case GL_UNSIGNED_INT_8_8_8_8_REV:
-		assert(num_chan == 4);
-		out[0] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 0));
-		out[1] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 8));
-		out[2] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 16));
-		out[3] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 24));
-		break;
-	case GL_BYTE:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = sn_to_float(8, ((GLbyte *)data)[i]);
-		break;
-	case GL_UNSIGNED_BYTE:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = un_to_float(8, ((GLubyte *)data)[i]);
-		break;
-	case GL_SHORT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = sn_to_float(16, ((GLshort *)data)[i]);
-		break;
-	case GL_UNSIGNED_SHORT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = un_to_float(16, ((GLushort *)data)[i]);
-		break;
-	case GL_FLOAT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = ((float *)data)[i];
-		break;
-	case GL_INT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = sn_to_float(32, ((GLint *)data)[i]);
-		break;
-	case GL_UNSIGNED_INT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = un_to_float(32, ((GLuint *)data)[i]);
-		break;
-	default:
-		assert(!"Invalid type");
-	}
-}
-
 static bool
 is_format_signed(GLenum format)
 {
@@ -461,6 +327,35 @@ GLuint unsigned_prog, signed_prog;
 void *rand_data;
 float tolerance[4];
 bool benchmark = false;
+int benchmark_sizes[BENCHMARK_MAX_SIZES] = { 128 };
+int num_benchmark_sizes = 1;
+int benchmark_samples = 5;
+
+static void
+parse_benchmark_sizes(const char *list)
+{
+	char *end;
+
+	num_benchmark_sizes = 0;
+	while (*list) {
+		int size = strtol(list, &end, 10);
+
+		if (end == list || size <= 0) {
+			printf("Invalid benchmark size list\n");
+			exit(1);
+		}
+		if (num_benchmark_sizes == BENCHMARK_MAX_SIZES) {
+			printf("At most %d benchmark sizes are supported\n",
+			       BENCHMARK_MAX_SIZES);
+			exit(1);
+		}
+		benchmark_sizes[num_benchmark_sizes++] = size;
+
+		list = end;
+		if (*list == ',')
+			list++;
+	}
+}
 
 void
 piglit_init(int argc, char **argv)
@@ -473,6 +368,21 @@ piglit_init(int argc, char **argv)
 		} else if (strcmp(argv[i], "--benchmark") == 0) {
 			benchmark = true;
 			texture_size = 128;
+		} else if (strncmp(argv[i], "--benchmark-sizes=", 18) == 0) {
+			benchmark = true;
+			texture_size = 128;
+			parse_benchmark_sizes(argv[i] + 18);
+		} else if (sscanf(argv[i], "--benchmark-samples=%d",
+				  &benchmark_samples) > 0) {
+			benchmark = true;
+			texture_size = 128;
+			if (benchmark_samples < 1)
+				benchmark_samples = 1;
+			if (benchmark_samples > BENCHMARK_MAX_SAMPLES) {
+				printf("At most %d benchmark samples are "
+				       "supported\n", BENCHMARK_MAX_SAMPLES);
+				exit(1);
+			}
 		} else if (i == argc - 1) {
 			format = find_format(argv[i]);
 			break;
@@ -480,7 +390,9 @@ piglit_init(int argc, char **argv)
 	}
 
 	if (argc < 2) {
-		printf("usage: teximage-colors [--seed=seed] [--benchmark] format\n");
+		printf("usage: teximage-colors [--seed=seed] [--benchmark] "
+		       "[--benchmark-sizes=n,...] [--benchmark-samples=n] "
+		       "format\n");
 		exit(1);
 	}
 
@@ -588,127 +500,81 @@ piglit_init(int argc, char **argv)
 	}
 }
 
-void
-to_expected(GLenum test_format, GLenum test_type, void *up_raw, float *expected)
+/**
+ * Compute the color expected when sampling a texture uploaded from
+ * \c count pixels of \c test_format / \c test_type.
+ */
+static void
+compute_expected(GLenum test_format, GLenum test_type, const void *data,
+		 unsigned count, float *expected)
 {
-	float up_rgba[4];
-	int num_chan = num_channels(test_format);
-
-	to_float(up_raw, num_chan, test_type, up_rgba);
+	float keep[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	float fill[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	bool luminance = false;
+	unsigned i, c;
 
-	expected[0] = 0.0f;
-	expected[1] = 0.0f;
-	expected[2] = 0.0f;
-	expected[3] = 1.0f;
-
-	switch (test_format) {
-	case GL_RED:
-		expected[0] = up_rgba[0];
-		break;
-	case GL_GREEN:
-		expected[1] = up_rgba[0];
-		break;
-	case GL_BLUE:
-		expected[2] = up_rgba[0];
-		break;
-	case GL_ALPHA:
-		expected[3] = up_rgba[0];
-		break;
-	case GL_RG:
-		expected[0] = up_rgba[0];
-		expected[1] = up_rgba[1];
-		break;
-	case GL_RGBA:
-		expected[3] = up_rgba[3];
-	case GL_RGB:
-		expected[0] = up_rgba[0];
-		expected[1] = up_rgba[1];
-		expected[2] = up_rgba[2];
-		break;
-	case GL_BGRA:
-		expected[3] = up_rgba[3];
-	case GL_BGR:
-		expected[0] = up_rgba[2];
-		expected[1] = up_rgba[1];
-		expected[2] = up_rgba[0];
-		break;
-	case GL_ABGR_EXT:
-		expected[0] = up_rgba[3];
-		expected[1] = up_rgba[2];
-		expected[2] = up_rgba[1];
-		expected[3] = up_rgba[0];
-		break;
-	case GL_INTENSITY:
-		expected[0] = up_rgba[0];
-		expected[1] = up_rgba[0];
-		expected[2] = up_rgba[0];
-		expected[3] = up_rgba[0];
-		break;
-	case GL_LUMINANCE_ALPHA:
-		expected[3] = up_rgba[1];
-	case GL_LUMINANCE:
-		expected[0] = up_rgba[0];
-		expected[1] = up_rgba[0];
-		expected[2] = up_rgba[0];
-		break;
-	default:
-		assert(!"Invalid color format");
-	}
+	piglit_unpack_to_rgba_float(test_format, test_type, data, count,
+				    expected);
 
+	/* Drop the components the internal format doesn't store. */
 	switch (format->format) {
 	case GL_RED:
 	case GL_RED_INTEGER:
-		expected[1] = 0.0f;
+		keep[1] = 0.0f;
 	case GL_RG:
 	case GL_RG_INTEGER:
-		expected[2] = 0.0f;
+		keep[2] = 0.0f;
 	case GL_RGB:
 	case GL_RGB_INTEGER:
-		expected[3] = 1.0f;
+		keep[3] = 0.0f;
+		fill[3] = 1.0f;
 		break;
 	case GL_RGBA:
 	case GL_RGBA_INTEGER:
 		break;
 	case GL_ALPHA:
-		expected[0] = 0.0f;
-		expected[1] = 0.0f;
-		expected[2] = 0.0f;
+		keep[0] = 0.0f;
+		keep[1] = 0.0f;
+		keep[2] = 0.0f;
 		break;
 	case GL_LUMINANCE:
-		expected[3] = 1.0f;
+		keep[3] = 0.0f;
+		fill[3] = 1.0f;
 	case GL_LUMINANCE_ALPHA:
-		expected[1] = expected[0];
-		expected[2] = expected[0];
+		luminance = true;
 		break;
 	default:
 		assert(!"Invalid color format");
 	}
 
-	if (!is_format_signed(format->internal_format)) {
-		if (expected[0] < 0.0f)
-			expected[0] = 0.0f;
-		if (expected[1] < 0.0f)
-			expected[1] = 0.0f;
-		if (expected[2] < 0.0f)
-			expected[2] = 0.0f;
-		if (expected[3] < 0.0f)
-			expected[3] = 0.0f;
+	for (i = 0; i < count; ++i) {
+		float *texel = expected + 4 * i;
+
+		if (luminance) {
+			texel[1] = texel[0];
+			texel[2] = texel[0];
+		}
+
+		for (c = 0; c < 4; ++c)
+			texel[c] = texel[c] * keep[c] + fill[c];
 	}
 
-	if (is_format_srgb(format->internal_format)) {
-		expected[0] = srgb_to_linear(expected[0]);
-		expected[1] = srgb_to_linear(expected[1]);
-		expected[2] = srgb_to_linear(expected[2]);
+	if (!is_format_signed(format->internal_format)) {
+		for (i = 0; i < count * 4; ++i)
+			if (expected[i] < 0.0f)
+				expected[i] = 0.0f;
 	}
+
+	if (is_format_srgb(format->internal_format))
+		piglit_srgb_to_linear_rgba(expected, count);
 }
 
 enum piglit_result
-run_test(GLenum test_format, GLenum test_type, float *time_out)
+run_test(GLenum test_format, GLenum test_type)
 {
 	bool pass = true;
-	int64_t time;
 	GLuint tex;
-	int i, Bpp, channels;
+	int i, channels;
 	float *tmp, *expected, *observed;
 	void *data;
 
@@ -720,7 +586,6 @@ run_test(GLenum test_format, GLenum test_type, float *time_out)
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 	channels = num_channels(test_format);
-	Bpp = bytes_per_pixel(test_format, test_type);
 
 	if (test_type == GL_FLOAT) {
 		/* Sanitize so we don't get invalid floating point values */
@@ -734,23 +599,12 @@ run_test(GLenum test_format, GLenum test_type, float *time_out)
 	}
 
 	expected = malloc(texture_size * texture_size * 4 * sizeof(float));
-	for (i = 0; i < texture_size * texture_size; ++i)
-		to_expected(test_format, test_type, (GLubyte *)data + (i * Bpp),
-			    expected + 4 * i);
-
-	if (benchmark) {
-		time = piglit_time_get_nano();
-		for (i = 0; i < BENCHMARK_ITERATIONS; ++i)
-			glTexImage2D(GL_TEXTURE_2D, 0, format->internal_format,
-				     texture_size, texture_size, 0,
-				     test_format, test_type, data);
-		time = piglit_time_get_nano() - time;
-		*time_out = (double)time / (double)(BENCHMARK_ITERATIONS*1000);
-	} else {
-		glTexImage2D(GL_TEXTURE_2D, 0, format->internal_format,
-			     texture_size, texture_size, 0,
-			     test_format, test_type, data);
-	}
+	compute_expected(test_format, test_type, data,
+			 texture_size * texture_size, expected);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, format->internal_format,
+		     texture_size, texture_size, 0,
+		     test_format, test_type, data);
 	pass &= piglit_check_gl_error(GL_NO_ERROR);
 
 	if (is_format_signed(format->internal_format)) {
@@ -848,13 +702,280 @@ test_exact()
 	return pass;
 }
 
+enum benchmark_path {
+	PATH_TEXIMAGE,
+	PATH_TEXSUBIMAGE,
+	PATH_PBO_UPLOAD,
+	PATH_GETTEXIMAGE,
+	PATH_GETTEXTURESUBIMAGE,
+	PATH_READPIXELS,
+	PATH_COUNT
+};
+
+static const char *const path_names[PATH_COUNT] = {
+	"teximage",
+	"texsubimage",
+	"pbo-upload",
+	"getteximage",
+	"gettexturesubimage",
+	"readpixels",
+};
+
+static bool
+path_supported(enum benchmark_path path)
+{
+	switch (path) {
+	case PATH_PBO_UPLOAD:
+		return piglit_get_gl_version() >= 21 ||
+		       piglit_is_extension_supported("GL_ARB_pixel_buffer_object");
+	case PATH_GETTEXTURESUBIMAGE:
+		return piglit_get_gl_version() >= 45 ||
+		       piglit_is_extension_supported("GL_ARB_get_texture_sub_image");
+	default:
+		return true;
+	}
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return x < y ? -1 : x > y;
+}
+
+/**
+ * Run one transfer through \c path.  The texture (and for PBO uploads,
+ * the unpack buffer) is already bound.
+ */
+static void
+run_path(enum benchmark_path path, GLuint tex, int size,
+	 GLenum test_format, GLenum test_type, void *data,
+	 void *readback, int readback_size)
+{
+	switch (path) {
+	case PATH_TEXIMAGE:
+		glTexImage2D(GL_TEXTURE_2D, 0, format->internal_format,
+			     size, size, 0, test_format, test_type, data);
+		break;
+	case PATH_TEXSUBIMAGE:
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size,
+				test_format, test_type, data);
+		break;
+	case PATH_PBO_UPLOAD:
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size,
+				test_format, test_type, NULL);
+		break;
+	case PATH_GETTEXIMAGE:
+		glGetTexImage(GL_TEXTURE_2D, 0, test_format, test_type,
+			      readback);
+		break;
+	case PATH_GETTEXTURESUBIMAGE:
+		glGetTextureSubImage(tex, 0, 0, 0, 0, size, size, 1,
+				     test_format, test_type,
+				     readback_size, readback);
+		break;
+	case PATH_READPIXELS:
+		glReadPixels(0, 0, size, size, test_format, test_type,
+			     readback);
+		break;
+	default:
+		assert(!"Invalid path");
+	}
+}
+
+/**
+ * Time \c path for one format/type/size and print the median and
+ * standard deviation of the samples, in microseconds per call.
+ *
+ * Returns false if the path is unusable for this combination.
+ */
+static bool
+benchmark_case(enum benchmark_path path, int size,
+	       GLenum test_format, GLenum test_type, void *data)
+{
+	int iterations = BENCHMARK_ITERATIONS * 128 * 128 /
+			 (size * size) / benchmark_samples;
+	int readback_size = size * size * bytes_per_pixel(test_format,
+							  test_type);
+	double samples[BENCHMARK_MAX_SAMPLES], mean = 0.0, variance = 0.0;
+	double median;
+	void *readback = malloc(readback_size);
+	int num_samples = benchmark_samples;
+	GLuint tex, fbo = 0, pbo = 0;
+	bool ok = true;
+	int i, j;
+
+	if (iterations < 1)
+		iterations = 1;
+
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, format->internal_format, size, size, 0,
+		     test_format, test_type, data);
+
+	if (path == PATH_PBO_UPLOAD) {
+		glGenBuffers(1, &pbo);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, readback_size, data,
+			     GL_STATIC_DRAW);
+	} else if (path == PATH_READPIXELS) {
+		glGenFramebuffersEXT(1, &fbo);
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT,
+					  GL_COLOR_ATTACHMENT0_EXT,
+					  GL_TEXTURE_2D, tex, 0);
+		ok = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) ==
+		     GL_FRAMEBUFFER_COMPLETE_EXT;
+	}
+
+	/* Warm up, so that the first sample doesn't pay for allocation
+	 * and shader compiles in the driver.
+	 */
+	if (ok)
+		run_path(path, tex, size, test_format, test_type, data,
+			 readback, readback_size);
+	glFinish();
+	ok = ok && glGetError() == GL_NO_ERROR;
+
+	for (i = 0; ok && i < num_samples; ++i) {
+		int64_t time = piglit_time_get_nano();
+
+		for (j = 0; j < iterations; ++j)
+			run_path(path, tex, size, test_format, test_type,
+				 data, readback, readback_size);
+		glFinish();
+
+		time = piglit_time_get_nano() - time;
+		samples[i] = (double)time / (iterations * 1000.0);
+		mean += samples[i];
+	}
+
+	if (pbo) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &pbo);
+	}
+	if (fbo) {
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, piglit_winsys_fbo);
+		glDeleteFramebuffersEXT(1, &fbo);
+	}
+	glDeleteTextures(1, &tex);
+	free(readback);
+
+	if (!ok || glGetError() != GL_NO_ERROR) {
+		/* Clear any remaining errors. */
+		while (glGetError() != GL_NO_ERROR)
+			;
+		return false;
+	}
+
+	mean /= num_samples;
+	for (i = 0; i < num_samples; ++i)
+		variance += (samples[i] - mean) * (samples[i] - mean);
+	variance /= num_samples;
+
+	qsort(samples, num_samples, sizeof(samples[0]), compare_doubles);
+	median = num_samples % 2 ? samples[num_samples / 2] :
+		 (samples[num_samples / 2 - 1] + samples[num_samples / 2]) / 2;
+
+	printf("%s, %s, %s, %s, %d, %.3f, %.3f, %.1f\n",
+	       piglit_get_gl_enum_name(format->internal_format),
+	       piglit_get_gl_enum_name(test_format),
+	       piglit_get_gl_enum_name(test_type),
+	       path_names[path], size, median, sqrt(variance),
+	       size * size / median);
+	printf("PIGLIT: {\"profile\": {\"%s %s %s %s %d\": "
+	       "{\"median_us\": %.3f, \"stddev_us\": %.3f, "
+	       "\"samples\": %d}}}\n",
+	       piglit_get_gl_enum_name(format->internal_format),
+	       piglit_get_gl_enum_name(test_format),
+	       piglit_get_gl_enum_name(test_type),
+	       path_names[path], size, median, sqrt(variance), num_samples);
+
+	return true;
+}
+
+/**
+ * Print the row of a combination benchmark_case() couldn't time, so it
+ * doesn't silently drop out of the sweep.
+ */
+static void
+print_skipped_case(enum benchmark_path path, int size,
+		   GLenum test_format, GLenum test_type)
+{
+	printf("%s, %s, %s, %s, %d, skipped\n",
+	       piglit_get_gl_enum_name(format->internal_format),
+	       piglit_get_gl_enum_name(test_format),
+	       piglit_get_gl_enum_name(test_type),
+	       path_names[path], size);
+}
+
+/**
+ * Sweep every client format/type, transfer path and size for the
+ * internal format under test.
+ */
+static void
+run_benchmark(void)
+{
+	int max_size = 0, i, j, k, n;
+	void *data, *float_data;
+	enum benchmark_path path;
+
+	for (k = 0; k < num_benchmark_sizes; ++k)
+		max_size = MAX2(max_size, benchmark_sizes[k]);
+
+	/* Enough for four 32-bit channels per texel. */
+	data = malloc(max_size * max_size * 16);
+	float_data = malloc(max_size * max_size * 16);
+	for (i = 0; i < max_size * max_size * 16; ++i)
+		((GLubyte *)data)[i] = rand();
+	for (i = 0; i < max_size * max_size * 4; ++i)
+		((float *)float_data)[i] =
+			sn_to_float(32, ((GLint *)data)[i]);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	printf("internalFormat, format, type, path, size, "
+	       "median (us/call), stddev (us), texels/us\n");
+
+	for (path = 0; path < PATH_COUNT; ++path) {
+		if (!path_supported(path)) {
+			printf("# %s not supported\n", path_names[path]);
+			continue;
+		}
+
+		for (k = 0; k < num_benchmark_sizes; ++k) {
+			n = benchmark_sizes[k];
+			for (i = 0; i < ARRAY_LENGTH(gl_formats); ++i) {
+				for (j = 0; j < ARRAY_LENGTH(gl_types); ++j) {
+					if (!valid_combination(gl_formats[i],
+							       gl_types[j]))
+						continue;
+
+					if (!benchmark_case(path, n, gl_formats[i],
+							    gl_types[j],
+							    gl_types[j] == GL_FLOAT ?
+							    float_data : data))
+						print_skipped_case(path, n,
+								   gl_formats[i],
+								   gl_types[j]);
+				}
+			}
+		}
+	}
+
+	free(float_data);
+	free(data);
+}
+
 enum piglit_result
 piglit_display(void)
 {
 	bool warn = false, pass = true;
 	GLuint rb, fbo;
 	int i, j;
-	float times[ARRAY_LENGTH(gl_formats)][ARRAY_LENGTH(gl_types)];
 
 	glGenRenderbuffersEXT(1, &rb);
 	glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, rb);
@@ -881,8 +1002,7 @@ piglit_display(void)
 			if (!valid_combination(gl_formats[i], gl_types[j]))
 				continue;
 
-			pass &= run_test(gl_formats[i], gl_types[j],
-					 &times[i][j]);
+			pass &= run_test(gl_formats[i], gl_types[j]);
 		}
 	}
 
@@ -890,21 +1010,8 @@ piglit_display(void)
 	glDeleteFramebuffers(1, &fbo);
 	glDeleteRenderbuffers(1, &rb);
 
-	if (benchmark) {
-		fprintf(stdout, "internalFormat, format, type, time (us/call)\n");
-		for (i = 0; i < ARRAY_LENGTH(gl_formats); ++i) {
-			for (j = 0; j < ARRAY_LENGTH(gl_types); ++j) {
-				if (!valid_combination(gl_formats[i], gl_types[j]))
-					continue;
-
-				fprintf(stdout, "%s, %s, %s, %.3f\n",
-					piglit_get_gl_enum_name(format->internal_format),
-					piglit_get_gl_enum_name(gl_formats[i]),
-					piglit_get_gl_enum_name(gl_types[j]),
-					times[i][j]);
-			}
-		}
-	}
+	if (benchmark)
+		run_benchmark();
 
 	if (pass) {
 		return warn ? PIGLIT_WARN : PIGLIT_PASS;
@@ -27,6 +27,7 @@
  **/
 
 #include "piglit-util-gl.h"
+#include "piglit-ref-volume.h"
 
 PIGLIT_GL_TEST_CONFIG_BEGIN
 
@@ -62,6 +63,11 @@ static const struct format_info formats[] = {
 	{ GL_DEPTH32F_STENCIL8,  GL_DEPTH_STENCIL,   GL_FLOAT_32_UNSIGNED_INT_24_8_REV, sizeof(int) + sizeof(float) }
 };
 
+/** Depth uploaded to each quadrant, in the order load_texture() uses. */
+static const unsigned short depth16[4] = { 0x4000, 0x7F00, 0xC000, 0xFF00 };
+static const unsigned depth24[4] = { 0x400000, 0x7F0000, 0xC00000, 0xFF0000 };
+static const float depth32f[4] = { 0.25, 0.50, 0.75, 1.00 };
+
 static void
 load_texture(int formats_idx, int tex_size_idx)
 {
@@ -79,28 +85,28 @@ load_texture(int formats_idx, int tex_size_idx)
 	for (i = 0; i < n_pixels; i++) {
 		switch (formats[formats_idx].type) {
 		case GL_UNSIGNED_SHORT:
-			((unsigned short *)texDepthData[0])[i] = 0x4000;
-			((unsigned short *)texDepthData[1])[i] = 0x7F00;
-			((unsigned short *)texDepthData[2])[i] = 0xC000;
-			((unsigned short *)texDepthData[3])[i] = 0xFF00;
+			((unsigned short *)texDepthData[0])[i] = depth16[0];
+			((unsigned short *)texDepthData[1])[i] = depth16[1];
+			((unsigned short *)texDepthData[2])[i] = depth16[2];
+			((unsigned short *)texDepthData[3])[i] = depth16[3];
 			break;
 		case GL_UNSIGNED_INT_24_8:
-			((unsigned *)texDepthData[0])[i] = 0x400000BB;
-			((unsigned *)texDepthData[1])[i] = 0x7F0000BB;
-			((unsigned *)texDepthData[2])[i] = 0xC00000BB;
-			((unsigned *)texDepthData[3])[i] = 0xFF0000BB;
+			((unsigned *)texDepthData[0])[i] = depth24[0] << 8 | 0xBB;
+			((unsigned *)texDepthData[1])[i] = depth24[1] << 8 | 0xBB;
+			((unsigned *)texDepthData[2])[i] = depth24[2] << 8 | 0xBB;
+			((unsigned *)texDepthData[3])[i] = depth24[3] << 8 | 0xBB;
 			break;
 		case GL_FLOAT:
-			((float *)texDepthData[0])[i] = 0.25;
-			((float *)texDepthData[1])[i] = 0.50;
-			((float *)texDepthData[2])[i] = 0.75;
-			((float *)texDepthData[3])[i] = 1.00;
+			((float *)texDepthData[0])[i] = depth32f[0];
+			((float *)texDepthData[1])[i] = depth32f[1];
+			((float *)texDepthData[2])[i] = depth32f[2];
+			((float *)texDepthData[3])[i] = depth32f[3];
 			break;
 		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
-			((float *)texDepthData[0])[2 * i] = 0.25;
-			((float *)texDepthData[1])[2 * i] = 0.50;
-			((float *)texDepthData[2])[2 * i] = 0.75;
-			((float *)texDepthData[3])[2 * i] = 1.00;
+			((float *)texDepthData[0])[2 * i] = depth32f[0];
+			((float *)texDepthData[1])[2 * i] = depth32f[1];
+			((float *)texDepthData[2])[2 * i] = depth32f[2];
+			((float *)texDepthData[3])[2 * i] = depth32f[3];
 
 			((unsigned *)texDepthData[0])[2 * i + 1] = 0xBB;
 			((unsigned *)texDepthData[1])[2 * i + 1] = 0xBB;
@@ -166,6 +172,68 @@ load_texture(int formats_idx, int tex_size_idx)
 		free(texDepthData[i]);
 }
 
+static float
+quadrant_depth(int formats_idx, int quadrant)
+{
+	switch (formats[formats_idx].type) {
+	case GL_UNSIGNED_SHORT:
+		return depth16[quadrant] / 65535.0;
+	case GL_UNSIGNED_INT_24_8:
+		return depth24[quadrant] / 16777215.0;
+	default:
+		return depth32f[quadrant];
+	}
+}
+
+/**
+ * Read the depth of the texture back and compare it with a reference
+ * volume updated with the same four quadrants as load_texture().
+ */
+static bool
+check_texture_depth(int formats_idx, int tex_size_idx)
+{
+	const int width = tex_size[tex_size_idx].width;
+	const int height = tex_size[tex_size_idx].height;
+	const unsigned w_by_2 = width / 2, h_by_2 = height / 2;
+	float *cleared = calloc(width * height, sizeof(float));
+	float *updated = malloc(width * height * sizeof(float));
+	float *observed = malloc(width * height * sizeof(float));
+	struct piglit_ref_volume *ref;
+	bool pass;
+	int x, y, q;
+
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++) {
+			q = (y >= h_by_2) * 2 + (x >= w_by_2);
+			updated[y * width + x] = quadrant_depth(formats_idx, q);
+		}
+	}
+
+	ref = piglit_ref_volume_create(PIGLIT_REF_VOLUME_DEPTH,
+				       width, height, 1, cleared);
+	piglit_ref_volume_set_tolerance(ref, 1.0 / 65535.0);
+	for (q = 0; q < 4; q++) {
+		const struct piglit_ref_volume_box box = {
+			(q & 1) * w_by_2, (q >> 1) * h_by_2, 0,
+			w_by_2, h_by_2, 1
+		};
+
+		piglit_ref_volume_update(ref, updated, &box);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, tex[formats_idx]);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT,
+		      observed);
+	pass = piglit_check_gl_error(GL_NO_ERROR) &&
+	       piglit_ref_volume_compare(ref, observed, NULL);
+
+	piglit_ref_volume_destroy(ref);
+	free(observed);
+	free(updated);
+	free(cleared);
+	return pass;
+}
+
 void
 piglit_init(int argc, char **argv)
 {
@@ -196,8 +264,8 @@ piglit_display(void)
 
 	for (i = 0; i < ARRAY_SIZE(formats); i++) {
 		for (j = 0; j < ARRAY_SIZE(tex_size); j++) {
-			result = true;
 			load_texture(i, j);
+			result = check_texture_depth(i, j);
 
 			glBindTexture(GL_TEXTURE_2D, tex[i]);
 			piglit_draw_rect_tex(0, 0, piglit_width, piglit_height,
@@ -27,6 +27,7 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-ref-volume.h"
 #include "../fbo/fbo-formats.h"
 
 PIGLIT_GL_TEST_CONFIG_BEGIN
@@ -249,7 +250,7 @@ static bool
 test_formats_type(const struct format_desc *intFormat,
 		  GLuint w,  GLuint h,
 		  const struct src_format_desc *srcFormat, GLenum type,
-		  const GLubyte *original_img, const GLubyte *original_ref,
+		  const GLubyte *original_img, struct piglit_ref_volume *ref,
 		  const GLubyte *updated_img, const GLubyte *updated_ref,
 		  GLuint pbo,
 		  GLubyte *updated_swz_ref, GLubyte *upload_data, GLubyte *testImg)
@@ -263,6 +264,7 @@ test_formats_type(const struct format_desc *intFormat,
 		bits = 8;
 	if (type == GL_BYTE && bits > 7)
 		bits = 7;
+	piglit_ref_volume_set_bits(ref, bits);
 
 	for (unsigned t = 0; t < 3 && pass; t++) {
 		GLuint tex;
@@ -276,6 +278,7 @@ test_formats_type(const struct format_desc *intFormat,
 		GLint th = 1 + rand() % h;
 		GLint tx = rand() % (w - tw + 1);
 		GLint ty = rand() % (h - th + 1);
+		const struct piglit_ref_volume_box box = { tx, ty, 0, tw, th, 1 };
 
 		/* Choose a random alignment. */
 		static const GLint alignments[] = { 1, 2, 4, 8 };
@@ -316,10 +319,10 @@ test_formats_type(const struct format_desc *intFormat,
 
 		piglit_present_results();
 
-		if (!piglit_equal_images_update_rgba8(
-				original_ref, updated_swz_ref, testImg,
-				w, h, 1, tx, ty, 0, tw, th, 1,
-				bits)) {
+		/* Only the box of the previous iteration is restored. */
+		piglit_ref_volume_reset(ref);
+		piglit_ref_volume_update(ref, updated_swz_ref, &box);
+		if (!piglit_ref_volume_compare(ref, testImg, NULL)) {
 			printf("texsubimage-unpack failed\n");
 			printf("  internal format: %s\n", piglit_get_gl_enum_name(intFormat->internalformat));
 			printf("  format: %s\n", piglit_get_gl_enum_name(srcFormat->format));
@@ -353,6 +356,7 @@ test_format(const struct format_desc *intFormat)
 	GLubyte *updated_img, *updated_ref;
 	GLubyte *updated_swz_ref;
 	GLubyte *upload_data, *testImg;
+	struct piglit_ref_volume *ref;
 	bool pass = true;
 	GLuint pbo = 0;
 
@@ -415,6 +419,9 @@ test_format(const struct format_desc *intFormat)
 	draw_and_read_texture(w, h, updated_ref);
 	glDeleteTextures(1, &tex);
 
+	ref = piglit_ref_volume_create(PIGLIT_REF_VOLUME_RGBA8, w, h, 1,
+				       original_ref);
+
 	/* Test all source formats with type GL_UNSIGNED_BYTE. */
 	for (n = 0; n < ARRAY_SIZE(test_src_formats); ++n) {
 		const struct src_format_desc* srcFormat = &test_src_formats[n];
@@ -424,7 +431,7 @@ test_format(const struct format_desc *intFormat)
 		pass = test_formats_type(
 			intFormat, w, h,
 			srcFormat, GL_UNSIGNED_BYTE,
-			original_img, original_ref, updated_img, updated_ref,
+			original_img, ref, updated_img, updated_ref,
 			pbo, updated_swz_ref, upload_data, testImg) && pass;
 	}
 
@@ -433,10 +440,11 @@ test_format(const struct format_desc *intFormat)
 		pass = test_formats_type(
 			intFormat, w, h,
 			&test_src_formats[0], test_types[n],
-			original_img, original_ref, updated_img, updated_ref,
+			original_img, ref, updated_img, updated_ref,
 			pbo, updated_swz_ref, upload_data, testImg) && pass;
 	}
 
+	piglit_ref_volume_destroy(ref);
 	free(original_img);
 	free(original_ref);
 	free(updated_img);
@@ -33,6 +33,7 @@
 
 
 #include "piglit-util-gl.h"
+#include "piglit-ref-volume.h"
 #include "../fbo/fbo-formats.h"
 
 #define STR(x) #x
@@ -219,15 +220,21 @@ piglit_draw_rect_tex3d(float x, float y, float w, float h,
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 }
 
+/**
+ * Compare \p testImg with \p ref after replacing the updated box by the
+ * texels of \p updated_ref.  \p ref is reset first, so only the box
+ * updated by the current iteration is copied.
+ */
 static GLboolean
 equal_images(GLenum target,
-	     const GLubyte *original_ref,
+	     struct piglit_ref_volume *ref,
 	     const GLubyte *updated_ref,
 	     const GLubyte *testImg,
-	     GLuint w, GLuint h, GLuint d,
 	     GLuint tx, GLuint ty, GLuint tz,
 	     GLuint tw, GLuint th, GLuint td)
 {
+	struct piglit_ref_volume_box box;
+
 	switch (target) {
 	case GL_TEXTURE_1D:
 		ty = 0;
@@ -240,10 +247,16 @@ equal_images(GLenum target,
 		break;
 	}
 
-	return piglit_equal_images_update_rgba8(original_ref, updated_ref, testImg,
-						w, h, d,
-						tx, ty, tz, tw, th, td,
-						8);
+	box.x = tx;
+	box.y = ty;
+	box.z = tz;
+	box.w = tw;
+	box.h = th;
+	box.d = td;
+
+	piglit_ref_volume_reset(ref);
+	piglit_ref_volume_update(ref, updated_ref, &box);
+	return piglit_ref_volume_compare(ref, testImg, NULL);
 }
 
 /**
@@ -338,6 +351,7 @@ test_format(GLenum target, GLenum intFormat)
 	GLubyte *original_img, *original_ref;
 	GLubyte *updated_img, *updated_ref;
 	GLubyte *testImg;
+	struct piglit_ref_volume *ref;
 	GLboolean pass = GL_TRUE;
 	GLuint bw, bh, bb, wMask, hMask, dMask;
 	GLuint pbo = 0;
@@ -412,6 +426,9 @@ test_format(GLenum target, GLenum intFormat)
 	draw_and_read_texture(w, h, d, updated_ref);
 	glDeleteTextures(1, &tex);
 
+	ref = piglit_ref_volume_create(PIGLIT_REF_VOLUME_RGBA8, w, h, d,
+				       original_ref);
+
 	for (t = 0; t < 10; t++) {
 		/* Choose random region of texture to update.
 		 * Use sizes and positions that are multiples of
@@ -466,9 +483,7 @@ test_format(GLenum target, GLenum intFormat)
 
 		piglit_present_results();
 
-		if (!equal_images(target,
-				  original_ref, updated_ref, testImg,
-				  w, h, d,
+		if (!equal_images(target, ref, updated_ref, testImg,
 				  tx, ty, tz, tw, th, td)) {
 			printf("texsubimage failed\n");
 			printf("  target: %s\n", piglit_get_gl_enum_name(target));
@@ -479,6 +494,7 @@ test_format(GLenum target, GLenum intFormat)
 		}
 	}
 
+	piglit_ref_volume_destroy(ref);
 	free(original_img);
 	free(original_ref);
 	free(updated_img);
@@ -63,6 +63,7 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-sampler-ref.h"
 #include <limits.h>
 
 /* Only *_ARB versions of these exist. I am lazy to add the suffix. */
@@ -580,7 +581,7 @@ static GLuint prog_int, prog_uint, prog_offset;
 static GLint int_scale_loc, uint_scale_loc, use_offset_loc, int_use_offset_loc, uint_use_offset_loc;
 
 /* Image data. */
-static const int swizzle[4] = {2, 0, 1, 3};
+static const unsigned swizzle[4] = {2, 0, 1, 3};
 static const float border[4] = { 0.1, 0.9, 0.5, 0.8 };
 static float border_real[4];
 static float image[SIZEMAX * SIZEMAX * SIZEMAX * 4];
@@ -611,176 +612,49 @@ static int get_int_format_bits(const struct format_desc *format)
 	       maxbits >= 10 ? 10 : 8;
 }
 
-static void sample_nearest(int x, int y, int z,
-			   GLenum wrap_mode, GLenum filter,
-			   unsigned char pixel[4],
-			   const struct format_desc *format,
-			   GLboolean npot, GLboolean texswizzle,
-			   int bits)
+static void init_sampler(struct piglit_sampler_ref *sampler,
+			 GLenum wrap_mode, GLenum filter,
+			 const struct format_desc *format,
+			 GLboolean npot, GLboolean texswizzle,
+			 int bits)
 {
-	unsigned sample_border = 0;
-	float border_factor = 0;
-	int coords[3] = {x, y, z};
 	unsigned i;
-	float result[4];
-	int *iresult = (int*)result;
-	unsigned *uiresult = (unsigned*)result;
 
-	/* Zero coords according to the texture target. */
-	switch (texture_target) {
-	case GL_TEXTURE_1D:
-		coords[1] = 0;
-		/* Fall through. */
-
-	case GL_TEXTURE_2D:
-	case GL_TEXTURE_RECTANGLE:
-		coords[2] = 0;
-	}
-
-	if (texture_offset) {
-		coords[0] -= 3;
-		if (texture_target != GL_TEXTURE_1D)
-			coords[1] += 3;
-	}
-	/* Handle clamp mirroring. */
-	switch (wrap_mode) {
-	case GL_MIRROR_CLAMP_EXT:
-	case GL_MIRROR_CLAMP_TO_EDGE_EXT:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-		for (i = 0; i < 3; i++) {
-			if (coords[i] < 0) {
-				coords[i] = -coords[i] - 1;
-			}
-		}
-	}
-
-	/* Handle border sampling. */
-	switch (wrap_mode) {
-	case GL_CLAMP:
-	case GL_MIRROR_CLAMP_EXT:
-		if (filter != GL_LINEAR) {
-			break;
-		}
-
-	case GL_CLAMP_TO_BORDER:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-		sample_border = 0;
-		for (i = 0; i < 3; i++) {
-			if (coords[i] >= TEXTURE_SIZE(npot) || coords[i] < 0) {
-				sample_border++;
-			}
-		}
-	}
-
-	/* Figure out what the border factor is. */
-	switch (wrap_mode) {
-	case GL_CLAMP:
-	case GL_MIRROR_CLAMP_EXT:
-		if (filter == GL_LINEAR) {
-			const double factor[] = {0, 0.5, 0.75, 0.875};
-			border_factor = factor[sample_border];
-		}
-		break;
-	case GL_CLAMP_TO_BORDER:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-		if (sample_border) {
-			border_factor = 1;
-		}
-		break;
-	}
-
-	/* Handle wrapping. */
-	switch (wrap_mode) {
-	case GL_REPEAT:
-		for (i = 0; i < 3; i++) {
-			coords[i] = (coords[i] + TEXTURE_SIZE(npot)*10) % TEXTURE_SIZE(npot);
-		}
-		break;
-
-	case GL_CLAMP:
-	case GL_MIRROR_CLAMP_EXT:
-	case GL_CLAMP_TO_BORDER:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-	case GL_CLAMP_TO_EDGE:
-	case GL_MIRROR_CLAMP_TO_EDGE_EXT:
-		for (i = 0; i < 3; i++) {
-			coords[i] = coords[i] >= TEXTURE_SIZE(npot) ? TEXTURE_SIZE(npot)-1 :
-								coords[i] < 0 ? 0 : coords[i];
-		}
-		break;
-
-	case GL_MIRRORED_REPEAT:
-		for (i = 0; i < 3; i++) {
-			coords[i] = (coords[i] + TEXTURE_SIZE(npot)*10) % (TEXTURE_SIZE(npot) * 2);
-			if (coords[i] >= TEXTURE_SIZE(npot))
-				coords[i] = 2*TEXTURE_SIZE(npot) - coords[i] - 1;
-		}
-		break;
-	}
-
-	/* Sample the pixel. */
-	if (format->depth) {
-		result[0] = result[1] = result[2] =
-				image[(coords[2]*size_y*size_x +
-				       coords[1]*size_x + coords[0])];
-		result[3] = 1;
-	} else if (format->stencil) {
-		result[0] = result[1] = result[2] = result[3] =
-				image[(coords[2]*size_y*size_x +
-				       coords[1]*size_x + coords[0])];
-	} else {
-		memcpy(result,
-		       &image[(coords[2]*size_y*size_x +
-			       coords[1]*size_x + coords[0])*4],
-		       sizeof(result));
-	}
-
-	if (format->srgb) {
-		for (i = 0; i < 3; i++) {
-			result[i] = piglit_srgb_to_linear(result[i]);
-		}
-	}
-
-	/* Sample the border.
-	 * This is actually the only place we care about linear filtering,
-	 * for CLAMP. Pixels are expected to be sampled at their center,
-	 * so we don't have to take 4 samples. */
-	if (border_factor == 1) {
-		memcpy(result, border_real, 16);
-	} else if (border_factor) {
-		for (i = 0; i < 4; i++)
-			result[i] = border_real[i] * border_factor +
-				    result[i] * (1 - border_factor);
-	}
-
-	/* Texture swizzle. */
-	if (texswizzle) {
-		float orig[4];
-		memcpy(orig, result, 16);
-
-		for (i = 0; i < 4; i++) {
-			result[i] = orig[swizzle[i]];
-		}
-	}
+	memset(sampler, 0, sizeof(*sampler));
+	sampler->target = texture_target;
+	sampler->texels = image;
+	sampler->base_format = format->depth ? GL_DEPTH_COMPONENT :
+			       format->stencil ? GL_STENCIL_INDEX : GL_RGBA;
+	sampler->width = size_x;
+	sampler->height = size_y;
+	sampler->depth = size_z;
+	sampler->srgb = format->srgb;
+	sampler->wrap[0] = sampler->wrap[1] = sampler->wrap[2] = wrap_mode;
+	sampler->filter = filter;
+	memcpy(&sampler->border, border_real, 16);
+	sampler->swizzle = texswizzle ? swizzle : NULL;
 
 	/* Final conversion. */
 	switch (format->type) {
 	case FLOAT_TYPE:
+		sampler->type = PIGLIT_SAMPLER_REF_FLOAT;
 		for (i = 0; i < 4; i++) {
-			pixel[i] = result[i] * 255.1;
+			sampler->ubyte_scale[i] = 255.1;
 		}
 		break;
 	case INT_TYPE:
+		sampler->type = PIGLIT_SAMPLER_REF_INT;
 		for (i = 0; i < 4; i++) {
-			pixel[i] = iresult[i] * (255.1 / ((1ull << (bits-1))-1));
+			sampler->ubyte_scale[i] = 255.1 / ((1ull << (bits-1))-1);
 		}
 		break;
 	case UINT_TYPE:
+		sampler->type = PIGLIT_SAMPLER_REF_UINT;
 		for (i = 0; i < 4; i++) {
-			pixel[i] = uiresult[i] * (255.1 / ((1ull << bits)-1));
+			sampler->ubyte_scale[i] = 255.1 / ((1ull << bits)-1);
 		}
 		if (bits == 10) {
-			pixel[3] = uiresult[3] * (255.1 / 3);
+			sampler->ubyte_scale[3] = 255.1 / 3;
 		}
 		break;
 	}
@@ -1005,12 +879,57 @@ static GLboolean probe_pixels(const struct format_desc *format, GLboolean npot,
 	GLboolean pass = GL_TRUE;
 	int num_filters = format->type == FLOAT_TYPE ? 2 : 1;
 	int bits = get_int_format_bits(format);
+	unsigned tile_texels = TEXTURE_SIZE(npot) + BIAS_INT(npot)*2;
+	unsigned tile_bytes = tile_texels * tile_texels * 4;
+	struct piglit_sampler_ref samplers[2][ARRAY_SIZE(wrap_modes)];
+	struct piglit_sampler_ref_grid grids[2 * ARRAY_SIZE(wrap_modes)];
+	unsigned num_grids = 0;
+	unsigned char *expected_tiles;
 
 	pixels = malloc(piglit_width * piglit_height * 4);
 	glReadPixels(0, 0, piglit_width, piglit_height,
 		     GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 
-	/* make slices different for 3D textures */
+	/* Compute the expected colors of all tiles up front, so that they
+	 * can be generated in parallel. */
+	expected_tiles = malloc(2 * ARRAY_SIZE(wrap_modes) * tile_bytes);
+
+	for (i = 0; i < num_filters; i++) {
+		GLenum filter = i ? GL_LINEAR : GL_NEAREST;
+
+		for (j = 0; wrap_modes[j].mode != 0; j++) {
+			struct piglit_sampler_ref_grid *grid;
+
+			if (!wrap_modes[j].supported)
+				continue;
+
+			if (skip_test(wrap_modes[j].mode, filter))
+				continue;
+
+			init_sampler(&samplers[i][j], wrap_modes[j].mode,
+				     filter, format, npot, texswizzle, bits);
+
+			/* Sample at the texel centers. The slices are
+			 * the same for 3D textures. */
+			grid = &grids[num_grids++];
+			grid->sampler = &samplers[i][j];
+			grid->origin[0] = 0.5 - BIAS_INT(npot);
+			grid->origin[1] = 0.5 - BIAS_INT(npot);
+			grid->origin[2] = 0.5;
+			if (texture_offset) {
+				grid->origin[0] -= 3;
+				if (texture_target != GL_TEXTURE_1D)
+					grid->origin[1] += 3;
+			}
+			grid->step[0] = grid->step[1] = 1;
+			grid->width = grid->height = tile_texels;
+			grid->dst = &expected_tiles[(i * ARRAY_SIZE(wrap_modes) + j) *
+						    tile_bytes];
+			grid->dst_stride = tile_texels;
+		}
+	}
+
+	piglit_sampler_ref_fill_grids(grids, num_grids);
 
 	/* Loop over min/mag filters. */
 	for (i = 0; i < num_filters; i++) {
@@ -1061,7 +980,7 @@ static GLboolean probe_pixels(const struct format_desc *format, GLboolean npot,
 
 		/* Loop over all wrap modes. */
 		for (j = 0; wrap_modes[j].mode != 0; j++) {
-			unsigned char expected[4];
+			unsigned char *expected;
 			int x0, y0;
 			int a, b;
 
@@ -1073,18 +992,16 @@ static GLboolean probe_pixels(const struct format_desc *format, GLboolean npot,
 			if (skip_test(wrap_modes[j].mode, filter))
 				continue;
 
-			for (b = 0; b < (TEXTURE_SIZE(npot) + BIAS_INT(npot)*2); b++) {
-				for (a = 0; a < (TEXTURE_SIZE(npot) + BIAS_INT(npot)*2); a++) {
+			expected = &expected_tiles[(i * ARRAY_SIZE(wrap_modes) + j) *
+						   tile_bytes];
+
+			for (b = 0; b < tile_texels; b++) {
+				for (a = 0; a < tile_texels; a++) {
 					double x = x0 + TEXEL_SIZE*(a+0.5);
 					double y = y0 + TEXEL_SIZE*(b+0.5);
 
-					sample_nearest(a - BIAS_INT(npot), b - BIAS_INT(npot),
-						       0, /* the slices are the same */
-						       wrap_modes[j].mode, filter, expected,
-						       format, npot, texswizzle, bits);
-
 					if (!probe_pixel_rgba(pixels, piglit_width, deltamax_swizzled,
-							      x, y, expected, a, b,
+							      x, y, &expected[(b * tile_texels + a) * 4], a, b,
 							      sfilter, wrap_modes[j].name)) {
 						pass = GL_FALSE;
 						goto tile_done;
@@ -1097,6 +1014,7 @@ tile_done:
 		}
 	}
 
+	free(expected_tiles);
 	free(pixels);
 	return pass;
 }
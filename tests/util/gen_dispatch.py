@@ -90,11 +90,85 @@ class DispatchCode(object):
     @classmethod
     def emit(cls, out_dir, gl_registry):
         assert isinstance(gl_registry, registry.gl.Registry)
-        context_vars = dict(dispatch=cls, gl_registry=gl_registry)
+        function_hash = PerfectHash([c.name for c in gl_registry.commands])
+        context_vars = dict(dispatch=cls, gl_registry=gl_registry,
+                            function_hash=function_hash)
         render_template(cls.H_TEMPLATE, out_dir, **context_vars)
         render_template(cls.C_TEMPLATE, out_dir, **context_vars)
 
 
+def hash_name(name, seed):
+    """Hash a function name.
+
+    This must match hash_function_name() in piglit-dispatch.c: 32-bit FNV-1a
+    with the seed mixed into the offset basis, followed by the MurmurHash3
+    finalizer.
+    """
+    h = 0x811c9dc5 ^ seed
+    for byte in bytearray(name.encode('ascii')):
+        h = ((h ^ byte) * 0x01000193) & 0xffffffff
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & 0xffffffff
+    h ^= h >> 16
+    return h
+
+
+class PerfectHash(object):
+    """A perfect hash over a fixed list of names ("hash and displace").
+
+    Each name is first assigned a bucket with hash_name(name, 0). Then, from
+    the largest bucket to the smallest, every bucket is given the smallest
+    seed for which hash_name(name, seed) maps all of its names to distinct
+    free slots.  A lookup is therefore two hashes and one strcmp().
+
+    Attributes:
+        seeds: per-bucket seed, len(seeds) is a power of two.
+        slots: per-slot index into the name list, or EMPTY_SLOT.
+    """
+    EMPTY_SLOT = 0xffff
+
+    def __init__(self, names):
+        assert len(names) < self.EMPTY_SLOT
+
+        num_buckets = 1
+        while num_buckets * 4 < len(names):
+            num_buckets *= 2
+        num_slots = 1
+        while num_slots < 2 * len(names):
+            num_slots *= 2
+
+        buckets = [[] for _ in range(num_buckets)]
+        for index, name in enumerate(names):
+            buckets[hash_name(name, 0) & (num_buckets - 1)].append(index)
+
+        self.seeds = [0] * num_buckets
+        self.slots = [self.EMPTY_SLOT] * num_slots
+
+        order = sorted(range(num_buckets), key=lambda b: -len(buckets[b]))
+        for bucket in order:
+            if not buckets[bucket]:
+                break
+
+            for seed in range(1, 0x10000):
+                slots = [hash_name(names[i], seed) & (num_slots - 1)
+                         for i in buckets[bucket]]
+                if (len(set(slots)) == len(slots) and
+                        all(self.slots[s] == self.EMPTY_SLOT for s in slots)):
+                    break
+            else:
+                raise Exception('No perfect hash seed found for bucket '
+                                '{0}'.format(bucket))
+
+            self.seeds[bucket] = seed
+            for index, slot in zip(buckets[bucket], slots):
+                self.slots[slot] = index
+
+        log_debug('perfect hash: {0} names, {1} buckets, {2} slots'.format(
+            len(names), num_buckets, num_slots))
+
+
 def render_template(filename, out_dir, **context_vars):
     assert filename.endswith('.mako')
     template_filepath = os.path.join(os.path.dirname(__file__), filename)
@@ -93,16 +93,48 @@ static void reset_dispatch_pointers(void)
 % endfor
 }
 
+static void resolve_all_dispatch_pointers(void)
+{
+>-------void *p;
+
+% for alias_set in gl_registry.command_alias_map:
+<% f0 = alias_set.primary_command %>\
+>-------p = resolve_${f0.name}();
+>-------if (p)
+>------->-------piglit_dispatch_${f0.name} = p;
+% endfor
+}
+
 static const char * function_names[] = {
 % for command in gl_registry.commands:
 >-------"${command.name}",
 % endfor
 };
 
+/* Indexed like function_names. */
 static void* (*const function_resolvers[])(void) = {
-% for alias_set in gl_registry.command_alias_map:
-<% f0 = alias_set.primary_command %>\
+% for command in gl_registry.commands:
+<% f0 = gl_registry.command_alias_map[command.name].primary_command %>\
 >-------resolve_${f0.name},
 % endfor
 };
+
+/* Perfect hash over function_names, generated by PerfectHash in
+ * gen_dispatch.py.
+ */
+#define FUNCTION_HASH_BUCKET_MASK ${len(function_hash.seeds) - 1}
+#define FUNCTION_HASH_SLOT_MASK ${len(function_hash.slots) - 1}
+#define FUNCTION_HASH_EMPTY_SLOT ${function_hash.EMPTY_SLOT}
+
+static const uint16_t function_hash_seeds[] = {
+% for i in range(0, len(function_hash.seeds), 12):
+>-------${', '.join(str(x) for x in function_hash.seeds[i:i + 12])},
+% endfor
+};
+
+static const uint16_t function_hash_slots[] = {
+% for i in range(0, len(function_hash.slots), 12):
+>-------${', '.join(str(x) for x in function_hash.slots[i:i + 12])},
+% endfor
+};
 </%block>\
@@ -319,6 +319,8 @@ piglit_dispatch_default_init(piglit_dispatch_api api)
 	if (already_initialized)
 		return;
 
+	piglit_trace_begin("dispatch init");
+
 #ifdef PIGLIT_USE_WAFFLE
 	switch (api) {
 	case PIGLIT_DISPATCH_GL:
@@ -349,5 +351,6 @@ piglit_dispatch_default_init(piglit_dispatch_api api)
 				     default_get_proc_address_failure);
 	}
 
+	piglit_trace_end();
 	already_initialized = true;
 }
@@ -128,6 +128,45 @@ check_extension(const char *name)
 
 #include "piglit-dispatch-gen.c"
 
+static void
+ignore_error(const char *name)
+{
+	(void) name;
+}
+
+/**
+ * Returns true if PIGLIT_DISPATCH_EAGER is set, requesting that all
+ * dispatch pointers be resolved in piglit_dispatch_init().
+ */
+static bool
+eager_resolve_requested(void)
+{
+	const char *env = getenv("PIGLIT_DISPATCH_EAGER");
+
+	return env != NULL && env[0] != '\0' && strcmp(env, "0") != 0;
+}
+
+/**
+ * Resolve every dispatch pointer in one pass.
+ *
+ * Functions the implementation doesn't support keep their stub, so that
+ * calling them still reports them as unsupported.
+ */
+static void
+resolve_all(void)
+{
+	piglit_error_function_ptr saved_unsupported = unsupported;
+	piglit_error_function_ptr saved_failure = get_proc_address_failure;
+
+	unsupported = ignore_error;
+	get_proc_address_failure = ignore_error;
+
+	resolve_all_dispatch_pointers();
+
+	unsupported = saved_unsupported;
+	get_proc_address_failure = saved_failure;
+}
+
 /**
  * Initialize the dispatch mechanism.
  *
@@ -188,16 +227,52 @@ piglit_dispatch_init(piglit_dispatch_api api,
 	 * check_extension().
 	 */
 	gl_version = piglit_get_gl_version();
+
+	if (eager_resolve_requested())
+		resolve_all();
 }
 
 /**
- * Compare two strings in the function_names table.
+ * Hash a function name for lookup in the generated perfect hash.
+ *
+ * This must match hash_name() in gen_dispatch.py.
  */
-static int compare_function_names(const void *x, const void *y)
+static uint32_t
+hash_function_name(const char *name, uint32_t seed)
 {
-	const char *x_str = *(const char * const *) x;
-	const char *y_str = *(const char * const *) y;
-	return strcmp(x_str, y_str);
+	uint32_t h = 2166136261u ^ seed;
+
+	while (*name) {
+		h ^= (uint8_t) *name++;
+		h *= 16777619u;
+	}
+
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+/**
+ * Find \c name in the function_names table.
+ *
+ * Returns its index, or -1 if it is not a known GL function.
+ */
+static int
+find_function_name(const char *name)
+{
+	uint32_t seed = function_hash_seeds[hash_function_name(name, 0) &
+					    FUNCTION_HASH_BUCKET_MASK];
+	unsigned index = function_hash_slots[hash_function_name(name, seed) &
+					     FUNCTION_HASH_SLOT_MASK];
+
+	if (index == FUNCTION_HASH_EMPTY_SLOT ||
+	    strcmp(function_names[index], name) != 0)
+		return -1;
+
+	return index;
 }
 
 /**
@@ -222,17 +297,13 @@ static int compare_function_names(const void *x, const void *y)
 piglit_dispatch_function_ptr
 piglit_dispatch_resolve_function(const char *name)
 {
-	size_t item_size = sizeof(function_names[0]);
-	size_t num_items = ARRAY_SIZE(function_names);
-	const char * const *item = (const char * const *)
-		bsearch(&name, function_names, num_items, item_size,
-			compare_function_names);
+	int index = find_function_name(name);
+
 	check_initialized();
-	if (!item) {
+	if (index < 0) {
 		unsupported(name);
 		return NULL;
 	} else {
-		size_t item_index = item - function_names;
-		return function_resolvers[item_index]();
+		return function_resolvers[index]();
 	}
 }
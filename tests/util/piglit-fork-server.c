@@ -0,0 +1,318 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-fork-server.c
+ *
+ * Lets a test binary stay resident and fork a fresh process for each run,
+ * so that the dynamic linking and library constructors (and, when the
+ * platform is known up front, waffle initialization) are paid once per
+ * binary instead of once per test.
+ *
+ * The server is started as "<test> -fork-server <socket path>".  Each
+ * connection carries one request, a list of NUL-terminated fields:
+ *
+ *     cwd, stdout path, stderr path, argc, argv[0..argc-1], env...
+ *
+ * where every remaining field is a KEY=VALUE environment entry.  The
+ * client half-closes the connection after the request.  The server forks a
+ * child that sets up the process as requested and returns from
+ * piglit_gl_fork_server() into the test's main(), and answers with lines
+ *
+ *     pid <pid>
+ *     exit <status> | signal <signal>
+ *     rusage <utime> <stime> <maxrss KiB>
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piglit-util-gl.h"
+
+#if !defined(_WIN32)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#ifdef PIGLIT_USE_WAFFLE
+#include "piglit-framework-gl/piglit_wfl_framework.h"
+#endif
+
+static void
+write_reply(int fd, const char *format, ...) PRINTFLIKE(2, 3);
+
+static void
+write_reply(int fd, const char *format, ...)
+{
+	char line[128];
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = vsnprintf(line, sizeof(line), format, ap);
+	va_end(ap);
+
+	/* The client may have given up on us, nothing to do about it. */
+	if (write(fd, line, len) != len)
+		_exit(1);
+}
+
+static char *
+read_request(int fd, size_t *size)
+{
+	size_t capacity = 4096;
+	char *buf = malloc(capacity);
+
+	*size = 0;
+	for (;;) {
+		ssize_t n;
+
+		if (*size == capacity) {
+			capacity *= 2;
+			buf = realloc(buf, capacity);
+		}
+
+		n = read(fd, buf + *size, capacity - *size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			perror("fork server: read");
+			_exit(1);
+		}
+		if (n == 0)
+			return buf;
+		*size += n;
+	}
+}
+
+static void
+redirect(int target, const char *path, int flags)
+{
+	int fd = open(path, flags, 0644);
+
+	if (fd < 0) {
+		fprintf(stderr, "fork server: %s: %s\n", path, strerror(errno));
+		_exit(1);
+	}
+	dup2(fd, target);
+	close(fd);
+}
+
+/**
+ * Set up the test process from the request in \a buf.  Only returns on
+ * success; the new argument vector points into \a buf.
+ */
+static void
+setup_child(char *buf, size_t size, int *argc, char ***argv)
+{
+	char *end = buf + size;
+	char *fields[4];
+	char **new_argv;
+	char *p = buf;
+	int i, n;
+
+	for (i = 0; i < 4; i++) {
+		if (p >= end)
+			goto malformed;
+		fields[i] = p;
+		p += strlen(p) + 1;
+	}
+
+	n = atoi(fields[3]);
+	if (n < 1)
+		goto malformed;
+
+	new_argv = calloc(n + 1, sizeof(char *));
+	for (i = 0; i < n; i++) {
+		if (p >= end)
+			goto malformed;
+		new_argv[i] = p;
+		p += strlen(p) + 1;
+	}
+
+	/* Like the runner's own subprocesses, give each test a session of
+	 * its own so that a timeout can kill everything it started.
+	 */
+	setsid();
+
+	clearenv();
+	for (; p < end; p += strlen(p) + 1)
+		putenv(p);
+
+	/* Whatever the server latched from its own environment, the test
+	 * reads from the one it was given.
+	 */
+	piglit_trace_reset();
+	piglit_log_reset();
+
+	if (chdir(fields[0]) != 0) {
+		fprintf(stderr, "fork server: %s: %s\n",
+			fields[0], strerror(errno));
+		_exit(1);
+	}
+
+	redirect(STDIN_FILENO, "/dev/null", O_RDONLY);
+	redirect(STDOUT_FILENO, fields[1], O_WRONLY | O_CREAT | O_TRUNC);
+	redirect(STDERR_FILENO, fields[2], O_WRONLY | O_CREAT | O_TRUNC);
+
+	*argc = n;
+	*argv = new_argv;
+	return;
+
+malformed:
+	fprintf(stderr, "fork server: malformed request\n");
+	_exit(1);
+}
+
+/**
+ * Handle one connection.  Runs in a process forked for the connection,
+ * which returns only in the test child it forks in turn; it stays around
+ * itself to report how the test exited.
+ */
+static void
+serve(int conn, int *argc, char ***argv)
+{
+	struct rusage usage;
+	size_t size;
+	char *buf = read_request(conn, &size);
+	int status;
+	pid_t pid;
+
+	signal(SIGCHLD, SIG_DFL);
+
+	pid = fork();
+	if (pid < 0) {
+		perror("fork server: fork");
+		_exit(1);
+	}
+	if (pid == 0) {
+		close(conn);
+		setup_child(buf, size, argc, argv);
+		return;
+	}
+
+	write_reply(conn, "pid %d\n", (int) pid);
+
+	while (wait4(pid, &status, 0, &usage) < 0) {
+		if (errno != EINTR) {
+			perror("fork server: wait4");
+			_exit(1);
+		}
+	}
+
+	if (WIFSIGNALED(status))
+		write_reply(conn, "signal %d\n", WTERMSIG(status));
+	else
+		write_reply(conn, "exit %d\n", WEXITSTATUS(status));
+
+	write_reply(conn, "rusage %ld.%06ld %ld.%06ld %ld\n",
+		    (long) usage.ru_utime.tv_sec,
+		    (long) usage.ru_utime.tv_usec,
+		    (long) usage.ru_stime.tv_sec,
+		    (long) usage.ru_stime.tv_usec,
+		    (long) usage.ru_maxrss);
+	_exit(0);
+}
+
+void
+piglit_gl_fork_server(int *argc, char ***argv)
+{
+	struct sockaddr_un addr;
+	const char *path;
+	int sock;
+
+	if (*argc != 3 || strcmp((*argv)[1], "-fork-server") != 0)
+		return;
+
+	path = (*argv)[2];
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "fork server: socket path too long\n");
+		exit(1);
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		perror("fork server: socket");
+		exit(1);
+	}
+	unlink(path);
+	if (bind(sock, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+	    listen(sock, 64) != 0) {
+		perror("fork server");
+		exit(1);
+	}
+
+	/* Let the kernel reap the per-connection processes. */
+	signal(SIGCHLD, SIG_IGN);
+
+#ifdef PIGLIT_USE_WAFFLE
+	piglit_wfl_framework_preinit();
+#endif
+
+	fflush(stdout);
+	fflush(stderr);
+
+	for (;;) {
+		int conn = accept(sock, NULL, NULL);
+		pid_t pid;
+
+		if (conn < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("fork server: accept");
+			exit(1);
+		}
+
+		pid = fork();
+		if (pid == 0) {
+			close(sock);
+			serve(conn, argc, argv);
+			return;
+		}
+		if (pid < 0)
+			perror("fork server: fork");
+		close(conn);
+	}
+}
+
+#else
+
+void
+piglit_gl_fork_server(int *argc, char ***argv)
+{
+}
+
+#endif
@@ -0,0 +1,393 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * Software conversion of client pixel data to RGBA floats.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "piglit-util-gl.h"
+#include "piglit-format-convert.h"
+
+/**
+ * The RGBA component each channel of a pixel format is written to.
+ */
+struct format_layout {
+	GLenum format;
+	unsigned channels;
+	unsigned component[4];
+};
+
+static const struct format_layout format_layouts[] = {
+	{ GL_RED,             1, { 0 } },
+	{ GL_GREEN,           1, { 1 } },
+	{ GL_BLUE,            1, { 2 } },
+	{ GL_ALPHA,           1, { 3 } },
+	{ GL_INTENSITY,       1, { 0 } },
+	{ GL_LUMINANCE,       1, { 0 } },
+	{ GL_LUMINANCE_ALPHA, 2, { 0, 3 } },
+	{ GL_RG,              2, { 0, 1 } },
+	{ GL_RGB,             3, { 0, 1, 2 } },
+	{ GL_BGR,             3, { 2, 1, 0 } },
+	{ GL_RGBA,            4, { 0, 1, 2, 3 } },
+	{ GL_BGRA,            4, { 2, 1, 0, 3 } },
+	{ GL_ABGR_EXT,        4, { 3, 2, 1, 0 } },
+};
+
+/**
+ * Bit layout of a packed pixel type.  Channels are listed in the order
+ * they map to the components of the pixel format.
+ */
+struct packed_layout {
+	GLenum type;
+	unsigned bytes;
+	unsigned channels;
+	unsigned bits[4];
+	unsigned shift[4];
+};
+
+static const struct packed_layout packed_layouts[] = {
+	{ GL_UNSIGNED_BYTE_3_3_2,         1, 3, { 3, 3, 2 },      { 5, 2, 0 } },
+	{ GL_UNSIGNED_BYTE_2_3_3_REV,     1, 3, { 3, 3, 2 },      { 0, 3, 6 } },
+	{ GL_UNSIGNED_SHORT_5_6_5,        2, 3, { 5, 6, 5 },      { 11, 5, 0 } },
+	{ GL_UNSIGNED_SHORT_5_6_5_REV,    2, 3, { 5, 6, 5 },      { 0, 5, 11 } },
+	{ GL_UNSIGNED_SHORT_4_4_4_4,      2, 4, { 4, 4, 4, 4 },   { 12, 8, 4, 0 } },
+	{ GL_UNSIGNED_SHORT_4_4_4_4_REV,  2, 4, { 4, 4, 4, 4 },   { 0, 4, 8, 12 } },
+	{ GL_UNSIGNED_SHORT_5_5_5_1,      2, 4, { 5, 5, 5, 1 },   { 11, 6, 1, 0 } },
+	{ GL_UNSIGNED_SHORT_1_5_5_5_REV,  2, 4, { 5, 5, 5, 1 },   { 0, 5, 10, 15 } },
+	{ GL_UNSIGNED_INT_10_10_10_2,     4, 4, { 10, 10, 10, 2 }, { 22, 12, 2, 0 } },
+	{ GL_UNSIGNED_INT_2_10_10_10_REV, 4, 4, { 10, 10, 10, 2 }, { 0, 10, 20, 30 } },
+	{ GL_UNSIGNED_INT_8_8_8_8,        4, 4, { 8, 8, 8, 8 },   { 24, 16, 8, 0 } },
+	{ GL_UNSIGNED_INT_8_8_8_8_REV,    4, 4, { 8, 8, 8, 8 },   { 0, 8, 16, 24 } },
+};
+
+#define ARRAY_LENGTH(arr) (sizeof(arr) / sizeof(*arr))
+
+static const struct format_layout *
+find_format_layout(GLenum format)
+{
+	unsigned i;
+
+	for (i = 0; i < ARRAY_LENGTH(format_layouts); i++)
+		if (format_layouts[i].format == format)
+			return &format_layouts[i];
+
+	return NULL;
+}
+
+static const struct packed_layout *
+find_packed_layout(GLenum type)
+{
+	unsigned i;
+
+	for (i = 0; i < ARRAY_LENGTH(packed_layouts); i++)
+		if (packed_layouts[i].type == type)
+			return &packed_layouts[i];
+
+	return NULL;
+}
+
+static float
+un_to_float(unsigned bits, uint32_t color)
+{
+	uint32_t max = ~0u >> (32 - bits);
+	return (float)color / (float)max;
+}
+
+static float
+sn_to_float(unsigned bits, int32_t color)
+{
+	int32_t max = ~(~0u << (bits - 1));
+	if (color < -max)
+		color = -max;
+	return (float)color / (float)max;
+}
+
+/**
+ * Tables of the normalized value of every n-bit integer, indexed by the
+ * raw bits.  They are built on first use.
+ */
+static float *unorm_tables[17];
+static float *snorm_tables[17];
+
+static const float *
+get_unorm_table(unsigned bits)
+{
+	assert(bits <= 16);
+
+	if (unorm_tables[bits] == NULL) {
+		uint32_t i, size = 1u << bits;
+		float *table = malloc(size * sizeof(float));
+
+		assert(table != NULL);
+		for (i = 0; i < size; i++)
+			table[i] = un_to_float(bits, i);
+		unorm_tables[bits] = table;
+	}
+
+	return unorm_tables[bits];
+}
+
+static const float *
+get_snorm_table(unsigned bits)
+{
+	assert(bits >= 2 && bits <= 16);
+
+	if (snorm_tables[bits] == NULL) {
+		uint32_t i, size = 1u << bits;
+		float *table = malloc(size * sizeof(float));
+
+		assert(table != NULL);
+		for (i = 0; i < size; i++) {
+			/* Sign-extend the raw bits. */
+			int32_t value = (int32_t)(i << (32 - bits)) >>
+					(32 - bits);
+			table[i] = sn_to_float(bits, value);
+		}
+		snorm_tables[bits] = table;
+	}
+
+	return snorm_tables[bits];
+}
+
+/**
+ * Unpack channel \c c of a packed type into every fourth float of \c dst.
+ */
+static void
+unpack_packed_channel(const struct packed_layout *layout, unsigned c,
+		      const void *src, unsigned count, float *dst)
+{
+	const float *table = get_unorm_table(layout->bits[c]);
+	const uint32_t mask = (1u << layout->bits[c]) - 1;
+	const unsigned shift = layout->shift[c];
+	unsigned i;
+
+	switch (layout->bytes) {
+	case 1: {
+		const GLubyte *p = src;
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[(p[i] >> shift) & mask];
+		break;
+	}
+	case 2: {
+		const GLushort *p = src;
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[(p[i] >> shift) & mask];
+		break;
+	}
+	case 4: {
+		const GLuint *p = src;
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[(p[i] >> shift) & mask];
+		break;
+	}
+	default:
+		assert(!"Invalid packed size");
+	}
+}
+
+/**
+ * Unpack channel \c c of an array type with \c channels channels into
+ * every fourth float of \c dst.
+ */
+static void
+unpack_array_channel(GLenum type, unsigned channels, unsigned c,
+		     const void *src, unsigned count, float *dst)
+{
+	const float *table;
+	unsigned i;
+
+	switch (type) {
+	case GL_UNSIGNED_BYTE: {
+		const GLubyte *p = (const GLubyte *)src + c;
+		table = get_unorm_table(8);
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[p[i * channels]];
+		break;
+	}
+	case GL_BYTE: {
+		const GLubyte *p = (const GLubyte *)src + c;
+		table = get_snorm_table(8);
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[p[i * channels]];
+		break;
+	}
+	case GL_UNSIGNED_SHORT: {
+		const GLushort *p = (const GLushort *)src + c;
+		table = get_unorm_table(16);
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[p[i * channels]];
+		break;
+	}
+	case GL_SHORT: {
+		const GLushort *p = (const GLushort *)src + c;
+		table = get_snorm_table(16);
+		for (i = 0; i < count; i++)
+			dst[4 * i] = table[p[i * channels]];
+		break;
+	}
+	case GL_UNSIGNED_INT: {
+		const GLuint *p = (const GLuint *)src + c;
+		for (i = 0; i < count; i++)
+			dst[4 * i] = un_to_float(32, p[i * channels]);
+		break;
+	}
+	case GL_INT: {
+		const GLint *p = (const GLint *)src + c;
+		for (i = 0; i < count; i++)
+			dst[4 * i] = sn_to_float(32, p[i * channels]);
+		break;
+	}
+	case GL_FLOAT: {
+		const GLfloat *p = (const GLfloat *)src + c;
+		for (i = 0; i < count; i++)
+			dst[4 * i] = p[i * channels];
+		break;
+	}
+	default:
+		assert(!"Invalid type");
+	}
+}
+
+static bool
+is_array_type(GLenum type)
+{
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+	case GL_BYTE:
+	case GL_UNSIGNED_SHORT:
+	case GL_SHORT:
+	case GL_UNSIGNED_INT:
+	case GL_INT:
+	case GL_FLOAT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool
+piglit_unpack_is_supported(GLenum format, GLenum type)
+{
+	const struct format_layout *fmt = find_format_layout(format);
+	const struct packed_layout *packed = find_packed_layout(type);
+
+	if (fmt == NULL)
+		return false;
+	if (packed != NULL)
+		return packed->channels == fmt->channels;
+	return is_array_type(type);
+}
+
+void
+piglit_unpack_to_rgba_float(GLenum format, GLenum type, const void *src,
+			    unsigned count, float *dst)
+{
+	const struct format_layout *fmt = find_format_layout(format);
+	const struct packed_layout *packed = find_packed_layout(type);
+	unsigned i, c;
+
+	assert(piglit_unpack_is_supported(format, type));
+
+	for (i = 0; i < count; i++) {
+		dst[4 * i + 0] = 0.0f;
+		dst[4 * i + 1] = 0.0f;
+		dst[4 * i + 2] = 0.0f;
+		dst[4 * i + 3] = 1.0f;
+	}
+
+	for (c = 0; c < fmt->channels; c++) {
+		if (packed != NULL)
+			unpack_packed_channel(packed, c, src, count,
+					      dst + fmt->component[c]);
+		else
+			unpack_array_channel(type, fmt->channels, c, src,
+					     count, dst + fmt->component[c]);
+	}
+
+	switch (format) {
+	case GL_INTENSITY:
+		for (i = 0; i < count; i++)
+			dst[4 * i + 3] = dst[4 * i];
+		/* Fall through. */
+	case GL_LUMINANCE:
+	case GL_LUMINANCE_ALPHA:
+		for (i = 0; i < count; i++) {
+			dst[4 * i + 1] = dst[4 * i];
+			dst[4 * i + 2] = dst[4 * i];
+		}
+		break;
+	}
+}
+
+#define SRGB_TABLE_SIZE 4096
+
+/**
+ * Linear values at SRGB_TABLE_SIZE + 1 evenly spaced points of [0, 1].
+ * Values in between are interpolated, which is accurate to about 1e-7.
+ */
+static float *srgb_table;
+
+static float
+srgb_to_linear_table(float s)
+{
+	float x;
+	int i;
+
+	if (!(s >= 0.0f && s <= 1.0f))
+		return piglit_srgb_to_linear(s);
+
+	if (srgb_table == NULL) {
+		float *table = malloc((SRGB_TABLE_SIZE + 1) * sizeof(float));
+
+		assert(table != NULL);
+		for (i = 0; i <= SRGB_TABLE_SIZE; i++)
+			table[i] = piglit_srgb_to_linear(
+				(float)i / SRGB_TABLE_SIZE);
+		srgb_table = table;
+	}
+
+	x = s * SRGB_TABLE_SIZE;
+	i = (int)x;
+	if (i == SRGB_TABLE_SIZE)
+		return srgb_table[i];
+
+	return srgb_table[i] + (x - i) * (srgb_table[i + 1] - srgb_table[i]);
+}
+
+void
+piglit_srgb_to_linear_rgba(float *rgba, unsigned count)
+{
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		rgba[4 * i + 0] = srgb_to_linear_table(rgba[4 * i + 0]);
+		rgba[4 * i + 1] = srgb_to_linear_table(rgba[4 * i + 1]);
+		rgba[4 * i + 2] = srgb_to_linear_table(rgba[4 * i + 2]);
+	}
+}
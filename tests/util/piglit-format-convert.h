@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Software conversion of client pixel data to RGBA floats.
+ *
+ * These compute the reference values that the GL should produce when
+ * unpacking a \c format / \c type pair, for tests that check texture
+ * uploads.  The conversion works on whole rows: the per-type unpacking is
+ * looked up once per call, and normalized values come from tables.
+ */
+
+#ifndef PIGLIT_FORMAT_CONVERT_H
+#define PIGLIT_FORMAT_CONVERT_H
+
+#include <stdbool.h>
+
+#include <piglit/gl_wrap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Determine if piglit_unpack_to_rgba_float() handles \c format and \c type.
+ */
+bool
+piglit_unpack_is_supported(GLenum format, GLenum type);
+
+/**
+ * Convert \c count tightly packed pixels of \c format / \c type to RGBA
+ * floats, following the unpacking rules of the pixel transfer path.
+ *
+ * Components missing from \c format are 0, except alpha which is 1.
+ * Luminance is copied to red, green and blue, and intensity to all four
+ * components.  Normalized integer types are converted to [0, 1] or
+ * [-1, 1]; no clamping is done.
+ *
+ * \c dst must have room for 4 * \c count floats.
+ */
+void
+piglit_unpack_to_rgba_float(GLenum format, GLenum type, const void *src,
+			    unsigned count, float *dst);
+
+/**
+ * Decode the red, green and blue components of \c count RGBA pixels from
+ * sRGB to linear, in place.  Alpha is left alone.
+ *
+ * This matches piglit_srgb_to_linear(), but values in [0, 1] are decoded
+ * through a table instead of calling pow() for each component.
+ */
+void
+piglit_srgb_to_linear_rgba(float *rgba, unsigned count);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
+
+#endif /* PIGLIT_FORMAT_CONVERT_H */
@@ -23,6 +23,11 @@
 
 #include <stdlib.h>
 #include <regex.h>
+#include <setjmp.h>
+
+#ifdef PIGLIT_HAS_PTHREADS
+#include <pthread.h>
+#endif
 
 #include "piglit-framework-cl.h"
 
@@ -132,6 +137,256 @@ bool check_device_extensions(cl_device_id device_id, char* extensions)
 	return true;
 }
 
+/* Per-device test runs */
+
+struct device_subtest {
+	char* name;
+	enum piglit_result result;
+};
+
+struct device_run {
+	int argc;
+	const char** argv;
+	const struct piglit_cl_test_config_header* config;
+	int version;
+	cl_platform_id platform_id;
+	cl_device_id device_id;
+
+	enum piglit_result result;
+	int64_t time_ns;
+
+	/* Subtest results held back while runs are on worker threads */
+	struct device_subtest* subtests;
+	unsigned int num_subtests;
+	/* Where piglit_report_result() returns to on a worker thread */
+	jmp_buf exit_jmp;
+};
+
+static void*
+run_on_device(void* data)
+{
+	struct device_run* run = data;
+
+	run->time_ns = piglit_time_get_nano();
+	run->result = run->config->_test_run(run->argc,
+	                                     run->argv,
+	                                     (void*)run->config,
+	                                     run->version,
+	                                     run->platform_id,
+	                                     run->device_id);
+	run->time_ns = piglit_time_get_nano() - run->time_ns;
+
+	return NULL;
+}
+
+#ifdef PIGLIT_HAS_PTHREADS
+static void
+device_run_subtest(void* data, enum piglit_result result, const char* name)
+{
+	struct device_run* run = data;
+
+	run->subtests = realloc(run->subtests,
+	                        (run->num_subtests + 1) *
+	                        sizeof(struct device_subtest));
+	run->subtests[run->num_subtests++] = (struct device_subtest) {
+		.name = strdup(name),
+		.result = result,
+	};
+}
+
+/*
+ * piglit_report_result() from a test on a worker thread ends that run
+ * alone, with the reported result, instead of the whole process.
+ */
+static void
+device_run_exit(void* data, enum piglit_result result)
+{
+	struct device_run* run = data;
+
+	run->result = result;
+	run->time_ns = piglit_time_get_nano() - run->time_ns;
+	longjmp(run->exit_jmp, 1);
+}
+
+static void
+run_on_device_buffered(struct device_run* run)
+{
+	const struct piglit_result_sink sink = {
+		.subtest = device_run_subtest,
+		.result = device_run_exit,
+		.data = run,
+	};
+
+	piglit_set_thread_result_sink(&sink);
+	if(setjmp(run->exit_jmp) == 0) {
+		run_on_device(run);
+	}
+	piglit_set_thread_result_sink(NULL);
+}
+
+/*
+ * Report the subtest results the runs held back, now that all of them are
+ * complete.  Each device's results are listed in device order, then every
+ * subtest is reported once, with the worst of its results on all devices,
+ * so that the recorded result doesn't depend on which run finished last.
+ */
+static void
+report_device_subtests(struct device_run* runs, unsigned int num_runs)
+{
+	struct device_subtest* merged = NULL;
+	unsigned int num_merged = 0;
+	unsigned int i, j, k;
+
+	for(i = 0; i < num_runs; i++) {
+		printf("\n");
+		print_test_info(runs[i].config, runs[i].version,
+		                runs[i].platform_id, runs[i].device_id);
+
+		for(j = 0; j < runs[i].num_subtests; j++) {
+			struct device_subtest* subtest = &runs[i].subtests[j];
+
+			printf("#   %s: %s\n", subtest->name,
+			       piglit_result_to_string(subtest->result));
+
+			for(k = 0; k < num_merged; k++) {
+				if(!strcmp(merged[k].name, subtest->name)) {
+					break;
+				}
+			}
+			if(k == num_merged) {
+				merged = realloc(merged, (num_merged + 1) *
+				                         sizeof(struct device_subtest));
+				merged[num_merged++] = (struct device_subtest) {
+					.name = subtest->name,
+					.result = PIGLIT_SKIP,
+				};
+			}
+			piglit_merge_result(&merged[k].result, subtest->result);
+		}
+	}
+	printf("\n");
+
+	for(k = 0; k < num_merged; k++) {
+		piglit_report_subtest_result(merged[k].result, "%s",
+		                             merged[k].name);
+	}
+	free(merged);
+
+	for(i = 0; i < num_runs; i++) {
+		for(j = 0; j < runs[i].num_subtests; j++) {
+			free(runs[i].subtests[j].name);
+		}
+		free(runs[i].subtests);
+	}
+}
+
+struct device_run_queue {
+	pthread_mutex_t lock;
+	struct device_run* runs;
+	unsigned int num_runs;
+	unsigned int next;
+};
+
+static void*
+device_run_worker(void* data)
+{
+	struct device_run_queue* queue = data;
+
+	while(true) {
+		unsigned int i;
+
+		pthread_mutex_lock(&queue->lock);
+		i = queue->next++;
+		pthread_mutex_unlock(&queue->lock);
+
+		if(i >= queue->num_runs) {
+			return NULL;
+		}
+
+		run_on_device_buffered(&queue->runs[i]);
+	}
+}
+#endif
+
+/*
+ * Run the test on every collected device, on up to num_threads worker
+ * threads.  Each run creates its own context and command queues, so runs
+ * on different devices are independent.  Results are merged in device
+ * order once all runs are complete.
+ *
+ * On worker threads, each run's subtest results and its
+ * piglit_report_result() are held back and reported by
+ * report_device_subtests().  Anything else the test prints goes straight
+ * to stdout, interleaved with the other runs.
+ */
+static void
+run_on_devices(struct device_run* runs, unsigned int num_runs,
+               unsigned int num_threads, enum piglit_result* result)
+{
+	unsigned int i;
+
+#ifdef PIGLIT_HAS_PTHREADS
+	if(num_threads > num_runs) {
+		num_threads = num_runs;
+	}
+
+	if(num_threads > 1) {
+		struct device_run_queue queue = {
+			.lock = PTHREAD_MUTEX_INITIALIZER,
+			.runs = runs,
+			.num_runs = num_runs,
+			.next = 0,
+		};
+		pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+		unsigned int num_started = 0;
+
+		printf("# Running on %u devices with %u threads.\n\n",
+		       num_runs, num_threads);
+		fflush(stdout);
+
+		for(i = 0; i < num_threads; i++) {
+			if(pthread_create(&threads[num_started], NULL,
+			                  device_run_worker, &queue) == 0) {
+				num_started++;
+			}
+		}
+		/* If no thread could be started, run everything here. */
+		if(num_started == 0) {
+			device_run_worker(&queue);
+		}
+		for(i = 0; i < num_started; i++) {
+			pthread_join(threads[i], NULL);
+		}
+
+		free(threads);
+		report_device_subtests(runs, num_runs);
+	} else
+#endif
+	{
+		for(i = 0; i < num_runs; i++) {
+			print_test_info(runs[i].config, runs[i].version,
+			                runs[i].platform_id, runs[i].device_id);
+			run_on_device(&runs[i]);
+		}
+	}
+
+	if(num_runs > 0) {
+		printf("# Device timing:\n");
+	}
+	for(i = 0; i < num_runs; i++) {
+		char* device_name = piglit_cl_get_device_info(runs[i].device_id,
+		                                              CL_DEVICE_NAME);
+
+		printf("#   %s: %s in %.3f ms\n",
+		       device_name,
+		       piglit_result_to_string(runs[i].result),
+		       runs[i].time_ns / 1000000.0);
+		piglit_merge_result(result, runs[i].result);
+
+		free(device_name);
+	}
+}
+
 /* Run the test(s) */
 int piglit_cl_framework_run(int argc, char** argv)
 {
@@ -141,6 +396,8 @@ int piglit_cl_framework_run(int argc, char** argv)
 	cl_platform_id platform_id = NULL;
 	cl_device_id device_id = NULL;
 
+	piglit_watch_deadline();
+
 	/* Get test configuration */
 	struct piglit_cl_test_config_header *config =
 		piglit_cl_get_test_config(argc,
@@ -196,6 +453,9 @@ int piglit_cl_framework_run(int argc, char** argv)
 		unsigned int num_platforms;
 		cl_platform_id* platform_ids;
 
+		unsigned int num_device_runs = 0;
+		struct device_run* device_runs = NULL;
+
 		/* Create regexes */
 		if(   config->platform_regex != NULL
 		   && regcomp(&platform_regex, config->platform_regex, REG_EXTENDED | REG_NEWLINE)) {
@@ -340,20 +600,33 @@ int piglit_cl_framework_run(int argc, char** argv)
 						final_version = device_version;
 					}
 
-					print_test_info(config, version, platform_id, device_id);
-					piglit_merge_result(&result,
-					                    config->_test_run(argc,
-					                                      (const char**)argv,
-					                                      (void*)config,
-					                                      final_version,
-					                                      platform_id,
-					                                      device_id));
+					/* queue test run on device */
+					device_runs = realloc(device_runs,
+					                      (num_device_runs + 1) *
+					                      sizeof(struct device_run));
+					device_runs[num_device_runs++] = (struct device_run) {
+						.argc = argc,
+						.argv = (const char**)argv,
+						.config = config,
+						.version = final_version,
+						.platform_id = platform_id,
+						.device_id = device_id,
+						.result = PIGLIT_SKIP,
+					};
 				}
 
 				free(device_ids);
 			}
 		}
 
+		if(config->run_per_device) {
+			run_on_devices(device_runs, num_device_runs,
+			               piglit_cl_get_parallel_arg(argc,
+			                                          (const char**)argv),
+			               &result);
+			free(device_runs);
+		}
+
 		if(config->platform_regex != NULL) {
 			regfree(&platform_regex);
 		}
@@ -369,6 +642,9 @@ int piglit_cl_framework_run(int argc, char** argv)
 		config->clean_func(argc, (const char**)argv, config);
 	}
 
+	piglit_cl_print_program_cache_stats();
+	piglit_cl_report_profiling();
+
 	/* Report merged result */
 	printf("# Result:\n");
 	piglit_report_result(result);
@@ -469,6 +745,31 @@ piglit_cl_get_version_arg(int argc, const char** argv)
 	return version_major*10 + version_minor;
 }
 
+unsigned int
+piglit_cl_get_parallel_arg(int argc, const char** argv)
+{
+	int num_threads = 1;
+
+	const char* parallel_str;
+
+	/* First check argument then environment */
+	parallel_str = piglit_cl_get_arg_value(argc, argv, "parallel");
+	if(parallel_str == NULL) {
+		parallel_str = getenv("PIGLIT_CL_PARALLEL");
+	}
+
+	if(parallel_str != NULL) {
+		if(sscanf(parallel_str, "%i", &num_threads) != 1 || num_threads < 1) {
+			fprintf(stderr,
+			        "Invalid number of device threads: %s\n",
+			        parallel_str);
+			num_threads = 1;
+		}
+	}
+
+	return num_threads;
+}
+
 bool
 piglit_cl_get_platform_arg(const int argc, const char** argv,
                            cl_platform_id* platform_id)
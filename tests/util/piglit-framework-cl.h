@@ -313,6 +313,27 @@ piglit_cl_get_unnamed_arg(const int argc, const char** argv, int index);
 int
 piglit_cl_get_version_arg(int argc, const char** argv);
 
+/**
+ * \brief Get number of threads to run per-device tests on.
+ *
+ * Get value passed after argument "-parallel". If parallel
+ * argument is not defined use PIGLIT_CL_PARALLEL environment
+ * variable.
+ *
+ * When greater than one, tests with \c run_per_device run on that many
+ * devices concurrently, each on its own thread with its own context and
+ * command queues.  Output of concurrent runs may interleave, but
+ * subtest results are listed per device once all runs are done, and
+ * each subtest is reported once with its worst result on any device.
+ * piglit_report_result() from a test ends only that device's run.
+ *
+ * @param argc  Argument count passed to \c main().
+ * @param argv  Argument vector passed to \c main().
+ * @return      Number of threads, 1 if not defined.
+ */
+unsigned int
+piglit_cl_get_parallel_arg(int argc, const char** argv);
+
 /**
  * \brief Get platform id passed to program.
  *
@@ -181,14 +181,55 @@ destroy(void)
 		gl_fw->destroy(gl_fw);
 }
 
+static void (*untraced_init)(int argc, char *argv[]);
+static enum piglit_result (*untraced_display)(void);
+
+static void
+traced_init(int argc, char *argv[])
+{
+	piglit_trace_begin("piglit_init");
+	untraced_init(argc, argv);
+	piglit_trace_end();
+}
+
+static enum piglit_result
+traced_display(void)
+{
+	enum piglit_result result;
+
+	piglit_trace_begin("piglit_display");
+	result = untraced_display();
+	piglit_trace_end();
+
+	return result;
+}
+
 void
 piglit_gl_test_run(int argc, char *argv[],
 		   const struct piglit_gl_test_config *config)
 {
+	static struct piglit_gl_test_config traced_config;
+
 	piglit_width = config->window_width;
 	piglit_height = config->window_height;
 
+	piglit_watch_deadline();
+
+	/* Wrap the test's callbacks here rather than in every framework. */
+	if (piglit_trace_enabled()) {
+		traced_config = *config;
+		untraced_init = config->init;
+		untraced_display = config->display;
+		if (config->init)
+			traced_config.init = traced_init;
+		if (config->display)
+			traced_config.display = traced_display;
+		config = &traced_config;
+	}
+
+	piglit_trace_begin("framework creation");
 	gl_fw = piglit_gl_framework_factory(config);
+	piglit_trace_end();
 	if (gl_fw == NULL) {
 		printf("piglit: error: failed to create "
 		       "piglit_gl_framework\n");
@@ -221,6 +262,130 @@ piglit_swap_buffers(void)
 		gl_fw->swap_buffers(gl_fw);
 }
 
+#ifdef PIGLIT_USE_OPENGL
+/**
+ * Frames dumped with -png are read back into a ring of pixel pack
+ * buffers.  A buffer is mapped and handed to piglit_dump_image() only
+ * when its slot comes round again, DUMP_RING_SIZE frames later, so the
+ * test does not wait for the readback.  Together with the bounded queue
+ * of piglit_dump_image() this limits how much memory the dumps use.
+ */
+#define DUMP_RING_SIZE 3
+
+static struct dump_slot {
+	GLuint pbo;
+	GLsizeiptr size;
+	int width, height;
+	/** Name of the frame in the buffer, NULL if there is none. */
+	char *name;
+} dump_ring[DUMP_RING_SIZE];
+
+static unsigned dump_ring_next;
+
+static bool
+dump_ring_supported(void)
+{
+	static int supported = -1;
+
+	if (supported < 0) {
+		supported = piglit_dump_image_is_async() &&
+			    (piglit_get_gl_version() >= 21 ||
+			     piglit_is_extension_supported("GL_ARB_pixel_buffer_object"));
+	}
+
+	return supported;
+}
+
+static void
+dump_slot_finish(struct dump_slot *slot)
+{
+	GLubyte *image = malloc(slot->size);
+	const void *map;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+	map = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (map == NULL || image == NULL) {
+		/* The frame is lost, but the test itself is unaffected. */
+		fprintf(stderr, "piglit: failed to read back frame %s, "
+			"skipping it\n", slot->name);
+		if (map)
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		free(image);
+	} else {
+		memcpy(image, map, slot->size);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+		piglit_dump_image(slot->name, GL_RGBA, slot->width,
+				  slot->height, image, true);
+	}
+	free(slot->name);
+	slot->name = NULL;
+}
+
+/**
+ * Write the frames still in the ring, oldest first.  Runs at exit,
+ * before the framework is destroyed.
+ */
+static void
+dump_ring_drain(void)
+{
+	GLint prev_pbo;
+	unsigned i;
+
+	glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_pbo);
+	for (i = 0; i < DUMP_RING_SIZE; i++) {
+		struct dump_slot *slot =
+			&dump_ring[(dump_ring_next + i) % DUMP_RING_SIZE];
+
+		if (slot->name)
+			dump_slot_finish(slot);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, prev_pbo);
+
+	/* The image writer's own exit handler may already have run. */
+	piglit_dump_image_flush();
+}
+
+static void
+dump_ring_push(char *name)
+{
+	struct dump_slot *slot = &dump_ring[dump_ring_next];
+	GLsizeiptr size = 4 * piglit_width * piglit_height;
+	static bool registered = false;
+	GLint prev_pbo;
+
+	if (!registered) {
+		atexit(dump_ring_drain);
+		registered = true;
+	}
+
+	glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_pbo);
+
+	if (slot->name)
+		dump_slot_finish(slot);
+
+	if (slot->pbo == 0)
+		glGenBuffers(1, &slot->pbo);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+	if (slot->size != size) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL,
+			     GL_STREAM_READ);
+		slot->size = size;
+	}
+
+	glReadPixels(0, 0, piglit_width, piglit_height,
+		     GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	assert(glGetError() == GL_NO_ERROR);
+
+	slot->width = piglit_width;
+	slot->height = piglit_height;
+	slot->name = name;
+	dump_ring_next = (dump_ring_next + 1) % DUMP_RING_SIZE;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, prev_pbo);
+}
+#endif
+
 void
 piglit_present_results(void)
 {
@@ -240,18 +405,24 @@ piglit_present_results(void)
 					fileprefix[i] = '_';
 			}
 		}
-		image = malloc(4 * piglit_width * piglit_height);
-		glReadPixels(0, 0, piglit_width, piglit_height,
-			     base_format, GL_UNSIGNED_BYTE, image);
-		assert(glGetError() == GL_NO_ERROR);
 
-		asprintf(&filename, "%s%03d.png", fileprefix, frame++);
-
-		printf("Writing %s...\n", filename);
-		piglit_write_png(filename, base_format, piglit_width,
-				 piglit_height, image, true);
-		free(filename);
-		free(image);
+		asprintf(&filename, "%s%03d", fileprefix, frame++);
+
+#ifdef PIGLIT_USE_OPENGL
+		if (dump_ring_supported()) {
+			dump_ring_push(filename);
+		} else
+#endif
+		{
+			image = malloc(4 * piglit_width * piglit_height);
+			glReadPixels(0, 0, piglit_width, piglit_height,
+				     base_format, GL_UNSIGNED_BYTE, image);
+			assert(glGetError() == GL_NO_ERROR);
+
+			piglit_dump_image(filename, base_format, piglit_width,
+					  piglit_height, image, true);
+			free(filename);
+		}
 	}
 
 	if (!piglit_automatic)
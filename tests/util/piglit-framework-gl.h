@@ -243,6 +243,15 @@ void
 piglit_gl_test_run(int argc, char *argv[],
 		   const struct piglit_gl_test_config *config);
 
+/**
+ * If the arguments are "-fork-server <socket path>", serve test runs from
+ * the socket instead of running the test.  Returns in each forked test
+ * process with the arguments of its request, and otherwise does nothing.
+ * See piglit-fork-server.c.
+ */
+void
+piglit_gl_fork_server(int *argc, char ***argv);
+
 #ifdef __cplusplus
 #  define PIGLIT_EXTERN_C_BEGIN extern "C" {
 #  define PIGLIT_EXTERN_C_END   }
@@ -269,6 +278,7 @@ piglit_gl_test_run(int argc, char *argv[],
                 struct piglit_gl_test_config config;                         \
                                                                              \
                 piglit_disable_error_message_boxes();                        \
+                piglit_gl_fork_server(&argc, &argv);                         \
                                                                              \
                 piglit_gl_test_config_init(&config);                         \
                                                                              \
@@ -27,6 +27,8 @@
 #include "piglit_fbo_framework.h"
 #include "piglit_wfl_framework.h"
 
+/** When piglit_fbo_framework_create() was entered, for the startup log. */
+static int64_t create_time;
 
 static void
 destroy(struct piglit_gl_framework *gl_fw)
@@ -44,8 +46,13 @@ static void
 run_test(struct piglit_gl_framework *gl_fw,
          int argc, char *argv[])
 {
+	struct piglit_wfl_framework *wfl_fw = piglit_wfl_framework(gl_fw);
 	enum piglit_result result = PIGLIT_PASS;
 
+	piglit_logd("FBO framework started in %.3f ms (%s)",
+		    (piglit_time_get_nano() - create_time) / 1.0e6,
+		    wfl_fw->window ? "with a window" : "surfaceless");
+
 	if (gl_fw->test_config->init)
 		gl_fw->test_config->init(argc, argv);
 	if (gl_fw->test_config->display)
@@ -138,6 +145,7 @@ piglit_fbo_framework_create(const struct piglit_gl_test_config *test_config)
 	return NULL;
 #endif
 
+	create_time = piglit_time_get_nano();
 	platform = piglit_wfl_framework_choose_platform(test_config);
 
 	if (test_config->window_samples > 1) {
@@ -148,6 +156,11 @@ piglit_fbo_framework_create(const struct piglit_gl_test_config *test_config)
 	wfl_fw = calloc(1, sizeof(*wfl_fw));
 	gl_fw = &wfl_fw->gl_fw;
 
+#ifdef PIGLIT_HAS_WAFFLE_SURFACELESS_EGL
+	/* Everything is drawn to the FBO, so skip the window if we can. */
+	wfl_fw->surfaceless = platform == WAFFLE_PLATFORM_SURFACELESS_EGL;
+#endif
+
 	ok = piglit_wfl_framework_init(wfl_fw, test_config, platform, NULL);
 	if (!ok)
 		goto fail;
@@ -44,6 +44,13 @@ piglit_gl_framework_factory(const struct piglit_gl_test_config *test_config)
 #ifdef PIGLIT_USE_WAFFLE
 	struct piglit_gl_framework *gl_fw = NULL;
 
+#ifdef PIGLIT_HAS_WAFFLE_SURFACELESS_EGL
+	/* Without a window system there is nothing but the FBO to draw to. */
+	if (piglit_wfl_framework_choose_platform(test_config) ==
+	    WAFFLE_PLATFORM_SURFACELESS_EGL)
+		piglit_use_fbo = true;
+#endif
+
 	if (piglit_use_fbo) {
 		gl_fw = piglit_fbo_framework_create(test_config);
 	}
@@ -217,7 +217,9 @@ init_glut(void)
 	}
 #endif
 
+	piglit_trace_begin("glut init");
 	glutInit(&argc, argv);
+	piglit_trace_end();
 	glutInitWindowPosition(0, 0);
 	glutInitWindowSize(test_config->window_width,
 	                   test_config->window_height);
@@ -264,7 +266,9 @@ init_glut(void)
 	}
 #endif
 
+	piglit_trace_begin("context creation");
 	glut_fw.window = glutCreateWindow("Piglit");
+	piglit_trace_end();
 
 	glutDisplayFunc(display);
 	glutReshapeFunc(default_reshape_func);
@@ -21,7 +21,9 @@
  * IN THE SOFTWARE.
  */
 
+#include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "piglit-util-gl.h"
 #include "piglit-util-waffle.h"
@@ -34,6 +36,32 @@ enum context_flavor {
 	CONTEXT_GL_ES,
 };
 
+/**
+ * Outcome of a successful negotiation: the flavor that worked, the
+ * version the test config asked for in that flavor, and whether
+ * special_case_gl31() had to fall back to a 3.2 context.  The config
+ * attribute list is rebuilt from these by make_config_attrib_list().
+ *
+ * The driver strings identify the context that was negotiated.  A cached
+ * outcome is only used if a context created from it reports the same
+ * strings, otherwise the full negotiation is run again.
+ */
+struct context_cache_entry {
+	enum context_flavor flavor;
+	int version;
+	bool gl31_fallback;
+	char vendor[256];
+	char renderer[256];
+	char gl_version[256];
+};
+
+static struct {
+	bool initialized;
+	const char *dir;
+	/** Set by special_case_gl31() when the fallback succeeds. */
+	bool gl31_fallback;
+} context_cache;
+
 static bool
 make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
                                 const struct piglit_gl_test_config *test_config,
@@ -71,6 +99,15 @@ piglit_wfl_framework_choose_platform(const struct piglit_gl_test_config *test_co
 #endif
 	}
 
+	else if (streq(env, "surfaceless_egl")) {
+#if defined(PIGLIT_HAS_EGL) && defined(PIGLIT_HAS_WAFFLE_SURFACELESS_EGL)
+		return WAFFLE_PLATFORM_SURFACELESS_EGL;
+#else
+		fprintf(stderr, "environment var PIGLIT_PLATFORM=surfaceless_egl, "
+		        "but piglit was built without surfaceless EGL support\n");
+		piglit_report_result(PIGLIT_FAIL);
+#endif
+	}
 	else if (streq(env, "gbm")) {
 #ifdef PIGLIT_HAS_GBM
 		return WAFFLE_PLATFORM_GBM;
@@ -502,9 +539,27 @@ special_case_gl31(struct piglit_wfl_framework *wfl_fw,
 	wfl_fw->context = NULL;
 	wfl_fw->config = NULL;
 
-	return make_context_current_singlepass(
-			wfl_fw, &fallback_config, flavor,
-			partial_config_attrib_list);
+	if (!make_context_current_singlepass(wfl_fw, &fallback_config, flavor,
+					     partial_config_attrib_list))
+		return false;
+
+	context_cache.gl31_fallback = true;
+	return true;
+}
+
+static void
+destroy_context(struct piglit_wfl_framework *wfl_fw)
+{
+	waffle_make_current(wfl_fw->display, NULL, NULL);
+	waffle_window_destroy(wfl_fw->window);
+	waffle_context_destroy(wfl_fw->context);
+	waffle_config_destroy(wfl_fw->config);
+
+	wfl_fw->window = NULL;
+	wfl_fw->context = NULL;
+	wfl_fw->config = NULL;
+
+	piglit_gl_reinitialize_extensions();
 }
 
 static bool
@@ -543,13 +598,19 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 		goto fail;
 	}
 
-	wfl_fw->window = wfl_checked_window_create(wfl_fw->config,
-	                                           test_config->window_width,
-	                                           test_config->window_height);
-
-	wfl_checked_make_current(wfl_fw->display,
-	                         wfl_fw->window,
-	                         wfl_fw->context);
+	/* With EGL_KHR_surfaceless_context the context can be made current
+	 * without any surface.  Fall back to a window if the driver refuses.
+	 */
+	if (!wfl_fw->surfaceless ||
+	    !waffle_make_current(wfl_fw->display, NULL, wfl_fw->context)) {
+		wfl_fw->window = wfl_checked_window_create(wfl_fw->config,
+		                                           test_config->window_width,
+		                                           test_config->window_height);
+
+		wfl_checked_make_current(wfl_fw->display,
+		                         wfl_fw->window,
+		                         wfl_fw->context);
+	}
 
 #ifdef PIGLIT_USE_OPENGL
 	piglit_dispatch_default_init(PIGLIT_DISPATCH_GL);
@@ -573,24 +634,301 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 	return true;
 
 fail:
-	waffle_make_current(wfl_fw->display, NULL, NULL);
-	waffle_window_destroy(wfl_fw->window);
-	waffle_context_destroy(wfl_fw->context);
-	waffle_config_destroy(wfl_fw->config);
+	destroy_context(wfl_fw);
+	return false;
+}
 
-	wfl_fw->window = NULL;
-	wfl_fw->context = NULL;
-	wfl_fw->config = NULL;
+/*
+ * Context negotiation cache
+ *
+ * If PIGLIT_CONTEXT_CACHE names a directory, the outcome of
+ * make_context_current() is stored there, so that later tests with the
+ * same requirements go straight to the context that worked instead of
+ * repeating the failed attempts.
+ */
 
-	piglit_gl_reinitialize_extensions();
+static const char context_cache_magic[] = "piglit-context-cache 1";
 
-	return false;
+static const char *
+context_cache_dir(void)
+{
+	if (!context_cache.initialized) {
+		const char *env = getenv("PIGLIT_CONTEXT_CACHE");
+
+		context_cache.dir = (env != NULL && env[0] != '\0') ? env : NULL;
+		context_cache.initialized = true;
+	}
+
+	return context_cache.dir;
+}
+
+/* 64-bit FNV-1a, fed incrementally. */
+static uint64_t
+context_cache_hash(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= UINT64_C(0x100000001b3);
+	}
+
+	return hash;
+}
+
+static uint64_t
+context_cache_hash_int(uint64_t hash, int32_t value)
+{
+	return context_cache_hash(hash, &value, sizeof(value));
+}
+
+/*
+ * The key covers the platform, everything in the test config that
+ * make_config_attrib_list() looks at, the attributes chosen by the
+ * subclass, and the environment variables that commonly select a
+ * different driver or change what it accepts.  The driver itself is
+ * checked once a context exists, see context_cache_entry.
+ */
+static uint64_t
+context_cache_key(const struct piglit_wfl_framework *wfl_fw,
+		  const struct piglit_gl_test_config *test_config,
+		  const int32_t partial_config_attrib_list[])
+{
+	static const char *const env_vars[] = {
+		"DISPLAY",
+		"WAYLAND_DISPLAY",
+		"LIBGL_ALWAYS_SOFTWARE",
+		"GALLIUM_DRIVER",
+		"MESA_LOADER_DRIVER_OVERRIDE",
+		"MESA_GL_VERSION_OVERRIDE",
+		"MESA_GLES_VERSION_OVERRIDE",
+		"MESA_EXTENSION_OVERRIDE",
+	};
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+	int i;
+
+	hash = context_cache_hash_int(hash, wfl_fw->platform);
+	hash = context_cache_hash_int(hash, test_config->supports_gl_core_version);
+	hash = context_cache_hash_int(hash, test_config->supports_gl_compat_version);
+	hash = context_cache_hash_int(hash, test_config->supports_gl_es_version);
+	hash = context_cache_hash_int(hash, test_config->require_forward_compatible_context);
+	hash = context_cache_hash_int(hash, test_config->require_debug_context);
+	hash = context_cache_hash_int(hash, test_config->require_robust_context);
+
+	for (i = 0; partial_config_attrib_list[i] != 0; i += 2) {
+		hash = context_cache_hash_int(hash, partial_config_attrib_list[i]);
+		hash = context_cache_hash_int(hash, partial_config_attrib_list[i + 1]);
+	}
+	hash = context_cache_hash_int(hash, 0);
+
+	for (i = 0; i < ARRAY_SIZE(env_vars); i++) {
+		const char *value = getenv(env_vars[i]);
+
+		/* Include the terminator so that adjacent strings can't alias. */
+		if (value != NULL)
+			hash = context_cache_hash(hash, value, strlen(value) + 1);
+		else
+			hash = context_cache_hash(hash, "", 1);
+	}
+
+	return hash;
 }
 
 static void
-make_context_current(struct piglit_wfl_framework *wfl_fw,
-                     const struct piglit_gl_test_config *test_config,
-                     const int32_t partial_config_attrib_list[])
+context_cache_path(char *buf, size_t buf_size, uint64_t key)
+{
+	char name[32];
+
+	snprintf(name, sizeof(name), "%016"PRIx64".ctx", key);
+	piglit_join_paths(buf, buf_size, 2, context_cache.dir, name);
+}
+
+static bool
+context_cache_read_line(FILE *f, char *buf, size_t buf_size)
+{
+	size_t len;
+
+	if (fgets(buf, buf_size, f) == NULL)
+		return false;
+
+	len = strlen(buf);
+	if (len == 0 || buf[len - 1] != '\n')
+		return false;
+
+	buf[len - 1] = '\0';
+	return true;
+}
+
+/**
+ * Fill \a entry with the strings of the current context.
+ */
+static void
+context_cache_get_driver(struct context_cache_entry *entry)
+{
+	const char *vendor = (const char *) glGetString(GL_VENDOR);
+	const char *renderer = (const char *) glGetString(GL_RENDERER);
+	const char *version = (const char *) glGetString(GL_VERSION);
+
+	snprintf(entry->vendor, sizeof(entry->vendor), "%s",
+		 vendor ? vendor : "");
+	snprintf(entry->renderer, sizeof(entry->renderer), "%s",
+		 renderer ? renderer : "");
+	snprintf(entry->gl_version, sizeof(entry->gl_version), "%s",
+		 version ? version : "");
+}
+
+/*
+ * Cache file layout, one item per line: the magic string, the flavor,
+ * version and fallback flag separated by spaces, then GL_VENDOR,
+ * GL_RENDERER and GL_VERSION.
+ */
+static bool
+context_cache_load(uint64_t key, struct context_cache_entry *entry)
+{
+	char path[4096];
+	char line[512];
+	int flavor, version, gl31_fallback;
+	bool success = false;
+	FILE *f;
+
+	context_cache_path(path, sizeof(path), key);
+	f = fopen(path, "r");
+	if (f == NULL)
+		return false;
+
+	if (!context_cache_read_line(f, line, sizeof(line)) ||
+	    !streq(line, context_cache_magic))
+		goto out;
+
+	if (!context_cache_read_line(f, line, sizeof(line)) ||
+	    sscanf(line, "%d %d %d", &flavor, &version, &gl31_fallback) != 3 ||
+	    flavor < CONTEXT_GL_CORE || flavor > CONTEXT_GL_ES)
+		goto out;
+
+	entry->flavor = flavor;
+	entry->version = version;
+	entry->gl31_fallback = gl31_fallback;
+
+	/* The strings were truncated to fit when stored, so their lines,
+	 * which include the newline, fit in \c line.
+	 */
+	if (!context_cache_read_line(f, line, sizeof(line)))
+		goto out;
+	snprintf(entry->vendor, sizeof(entry->vendor), "%s", line);
+
+	if (!context_cache_read_line(f, line, sizeof(line)))
+		goto out;
+	snprintf(entry->renderer, sizeof(entry->renderer), "%s", line);
+
+	if (!context_cache_read_line(f, line, sizeof(line)))
+		goto out;
+	snprintf(entry->gl_version, sizeof(entry->gl_version), "%s", line);
+
+	success = true;
+
+out:
+	fclose(f);
+	return success;
+}
+
+static void
+context_cache_store(uint64_t key, const struct context_cache_entry *entry)
+{
+	char path[4096];
+	char tmp_path[4096];
+	bool success;
+	FILE *f;
+
+	/*
+	 * Write to a unique temporary file and rename it into place, so
+	 * that concurrent tests never see a partially written entry.
+	 */
+	context_cache_path(path, sizeof(path), key);
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%"PRIx64".tmp",
+		 path, (uint64_t) piglit_time_get_nano());
+
+	f = fopen(tmp_path, "w");
+	if (f == NULL)
+		return;
+
+	success = fprintf(f, "%s\n%d %d %d\n%s\n%s\n%s\n",
+			  context_cache_magic,
+			  entry->flavor, entry->version, entry->gl31_fallback,
+			  entry->vendor, entry->renderer,
+			  entry->gl_version) > 0;
+
+	if (fclose(f) != 0 || !success || rename(tmp_path, path) != 0)
+		remove(tmp_path);
+}
+
+static int
+context_flavor_version(const struct piglit_gl_test_config *test_config,
+		       enum context_flavor flavor)
+{
+	switch (flavor) {
+	case CONTEXT_GL_CORE:
+		return test_config->supports_gl_core_version;
+	case CONTEXT_GL_COMPAT:
+		return test_config->supports_gl_compat_version;
+	case CONTEXT_GL_ES:
+		return test_config->supports_gl_es_version;
+	}
+
+	assert(0);
+	return 0;
+}
+
+/**
+ * Create the context described by a cached \a entry, skipping the
+ * attempts that failed when it was negotiated.  Returns false, with no
+ * context current, if that fails or the driver has changed since.
+ */
+static bool
+make_context_current_cached(struct piglit_wfl_framework *wfl_fw,
+			    const struct piglit_gl_test_config *test_config,
+			    const struct context_cache_entry *entry,
+			    const int32_t partial_config_attrib_list[])
+{
+	struct piglit_gl_test_config cached_config = *test_config;
+	struct context_cache_entry current;
+
+	/* The entry must still agree with the test config. */
+	if (entry->version != context_flavor_version(test_config,
+						     entry->flavor))
+		return false;
+
+	if (entry->gl31_fallback) {
+		if (entry->flavor == CONTEXT_GL_CORE)
+			cached_config.supports_gl_core_version = 32;
+		else
+			cached_config.supports_gl_compat_version = 32;
+	}
+
+	if (!make_context_current_singlepass(wfl_fw, &cached_config,
+					     entry->flavor,
+					     partial_config_attrib_list))
+		return false;
+
+	context_cache_get_driver(&current);
+	if (streq(current.vendor, entry->vendor) &&
+	    streq(current.renderer, entry->renderer) &&
+	    streq(current.gl_version, entry->gl_version))
+		return true;
+
+	destroy_context(wfl_fw);
+	return false;
+}
+
+/**
+ * Try each context flavor supported by the test in turn.  On success,
+ * return true and set \a flavor to the one that worked.
+ */
+static bool
+negotiate_context(struct piglit_wfl_framework *wfl_fw,
+                  const struct piglit_gl_test_config *test_config,
+                  const int32_t partial_config_attrib_list[],
+                  enum context_flavor *flavor)
 {
 	bool ok = false;
 
@@ -602,7 +940,8 @@ make_context_current(struct piglit_wfl_framework *wfl_fw,
 		                                     partial_config_attrib_list);
 		if (ok) {
 			piglit_is_core_profile = true;
-			return;
+			*flavor = CONTEXT_GL_CORE;
+			return true;
 		}
 	}
 
@@ -619,8 +958,10 @@ make_context_current(struct piglit_wfl_framework *wfl_fw,
 		ok = make_context_current_singlepass(wfl_fw, test_config,
 		                                     CONTEXT_GL_COMPAT,
 		                                     partial_config_attrib_list);
-		if (ok)
-		   return;
+		if (ok) {
+			*flavor = CONTEXT_GL_COMPAT;
+			return true;
+		}
 	}
 
 #elif defined(PIGLIT_USE_OPENGL_ES1) || \
@@ -630,28 +971,77 @@ make_context_current(struct piglit_wfl_framework *wfl_fw,
 	                                     CONTEXT_GL_ES,
 	                                     partial_config_attrib_list);
 
-	if (ok)
-		return;
+	if (ok) {
+		*flavor = CONTEXT_GL_ES;
+		return true;
+	}
 #else
 #	error
 #endif
 
-	printf("piglit: info: Failed to create any GL context\n");
-	piglit_report_result(PIGLIT_SKIP);
+	return false;
 }
 
-
-bool
-piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
-                          const struct piglit_gl_test_config *test_config,
-                          int32_t platform,
-                          const int32_t partial_config_attrib_list[])
+static void
+make_context_current(struct piglit_wfl_framework *wfl_fw,
+                     const struct piglit_gl_test_config *test_config,
+                     const int32_t partial_config_attrib_list[])
 {
-	static bool is_waffle_initialized = false;
-	static int32_t initialized_platform = 0;
+	struct context_cache_entry entry;
+	const char *cache_status = NULL;
+	uint64_t key = 0;
+
+	if (context_cache_dir() != NULL) {
+		key = context_cache_key(wfl_fw, test_config,
+					partial_config_attrib_list);
+
+		if (!context_cache_load(key, &entry)) {
+			cache_status = "miss";
+		} else if (make_context_current_cached(wfl_fw, test_config,
+						       &entry,
+						       partial_config_attrib_list)) {
+			if (entry.flavor == CONTEXT_GL_CORE) {
+				piglit_is_core_profile = true;
+			} else if (entry.flavor == CONTEXT_GL_COMPAT &&
+				   test_config->supports_gl_core_version) {
+				printf("piglit: info: Falling back to GL %d.%d "
+				       "compatibility context\n",
+				       test_config->supports_gl_compat_version / 10,
+				       test_config->supports_gl_compat_version % 10);
+			}
 
-	bool ok = true;
+			piglit_logd("Context cache: hit for %016"PRIx64, key);
+			return;
+		} else {
+			cache_status = "stale";
+		}
+	}
+
+	if (!negotiate_context(wfl_fw, test_config,
+			       partial_config_attrib_list, &entry.flavor)) {
+		printf("piglit: info: Failed to create any GL context\n");
+		piglit_report_result(PIGLIT_SKIP);
+	}
 
+	if (cache_status != NULL) {
+		entry.version = context_flavor_version(test_config,
+						       entry.flavor);
+		entry.gl31_fallback = context_cache.gl31_fallback;
+		context_cache_get_driver(&entry);
+		context_cache_store(key, &entry);
+
+		piglit_logd("Context cache: %s for %016"PRIx64", stored",
+			    cache_status, key);
+	}
+}
+
+
+static bool is_waffle_initialized = false;
+static int32_t initialized_platform = 0;
+
+static void
+init_waffle(int32_t platform)
+{
 	if (is_waffle_initialized) {
 		assert(platform == initialized_platform);
 	} else {
@@ -660,18 +1050,49 @@ piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
 			0,
 		};
 
+		piglit_trace_begin("waffle init");
 		wfl_checked_init(attrib_list);
+		piglit_trace_end();
 		is_waffle_initialized = true;
 		initialized_platform = platform;
 	}
+}
+
+void
+piglit_wfl_framework_preinit(void)
+{
+	const char *env = getenv("PIGLIT_PLATFORM");
+	struct piglit_gl_test_config test_config;
+
+	if (env == NULL || streq(env, "mixed_glx_egl"))
+		return;
+
+	memset(&test_config, 0, sizeof(test_config));
+	init_waffle(piglit_wfl_framework_choose_platform(&test_config));
+}
+
+bool
+piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
+                          const struct piglit_gl_test_config *test_config,
+                          int32_t platform,
+                          const int32_t partial_config_attrib_list[])
+{
+	bool ok = true;
+
+	init_waffle(platform);
 
 	ok = piglit_gl_framework_init(&wfl_fw->gl_fw, test_config);
 	if (!ok)
 		goto fail;
 
 	wfl_fw->platform = platform;
+	piglit_trace_begin("display connect");
 	wfl_fw->display = wfl_checked_display_connect(NULL);
+	piglit_trace_end();
+
+	piglit_trace_begin("context creation");
 	make_context_current(wfl_fw, test_config, partial_config_attrib_list);
+	piglit_trace_end();
 
 	return true;
 
@@ -35,6 +35,13 @@ struct piglit_wfl_framework {
 	 */
 	int32_t platform;
 
+	/**
+	 * If set before piglit_wfl_framework_init(), try to make the
+	 * context current without creating a window.  Set by the FBO
+	 * framework on the surfaceless EGL platform.
+	 */
+	bool surfaceless;
+
 	struct waffle_display *display;
 	struct waffle_config *config;
 	struct waffle_context *context;
@@ -59,6 +66,15 @@ piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
 void
 piglit_wfl_framework_teardown(struct piglit_wfl_framework *wfl_fw);
 
+/**
+ * Initialize waffle ahead of piglit_wfl_framework_init(), for processes
+ * that fork before creating the framework.  Does nothing unless
+ * PIGLIT_PLATFORM names the platform, because the default platform can
+ * depend on the test config.
+ */
+void
+piglit_wfl_framework_preinit(void);
+
 /**
  * Used by subclasses to choose the waffle platform. Returns one of
  * WAFFLE_PLATFORM_*.
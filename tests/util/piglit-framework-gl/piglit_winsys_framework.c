@@ -183,6 +183,15 @@ piglit_winsys_framework_factory(const struct piglit_gl_test_config *test_config)
 		return piglit_wgl_framework_create(test_config);
 #endif
 
+#ifdef PIGLIT_HAS_WAFFLE_SURFACELESS_EGL
+	case WAFFLE_PLATFORM_SURFACELESS_EGL:
+		/* There are no windows, only the FBO framework works. */
+		printf("The surfaceless EGL platform only supports "
+		       "rendering to an FBO\n");
+		piglit_report_result(PIGLIT_SKIP);
+		return NULL;
+#endif
+
 	default:
 		assert(0);
 		return NULL;
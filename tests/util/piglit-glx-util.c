@@ -149,14 +149,35 @@ piglit_get_glx_window(Display *dpy, XVisualInfo *visinfo)
 	return _piglit_get_glx_window(dpy, visinfo, true, false);
 }
 
+/**
+ * The extension set of the display last queried.
+ *
+ * It is rebuilt only when the display or screen changes.  The string
+ * glXQueryExtensionsString() returned is not a key: it may be freed and
+ * its address reused.
+ */
+static struct {
+	Display *dpy;
+	int screen;
+	struct piglit_extension_set *set;
+} glx_extensions;
+
 bool
 piglit_is_glx_extension_supported(Display *dpy, const char *name)
 {
 	int screen = DefaultScreen(dpy);
-	const char *const glx_extension_list =
-		glXQueryExtensionsString(dpy, screen);
 
-	return piglit_is_extension_in_string(glx_extension_list, name);
+	if (glx_extensions.set == NULL ||
+	    glx_extensions.dpy != dpy ||
+	    glx_extensions.screen != screen) {
+		piglit_extension_set_destroy(glx_extensions.set);
+		glx_extensions.set = piglit_extension_set_from_string(
+			glXQueryExtensionsString(dpy, screen));
+		glx_extensions.dpy = dpy;
+		glx_extensions.screen = screen;
+	}
+
+	return piglit_extension_set_contains(glx_extensions.set, name);
 }
 
 void
@@ -38,16 +38,19 @@ struct piglit_log_opt_list {
  */
 static struct piglit_log_opt_list opts[PIGLIT_LOG_OPT_MAX + 1];
 
+/** Whether the environment is still to be read, see piglit_log_reset(). */
+static bool overrides_once = true;
+static bool debug_once = true;
+
 static void
 get_env_overrides(void)
 {
-	static bool once = true;
 	const char *env = NULL;
 
-	if (!once) {
+	if (!overrides_once) {
 		return;
 	}
-	once = false;
+	overrides_once = false;
 
 	env = getenv("PIGLIT_LOG_PRINT_TID");
 	if (env && !streq(env, "")) {
@@ -75,6 +78,22 @@ piglit_log_get_opt(enum piglit_log_opt opt)
 	return opts[opt].val;
 }
 
+void
+piglit_log_reset(void)
+{
+	int i;
+
+	for (i = 0; i <= PIGLIT_LOG_OPT_MAX; i++) {
+		if (opts[i].is_env_set) {
+			opts[i].val = 0;
+			opts[i].is_env_set = false;
+		}
+	}
+
+	overrides_once = true;
+	debug_once = true;
+}
+
 void
 piglit_log_set_opt(enum piglit_log_opt opt, intptr_t value) {
 	get_env_overrides();
@@ -119,14 +138,13 @@ piglit_logi(const char *fmt, ...)
 void
 piglit_logd(const char *fmt, ...)
 {
-	static bool once = true;
 	static bool debug = false;
 	va_list ap;
 
-	if (once) {
+	if (debug_once) {
 		const char *env;
 
-		once = false;
+		debug_once = false;
 		env = getenv("PIGLIT_DEBUG");
 
 		if (env == NULL
@@ -56,6 +56,13 @@ piglit_log_get_opt(enum piglit_log_opt);
 void
 piglit_log_set_opt(enum piglit_log_opt opt, intptr_t value);
 
+/**
+ * Forget the options and PIGLIT_DEBUG read from the environment, so that
+ * they are read again when next needed.
+ */
+void
+piglit_log_reset(void);
+
 /** Log an error.message. */
 void
 piglit_loge(const char *fmt, ...);
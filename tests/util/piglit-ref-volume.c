@@ -0,0 +1,399 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Reference volumes for tests that update sub-boxes of textures.
+ *
+ * Once a volume has made its copy of the initial data, the copy only
+ * differs from the initial data inside the bounding box of the updates
+ * made since the last reset.  Resetting restores that box alone, so each
+ * iteration of a test costs in proportion to the size of its update
+ * rather than to the size of the texture.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piglit-ref-volume.h"
+#include "piglit-util.h"
+
+struct piglit_ref_volume {
+	enum piglit_ref_volume_format format;
+	unsigned w, h, d;
+	size_t texel_size;
+	unsigned bits;
+	float tolerance;
+
+	const uint8_t *initial;
+
+	/** Copy of the initial data, allocated by the first update. */
+	uint8_t *copy;
+
+	/** Bounding box of the updates since the last reset. */
+	struct piglit_ref_volume_box dirty;
+};
+
+static size_t
+format_texel_size(enum piglit_ref_volume_format format)
+{
+	switch (format) {
+	case PIGLIT_REF_VOLUME_RGBA8:
+	case PIGLIT_REF_VOLUME_DEPTH:
+		return 4;
+	case PIGLIT_REF_VOLUME_RGBA_FLOAT:
+	case PIGLIT_REF_VOLUME_RGBA_INT:
+		return 16;
+	case PIGLIT_REF_VOLUME_STENCIL:
+		return 1;
+	}
+
+	assert(!"unknown reference volume format");
+	return 0;
+}
+
+static bool
+box_is_empty(const struct piglit_ref_volume_box *box)
+{
+	return box->w == 0 || box->h == 0 || box->d == 0;
+}
+
+static size_t
+texel_offset(const struct piglit_ref_volume *vol,
+	     unsigned x, unsigned y, unsigned z)
+{
+	return (((size_t) z * vol->h + y) * vol->w + x) * vol->texel_size;
+}
+
+/**
+ * Copy the rows of \c box from \c src to \c dst, both with the layout of
+ * the volume.
+ */
+static void
+copy_box(const struct piglit_ref_volume *vol, uint8_t *dst,
+	 const uint8_t *src, const struct piglit_ref_volume_box *box)
+{
+	size_t row_bytes = box->w * vol->texel_size;
+	unsigned y, z;
+
+	for (z = box->z; z < box->z + box->d; z++) {
+		for (y = box->y; y < box->y + box->h; y++) {
+			size_t offset = texel_offset(vol, box->x, y, z);
+
+			memcpy(dst + offset, src + offset, row_bytes);
+		}
+	}
+}
+
+struct piglit_ref_volume *
+piglit_ref_volume_create(enum piglit_ref_volume_format format,
+			 unsigned w, unsigned h, unsigned d,
+			 const void *initial)
+{
+	struct piglit_ref_volume *vol = calloc(1, sizeof(*vol));
+
+	vol->format = format;
+	vol->w = w;
+	vol->h = h;
+	vol->d = d;
+	vol->texel_size = format_texel_size(format);
+	vol->bits = 8;
+	vol->initial = initial;
+
+	return vol;
+}
+
+void
+piglit_ref_volume_destroy(struct piglit_ref_volume *vol)
+{
+	free(vol->copy);
+	free(vol);
+}
+
+void
+piglit_ref_volume_set_bits(struct piglit_ref_volume *vol, unsigned bits)
+{
+	assert(bits > 0 && bits <= 8);
+	vol->bits = bits;
+}
+
+void
+piglit_ref_volume_set_tolerance(struct piglit_ref_volume *vol,
+				float tolerance)
+{
+	vol->tolerance = tolerance;
+}
+
+void
+piglit_ref_volume_reset(struct piglit_ref_volume *vol)
+{
+	if (box_is_empty(&vol->dirty))
+		return;
+
+	copy_box(vol, vol->copy, vol->initial, &vol->dirty);
+	memset(&vol->dirty, 0, sizeof(vol->dirty));
+}
+
+void
+piglit_ref_volume_update(struct piglit_ref_volume *vol, const void *src,
+			 const struct piglit_ref_volume_box *box)
+{
+	struct piglit_ref_volume_box *dirty = &vol->dirty;
+
+	assert(box->x + box->w <= vol->w);
+	assert(box->y + box->h <= vol->h);
+	assert(box->z + box->d <= vol->d);
+
+	if (box_is_empty(box))
+		return;
+
+	if (vol->copy == NULL) {
+		size_t size = texel_offset(vol, 0, 0, vol->d);
+
+		vol->copy = malloc(size);
+		memcpy(vol->copy, vol->initial, size);
+	}
+
+	copy_box(vol, vol->copy, src, box);
+
+	if (box_is_empty(dirty)) {
+		*dirty = *box;
+	} else {
+		unsigned x1 = MAX2(dirty->x + dirty->w, box->x + box->w);
+		unsigned y1 = MAX2(dirty->y + dirty->h, box->y + box->h);
+		unsigned z1 = MAX2(dirty->z + dirty->d, box->z + box->d);
+
+		dirty->x = MIN2(dirty->x, box->x);
+		dirty->y = MIN2(dirty->y, box->y);
+		dirty->z = MIN2(dirty->z, box->z);
+		dirty->w = x1 - dirty->x;
+		dirty->h = y1 - dirty->y;
+		dirty->d = z1 - dirty->z;
+	}
+}
+
+const void *
+piglit_ref_volume_data(const struct piglit_ref_volume *vol)
+{
+	return box_is_empty(&vol->dirty) ? vol->initial : vol->copy;
+}
+
+/**
+ * Compare the bytes of two RGBA8 spans under a mask, eight bytes at a
+ * time.  Returns true if they match.
+ */
+static bool
+masked_span_equal(const uint8_t *a, const uint8_t *b, size_t n, uint8_t mask)
+{
+	const uint64_t mask64 = mask * UINT64_C(0x0101010101010101);
+	size_t i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		uint64_t wa, wb;
+
+		memcpy(&wa, a + i, 8);
+		memcpy(&wb, b + i, 8);
+		if ((wa ^ wb) & mask64)
+			return false;
+	}
+
+	for (; i < n; i++) {
+		if ((a[i] ^ b[i]) & mask)
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+float_span_equal(const float *a, const float *b, size_t n, float tolerance)
+{
+	bool equal = true;
+	size_t i;
+
+	/* No early exit so that the loop can be vectorized. */
+	for (i = 0; i < n; i++)
+		equal &= fabsf(a[i] - b[i]) <= tolerance;
+
+	return equal;
+}
+
+static bool
+span_equal(const struct piglit_ref_volume *vol, const uint8_t *expected,
+	   const uint8_t *observed, unsigned count)
+{
+	size_t bytes = count * vol->texel_size;
+
+	switch (vol->format) {
+	case PIGLIT_REF_VOLUME_RGBA8:
+		if (vol->bits < 8) {
+			return masked_span_equal(expected, observed, bytes,
+						 0xff << (8 - vol->bits));
+		}
+		/* fallthrough */
+	case PIGLIT_REF_VOLUME_RGBA_INT:
+	case PIGLIT_REF_VOLUME_STENCIL:
+		return memcmp(expected, observed, bytes) == 0;
+	case PIGLIT_REF_VOLUME_RGBA_FLOAT:
+	case PIGLIT_REF_VOLUME_DEPTH:
+		return float_span_equal((const float *) expected,
+					(const float *) observed,
+					bytes / sizeof(float),
+					vol->tolerance);
+	}
+
+	return false;
+}
+
+static void
+print_texel(const struct piglit_ref_volume *vol, const uint8_t *texel)
+{
+	const float *f = (const float *) texel;
+	const int32_t *i = (const int32_t *) texel;
+
+	switch (vol->format) {
+	case PIGLIT_REF_VOLUME_RGBA8:
+		printf("%u,%u,%u,%u", texel[0], texel[1], texel[2], texel[3]);
+		break;
+	case PIGLIT_REF_VOLUME_RGBA_FLOAT:
+		printf("%f,%f,%f,%f", f[0], f[1], f[2], f[3]);
+		break;
+	case PIGLIT_REF_VOLUME_RGBA_INT:
+		printf("%d,%d,%d,%d", i[0], i[1], i[2], i[3]);
+		break;
+	case PIGLIT_REF_VOLUME_DEPTH:
+		printf("%f", f[0]);
+		break;
+	case PIGLIT_REF_VOLUME_STENCIL:
+		printf("%u", texel[0]);
+		break;
+	}
+}
+
+/**
+ * Compare the \c count texels starting at \c x, \c y, \c z of
+ * \c observed and \c expected, both images with the layout of the volume,
+ * and print the first mismatch.
+ */
+static bool
+compare_span(const struct piglit_ref_volume *vol, const uint8_t *expected,
+	     const uint8_t *observed, unsigned x, unsigned y, unsigned z,
+	     unsigned count)
+{
+	size_t offset = texel_offset(vol, x, y, z);
+
+	expected += offset;
+	observed += offset;
+	if (span_equal(vol, expected, observed, count))
+		return true;
+
+	for (;; x++) {
+		if (!span_equal(vol, expected, observed, 1))
+			break;
+		expected += vol->texel_size;
+		observed += vol->texel_size;
+	}
+
+	printf("%u,%u,%u: test = ", x, y, z);
+	print_texel(vol, observed);
+	printf(" ref = ");
+	print_texel(vol, expected);
+	if (vol->format == PIGLIT_REF_VOLUME_RGBA8)
+		printf(" (comparing %u bits)", vol->bits);
+	printf("\n");
+	return false;
+}
+
+bool
+piglit_ref_volume_compare(const struct piglit_ref_volume *vol,
+			  const void *observed,
+			  const struct piglit_ref_volume_box *region)
+{
+	const struct piglit_ref_volume_box all = {
+		0, 0, 0, vol->w, vol->h, vol->d
+	};
+	const uint8_t *expected = piglit_ref_volume_data(vol);
+	unsigned y, z;
+
+	if (region == NULL)
+		region = &all;
+
+	assert(region->x + region->w <= vol->w);
+	assert(region->y + region->h <= vol->h);
+	assert(region->z + region->d <= vol->d);
+
+	for (z = region->z; z < region->z + region->d; z++) {
+		for (y = region->y; y < region->y + region->h; y++) {
+			if (!compare_span(vol, expected, observed,
+					  region->x, y, z, region->w))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool
+piglit_ref_volume_compare_update(const struct piglit_ref_volume *vol,
+				 const void *src,
+				 const struct piglit_ref_volume_box *box,
+				 const void *observed)
+{
+	const uint8_t *expected = piglit_ref_volume_data(vol);
+	const unsigned x1 = box->x + box->w;
+	unsigned y, z;
+
+	assert(x1 <= vol->w);
+	assert(box->y + box->h <= vol->h);
+	assert(box->z + box->d <= vol->d);
+
+	for (z = 0; z < vol->d; z++) {
+		for (y = 0; y < vol->h; y++) {
+			bool updated = !box_is_empty(box) &&
+				y >= box->y && y < box->y + box->h &&
+				z >= box->z && z < box->z + box->d;
+
+			if (!updated) {
+				if (!compare_span(vol, expected, observed,
+						  0, y, z, vol->w))
+					return false;
+				continue;
+			}
+
+			if (!compare_span(vol, expected, observed,
+					  0, y, z, box->x) ||
+			    !compare_span(vol, src, observed,
+					  box->x, y, z, box->w) ||
+			    !compare_span(vol, expected, observed,
+					  x1, y, z, vol->w - x1))
+				return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Reference volumes for tests that update sub-boxes of textures.
+ *
+ * A reference volume holds the expected contents of a w x h x d texture
+ * image.  It starts out sharing the caller's initial data and only makes
+ * its own copy when a box is first updated, and resetting it between
+ * iterations only restores the boxes that were updated.  Comparisons can
+ * be restricted to a region, and work on whole rows at a time instead of
+ * testing each texel.
+ */
+
+#ifndef PIGLIT_REF_VOLUME_H
+#define PIGLIT_REF_VOLUME_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum piglit_ref_volume_format {
+	/** Four unsigned bytes, compared on their highest bits. */
+	PIGLIT_REF_VOLUME_RGBA8,
+	/** Four floats, compared with a tolerance. */
+	PIGLIT_REF_VOLUME_RGBA_FLOAT,
+	/** Four 32-bit integers, compared exactly. */
+	PIGLIT_REF_VOLUME_RGBA_INT,
+	/** One float, compared with a tolerance. */
+	PIGLIT_REF_VOLUME_DEPTH,
+	/** One unsigned byte, compared exactly. */
+	PIGLIT_REF_VOLUME_STENCIL,
+};
+
+struct piglit_ref_volume_box {
+	unsigned x, y, z;
+	unsigned w, h, d;
+};
+
+struct piglit_ref_volume;
+
+/**
+ * Create a reference volume whose contents are \c initial, a tightly
+ * packed image of \c w * \c h * \c d texels.
+ *
+ * \c initial is not copied and must stay valid as long as the volume is
+ * used.
+ */
+struct piglit_ref_volume *
+piglit_ref_volume_create(enum piglit_ref_volume_format format,
+			 unsigned w, unsigned h, unsigned d,
+			 const void *initial);
+
+void
+piglit_ref_volume_destroy(struct piglit_ref_volume *vol);
+
+/**
+ * Only compare the highest \c bits bits of each RGBA8 channel.  The
+ * default is 8.
+ */
+void
+piglit_ref_volume_set_bits(struct piglit_ref_volume *vol, unsigned bits);
+
+/**
+ * Set the largest accepted difference for the float and depth formats.
+ * The default is 0.
+ */
+void
+piglit_ref_volume_set_tolerance(struct piglit_ref_volume *vol,
+				float tolerance);
+
+/**
+ * Return to the initial contents.
+ */
+void
+piglit_ref_volume_reset(struct piglit_ref_volume *vol);
+
+/**
+ * Replace the texels of \c box with those of \c src, an image with the
+ * same size and layout as the volume.
+ */
+void
+piglit_ref_volume_update(struct piglit_ref_volume *vol, const void *src,
+			 const struct piglit_ref_volume_box *box);
+
+/**
+ * Current contents of the volume.
+ */
+const void *
+piglit_ref_volume_data(const struct piglit_ref_volume *vol);
+
+/**
+ * Compare \c observed, an image with the same size and layout as the
+ * volume, with the volume inside \c region, or everywhere if \c region
+ * is NULL.  The first mismatch is printed.
+ */
+bool
+piglit_ref_volume_compare(const struct piglit_ref_volume *vol,
+			  const void *observed,
+			  const struct piglit_ref_volume_box *region);
+
+/**
+ * Compare \c observed with what the volume would hold after
+ * piglit_ref_volume_update(vol, src, box), without changing or copying
+ * it.  The first mismatch is printed.
+ */
+bool
+piglit_ref_volume_compare_update(const struct piglit_ref_volume *vol,
+				 const void *src,
+				 const struct piglit_ref_volume_box *box,
+				 const void *observed);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
+
+#endif /* PIGLIT_REF_VOLUME_H */
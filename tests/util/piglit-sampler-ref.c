@@ -0,0 +1,356 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Software reference for texture sampling.
+ *
+ * Sampling is split per axis: each coordinate is clamped and wrapped into
+ * at most two taps (texel index and weight), following the texture
+ * wrap-mode and filtering rules of the GL spec, and the taps of all axes
+ * are then combined.  Since the taps of an axis only depend on the
+ * coordinate of that axis, a grid only computes them once per row and
+ * once per column.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piglit-sampler-ref.h"
+#include "piglit-util-gl.h"
+
+/** Tap index meaning "use the border color". */
+#define TAP_BORDER -1
+
+struct taps {
+	unsigned count;
+	int index[2];
+	float weight[2];
+};
+
+static unsigned
+target_dimensions(GLenum target)
+{
+	switch (target) {
+	case GL_TEXTURE_1D:
+		return 1;
+	case GL_TEXTURE_3D:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+static int
+axis_size(const struct piglit_sampler_ref *sampler, unsigned axis)
+{
+	return axis == 0 ? sampler->width :
+	       axis == 1 ? sampler->height : sampler->depth;
+}
+
+static bool
+is_linear(const struct piglit_sampler_ref *sampler)
+{
+	return sampler->filter == GL_LINEAR &&
+	       sampler->type == PIGLIT_SAMPLER_REF_FLOAT;
+}
+
+/**
+ * Apply the coordinate clamping of \c wrap, in texel units.
+ */
+static double
+clamp_coord(GLenum wrap, int size, double u)
+{
+	switch (wrap) {
+	case GL_MIRROR_CLAMP_EXT:
+		u = fabs(u);
+		/* Fall through. */
+	case GL_CLAMP:
+		return CLAMP(u, 0.0, (double) size);
+
+	case GL_MIRROR_CLAMP_TO_EDGE_EXT:
+		u = fabs(u);
+		/* Fall through. */
+	case GL_CLAMP_TO_EDGE:
+		return CLAMP(u, 0.5, size - 0.5);
+
+	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
+		u = fabs(u);
+		/* Fall through. */
+	case GL_CLAMP_TO_BORDER:
+		return CLAMP(u, -0.5, size + 0.5);
+
+	default:
+		return u;
+	}
+}
+
+/**
+ * Map the integer texel index \c i into the texture, or to TAP_BORDER.
+ */
+static int
+wrap_index(GLenum wrap, bool linear, int size, int i)
+{
+	switch (wrap) {
+	case GL_REPEAT:
+		i %= size;
+		return i < 0 ? i + size : i;
+
+	case GL_MIRRORED_REPEAT:
+		i %= 2 * size;
+		if (i < 0)
+			i += 2 * size;
+		return i >= size ? 2 * size - 1 - i : i;
+
+	case GL_CLAMP:
+	case GL_MIRROR_CLAMP_EXT:
+		/* Only linear filtering reaches the border with these. */
+		if (!linear)
+			return CLAMP(i, 0, size - 1);
+		/* Fall through. */
+	case GL_CLAMP_TO_BORDER:
+	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
+		return i < 0 || i >= size ? TAP_BORDER : i;
+
+	default:
+		return CLAMP(i, 0, size - 1);
+	}
+}
+
+static void
+compute_taps(GLenum wrap, bool linear, int size, double u, struct taps *taps)
+{
+	u = clamp_coord(wrap, size, u);
+
+	if (linear) {
+		double base = floor(u - 0.5);
+		float alpha = (u - 0.5) - base;
+
+		/* Skip taps without any weight, which also keeps texel
+		 * centers from touching their neighbours at all.
+		 */
+		taps->count = 0;
+		if (alpha != 1.0f) {
+			taps->index[taps->count] =
+				wrap_index(wrap, true, size, (int) base);
+			taps->weight[taps->count] = 1.0f - alpha;
+			taps->count++;
+		}
+		if (alpha != 0.0f) {
+			taps->index[taps->count] =
+				wrap_index(wrap, true, size, (int) base + 1);
+			taps->weight[taps->count] = alpha;
+			taps->count++;
+		}
+	} else {
+		taps->count = 1;
+		taps->index[0] = wrap_index(wrap, false, size,
+					    (int) floor(u));
+		taps->weight[0] = 1.0f;
+	}
+}
+
+static void
+compute_axis_taps(const struct piglit_sampler_ref *sampler, unsigned axis,
+		  double u, struct taps *taps)
+{
+	if (axis >= target_dimensions(sampler->target)) {
+		taps->count = 1;
+		taps->index[0] = 0;
+		taps->weight[0] = 1.0f;
+		return;
+	}
+
+	compute_taps(sampler->wrap[axis], is_linear(sampler),
+		     axis_size(sampler, axis), u, taps);
+}
+
+static void
+fetch_texel(const struct piglit_sampler_ref *sampler, int x, int y, int z,
+	    union piglit_sampler_ref_value *texel)
+{
+	const uint32_t *words = sampler->texels;
+	unsigned offset = (z * sampler->height + y) * sampler->width + x;
+	unsigned i;
+
+	switch (sampler->base_format) {
+	case GL_DEPTH_COMPONENT:
+		texel->u[0] = texel->u[1] = texel->u[2] = words[offset];
+		texel->f[3] = 1.0f;
+		return;
+	case GL_STENCIL_INDEX:
+		texel->u[0] = texel->u[1] = texel->u[2] = texel->u[3] =
+			words[offset];
+		return;
+	default:
+		memcpy(texel->u, &words[offset * 4], sizeof(texel->u));
+		break;
+	}
+
+	if (sampler->srgb && sampler->type == PIGLIT_SAMPLER_REF_FLOAT) {
+		for (i = 0; i < 3; i++)
+			texel->f[i] = piglit_srgb_to_linear(texel->f[i]);
+	}
+}
+
+/**
+ * Combine the taps of the three axes and apply the swizzle.
+ */
+static void
+sample_taps(const struct piglit_sampler_ref *sampler,
+	    const struct taps *s, const struct taps *t, const struct taps *r,
+	    union piglit_sampler_ref_value *result)
+{
+	union piglit_sampler_ref_value texel;
+	unsigned i, j, k, c;
+
+	if (!is_linear(sampler)) {
+		if (s->index[0] == TAP_BORDER || t->index[0] == TAP_BORDER ||
+		    r->index[0] == TAP_BORDER)
+			*result = sampler->border;
+		else
+			fetch_texel(sampler, s->index[0], t->index[0],
+				    r->index[0], result);
+	} else {
+		memset(result, 0, sizeof(*result));
+		for (k = 0; k < r->count; k++) {
+			for (j = 0; j < t->count; j++) {
+				for (i = 0; i < s->count; i++) {
+					const union piglit_sampler_ref_value *v;
+					float w = s->weight[i] * t->weight[j] *
+						  r->weight[k];
+
+					if (s->index[i] == TAP_BORDER ||
+					    t->index[j] == TAP_BORDER ||
+					    r->index[k] == TAP_BORDER) {
+						v = &sampler->border;
+					} else {
+						fetch_texel(sampler,
+							    s->index[i],
+							    t->index[j],
+							    r->index[k],
+							    &texel);
+						v = &texel;
+					}
+
+					for (c = 0; c < 4; c++)
+						result->f[c] += w * v->f[c];
+				}
+			}
+		}
+	}
+
+	if (sampler->swizzle) {
+		union piglit_sampler_ref_value orig = *result;
+
+		for (c = 0; c < 4; c++)
+			result->u[c] = orig.u[sampler->swizzle[c]];
+	}
+}
+
+void
+piglit_sampler_ref_sample(const struct piglit_sampler_ref *sampler,
+			  const double coord[3],
+			  union piglit_sampler_ref_value *result)
+{
+	struct taps taps[3];
+	unsigned i;
+
+	for (i = 0; i < 3; i++)
+		compute_axis_taps(sampler, i, coord[i], &taps[i]);
+
+	sample_taps(sampler, &taps[0], &taps[1], &taps[2], result);
+}
+
+void
+piglit_sampler_ref_to_ubyte(const struct piglit_sampler_ref *sampler,
+			    const union piglit_sampler_ref_value *value,
+			    unsigned char ubyte[4])
+{
+	unsigned i;
+
+	switch (sampler->type) {
+	case PIGLIT_SAMPLER_REF_FLOAT:
+		for (i = 0; i < 4; i++)
+			ubyte[i] = value->f[i] * sampler->ubyte_scale[i];
+		break;
+	case PIGLIT_SAMPLER_REF_INT:
+		for (i = 0; i < 4; i++)
+			ubyte[i] = value->i[i] * sampler->ubyte_scale[i];
+		break;
+	case PIGLIT_SAMPLER_REF_UINT:
+		for (i = 0; i < 4; i++)
+			ubyte[i] = value->u[i] * sampler->ubyte_scale[i];
+		break;
+	}
+}
+
+void
+piglit_sampler_ref_fill_grid(const struct piglit_sampler_ref_grid *grid)
+{
+	const struct piglit_sampler_ref *sampler = grid->sampler;
+	struct taps *columns = malloc(grid->width * sizeof(*columns));
+	struct taps row, layer;
+	union piglit_sampler_ref_value value;
+	unsigned x, y;
+
+	for (x = 0; x < grid->width; x++)
+		compute_axis_taps(sampler, 0,
+				  grid->origin[0] + x * grid->step[0],
+				  &columns[x]);
+	compute_axis_taps(sampler, 2, grid->origin[2], &layer);
+
+	for (y = 0; y < grid->height; y++) {
+		unsigned char *dst = grid->dst + y * grid->dst_stride * 4;
+
+		compute_axis_taps(sampler, 1,
+				  grid->origin[1] + y * grid->step[1], &row);
+
+		for (x = 0; x < grid->width; x++) {
+			sample_taps(sampler, &columns[x], &row, &layer,
+				    &value);
+			piglit_sampler_ref_to_ubyte(sampler, &value,
+						    &dst[x * 4]);
+		}
+	}
+
+	free(columns);
+}
+
+static void
+fill_grid(void *data, unsigned i)
+{
+	const struct piglit_sampler_ref_grid *grids = data;
+
+	piglit_sampler_ref_fill_grid(&grids[i]);
+}
+
+void
+piglit_sampler_ref_fill_grids(const struct piglit_sampler_ref_grid *grids,
+			      unsigned count)
+{
+	piglit_parallel_for(count, "PIGLIT_SAMPLER_REF_THREADS", fill_grid,
+			    (void *) grids);
+}
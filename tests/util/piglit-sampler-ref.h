@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Software reference for texture sampling.
+ *
+ * This computes the colors the GL should return when sampling a texture
+ * with a given wrap mode, filter, border color and swizzle, so tests can
+ * build their expected images on the CPU.  Coordinates are given in texel
+ * units, i.e. (i + 0.5) is the center of texel i, and the texture is an
+ * array of 32-bit words: floats for float formats, and the raw integer
+ * values for integer formats.
+ *
+ * Whole grids of samples are generated at once.  Wrapping is computed
+ * once per row and column instead of once per sample, and several grids
+ * can be generated in parallel.
+ */
+
+#ifndef PIGLIT_SAMPLER_REF_H
+#define PIGLIT_SAMPLER_REF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <piglit/gl_wrap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum piglit_sampler_ref_type {
+	PIGLIT_SAMPLER_REF_FLOAT,
+	PIGLIT_SAMPLER_REF_INT,
+	PIGLIT_SAMPLER_REF_UINT,
+};
+
+/**
+ * A sampled RGBA value.  Which member is valid depends on the type of
+ * the texture.
+ */
+union piglit_sampler_ref_value {
+	float f[4];
+	int32_t i[4];
+	uint32_t u[4];
+};
+
+struct piglit_sampler_ref {
+	/** GL_TEXTURE_1D, 2D, 3D or RECTANGLE. */
+	GLenum target;
+
+	/**
+	 * Texel data, four words per texel for GL_RGBA and one word for
+	 * GL_DEPTH_COMPONENT and GL_STENCIL_INDEX.
+	 */
+	const void *texels;
+	GLenum base_format;
+	enum piglit_sampler_ref_type type;
+	int width, height, depth;
+
+	/** Decode red, green and blue from sRGB before filtering. */
+	bool srgb;
+
+	/** Wrap modes for s, t and r. */
+	GLenum wrap[3];
+
+	/**
+	 * GL_NEAREST or GL_LINEAR.  Integer textures are always sampled
+	 * with GL_NEAREST.
+	 */
+	GLenum filter;
+
+	union piglit_sampler_ref_value border;
+
+	/** Source component for each channel, or NULL for no swizzle. */
+	const unsigned *swizzle;
+
+	/**
+	 * Factor each channel is multiplied by when converting to
+	 * unsigned bytes, e.g. 255 for float textures.
+	 */
+	double ubyte_scale[4];
+};
+
+/**
+ * A rectangle of samples.  Sample (x, y) is taken at
+ * origin + (x * step[0], y * step[1], 0) and stored as RGBA bytes at
+ * dst[(y * dst_stride + x) * 4].
+ */
+struct piglit_sampler_ref_grid {
+	const struct piglit_sampler_ref *sampler;
+	double origin[3];
+	double step[2];
+	unsigned width, height;
+	unsigned char *dst;
+	unsigned dst_stride;
+};
+
+/**
+ * Sample \c sampler at \c coord, in texel units.
+ */
+void
+piglit_sampler_ref_sample(const struct piglit_sampler_ref *sampler,
+			  const double coord[3],
+			  union piglit_sampler_ref_value *result);
+
+/**
+ * Convert a value returned by piglit_sampler_ref_sample() to bytes.
+ */
+void
+piglit_sampler_ref_to_ubyte(const struct piglit_sampler_ref *sampler,
+			    const union piglit_sampler_ref_value *value,
+			    unsigned char ubyte[4]);
+
+/**
+ * Fill one grid of samples.
+ */
+void
+piglit_sampler_ref_fill_grid(const struct piglit_sampler_ref_grid *grid);
+
+/**
+ * Fill \c count grids, spreading them over several threads when possible.
+ *
+ * The number of threads defaults to the number of online CPUs and can be
+ * set with the PIGLIT_SAMPLER_REF_THREADS environment variable.
+ */
+void
+piglit_sampler_ref_fill_grids(const struct piglit_sampler_ref_grid *grids,
+			      unsigned count);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
+
+#endif /* PIGLIT_SAMPLER_REF_H */
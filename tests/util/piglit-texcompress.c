@@ -0,0 +1,2297 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Software codec for block-compressed texture formats.
+ *
+ * The decoders follow the specifications of the formats: S3TC and RGTC
+ * interpolate in real numbers, while BPTC and ETC2/EAC define their
+ * results with integer arithmetic.  5- and 6-bit S3TC endpoints are
+ * expanded to 8 bits by replicating their high bits.
+ *
+ * Each encoder uses one mode of its format.  S3TC, RGTC and BPTC use the
+ * bounding box of the block as endpoints, ETC2 searches the modifier
+ * tables of the differential and individual modes, and EAC the tables and
+ * a few multipliers around the range of the block.  Every texel then gets
+ * the index of the closest value the decoder can produce.
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piglit-texcompress.h"
+#include "piglit-util-gl.h"
+
+#define BLOCK_SIZE PIGLIT_TEXCOMPRESS_BLOCK_SIZE
+#define BLOCK_TEXELS (BLOCK_SIZE * BLOCK_SIZE)
+#define BPTC_BLOCK_BYTES 16
+
+enum codec {
+	CODEC_NONE,
+	CODEC_DXT1_RGB,
+	CODEC_DXT1_RGBA,
+	CODEC_DXT3,
+	CODEC_DXT5,
+	CODEC_RGTC1,
+	CODEC_RGTC1_SIGNED,
+	CODEC_RGTC2,
+	CODEC_RGTC2_SIGNED,
+	CODEC_BPTC_UNORM,
+	CODEC_BPTC_FLOAT,
+	CODEC_BPTC_SIGNED_FLOAT,
+	CODEC_ETC2_RGB,
+	CODEC_ETC2_PUNCHTHROUGH,
+	CODEC_ETC2_EAC,
+	CODEC_EAC_R11,
+	CODEC_EAC_R11_SIGNED,
+	CODEC_EAC_RG11,
+	CODEC_EAC_RG11_SIGNED,
+};
+
+struct bptc_mode {
+	int n_subsets;
+	int n_partition_bits;
+	bool has_rotation_bits;
+	bool has_index_selection_bit;
+	int n_color_bits;
+	int n_alpha_bits;
+	bool has_endpoint_pbits;
+	bool has_shared_pbits;
+	int n_index_bits;
+	int n_secondary_index_bits;
+};
+
+static const struct bptc_mode
+bptc_modes[] = {
+	/* 0 */ { 3, 4, false, false, 4, 0, true,  false, 3, 0 },
+	/* 1 */ { 2, 6, false, false, 6, 0, false, true,  3, 0 },
+	/* 2 */ { 3, 6, false, false, 5, 0, false, false, 2, 0 },
+	/* 3 */ { 2, 6, false, false, 7, 0, true,  false, 2, 0 },
+	/* 4 */ { 1, 0, true,  true,  5, 6, false, false, 2, 3 },
+	/* 5 */ { 1, 0, true,  false, 7, 8, false, false, 2, 2 },
+	/* 6 */ { 1, 0, false, false, 7, 7, true,  false, 4, 0 },
+	/* 7 */ { 2, 6, false, false, 5, 5, true,  false, 2, 0 }
+};
+
+struct bptc_float_bitfield {
+	int8_t endpoint;
+	uint8_t component;
+	uint8_t offset;
+	uint8_t n_bits;
+	bool reverse;
+};
+
+/**
+ * A BPTC float mode.  Reserved modes have no endpoint bits.
+ */
+struct bptc_float_mode {
+	int n_partition_bits;
+	int n_index_bits;
+	int n_endpoint_bits;
+	bool transformed_endpoints;
+	int n_delta_bits[3];
+	struct bptc_float_bitfield bitfields[24];
+};
+
+static const struct bptc_float_mode
+bptc_float_modes[] = {
+	/* 00 */
+	{ 5, 3, 10, true, { 5, 5, 5 },
+	  { { 2, 1, 4, 1, false }, { 2, 2, 4, 1, false }, { 3, 2, 4, 1, false },
+	    { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 5, false }, { 3, 1, 4, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 5, false }, { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 5, false }, { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 5, false }, { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false },
+	    { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 01 */
+	{ 5, 3, 7, true, { 6, 6, 6 },
+	  { { 2, 1, 5, 1, false }, { 3, 1, 4, 1, false }, { 3, 1, 5, 1, false },
+	    { 0, 0, 0, 7, false }, { 3, 2, 0, 1, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 4, 1, false }, { 0, 1, 0, 7, false }, { 2, 2, 5, 1, false },
+	    { 3, 2, 2, 1, false }, { 2, 1, 4, 1, false }, { 0, 2, 0, 7, false },
+	    { 3, 2, 3, 1, false }, { 3, 2, 5, 1, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 6, false }, { 2, 1, 0, 4, false }, { 1, 1, 0, 6, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 6, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 6, false },
+	    { 3, 0, 0, 6, false },
+	    { -1 } }
+	},
+	/* 00010 */
+	{ 5, 3, 11, true, { 5, 4, 4 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 5, false }, { 0, 0, 10, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 4, false }, { 0, 1, 10, 1, false }, { 3, 2, 0, 1, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 4, false }, { 0, 2, 10, 1, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false }, { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 00011 */
+	{ 0, 4, 10, false, { 10, 10, 10 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 10, false }, { 1, 1, 0, 10, false }, { 1, 2, 0, 10, false },
+	    { -1 } }
+	},
+	/* 00110 */
+	{ 5, 3, 11, true, { 4, 5, 4 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 4, false }, { 0, 0, 10, 1, false }, { 3, 1, 4, 1, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 5, false }, { 0, 1, 10, 1, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 4, false }, { 0, 2, 10, 1, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false }, { 2, 0, 0, 4, false },
+	    { 3, 2, 0, 1, false }, { 3, 2, 2, 1, false }, { 3, 0, 0, 4, false },
+	    { 2, 1, 4, 1, false }, { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 00111 */
+	{ 0, 4, 11, true, { 9, 9, 9 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 9, false }, { 0, 0, 10, 1, false }, { 1, 1, 0, 9, false },
+	    { 0, 1, 10, 1, false }, { 1, 2, 0, 9, false }, { 0, 2, 10, 1, false },
+	    { -1 } }
+	},
+	/* 01010 */
+	{ 5, 3, 11, true, { 4, 4, 5 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 4, false }, { 0, 0, 10, 1, false }, { 2, 2, 4, 1, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 4, false }, { 0, 1, 10, 1, false },
+	    { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false }, { 1, 2, 0, 5, false },
+	    { 0, 2, 10, 1, false }, { 2, 2, 0, 4, false }, { 2, 0, 0, 4, false },
+	    { 3, 2, 1, 1, false }, { 3, 2, 2, 1, false }, { 3, 0, 0, 4, false },
+	    { 3, 2, 4, 1, false }, { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 01011 */
+	{ 0, 4, 12, true, { 8, 8, 8 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 8, false }, { 0, 0, 10, 2, true }, { 1, 1, 0, 8, false },
+	    { 0, 1, 10, 2, true }, { 1, 2, 0, 8, false }, { 0, 2, 10, 2, true },
+	    { -1 } }
+	},
+	/* 01110 */
+	{ 5, 3, 9, true, { 5, 5, 5 },
+	  { { 0, 0, 0, 9, false }, { 2, 2, 4, 1, false }, { 0, 1, 0, 9, false },
+	    { 2, 1, 4, 1, false }, { 0, 2, 0, 9, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 5, false }, { 3, 1, 4, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 5, false }, { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 5, false }, { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 5, false }, { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false },
+	    { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 01111 */
+	{ 0, 4, 16, true, { 4, 4, 4 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 4, false }, { 0, 0, 10, 6, true }, { 1, 1, 0, 4, false },
+	    { 0, 1, 10, 6, true }, { 1, 2, 0, 4, false }, { 0, 2, 10, 6, true },
+	    { -1 } }
+	},
+	/* 10010 */
+	{ 5, 3, 8, true, { 6, 5, 5 },
+	  { { 0, 0, 0, 8, false }, { 3, 1, 4, 1, false }, { 2, 2, 4, 1, false },
+	    { 0, 1, 0, 8, false }, { 3, 2, 2, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 8, false }, { 3, 2, 3, 1, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 6, false }, { 2, 1, 0, 4, false }, { 1, 1, 0, 5, false },
+	    { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false }, { 1, 2, 0, 5, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false }, { 2, 0, 0, 6, false },
+	    { 3, 0, 0, 6, false },
+	    { -1 } }
+	},
+	/* 10011 */
+	{ 0 /* reserved */ },
+	/* 10110 */
+	{ 5, 3, 8, true, { 5, 6, 5 },
+	  { { 0, 0, 0, 8, false }, { 3, 2, 0, 1, false }, { 2, 2, 4, 1, false },
+	    { 0, 1, 0, 8, false }, { 2, 1, 5, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 8, false }, { 3, 1, 5, 1, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 5, false }, { 3, 1, 4, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 6, false }, { 3, 1, 0, 4, false }, { 1, 2, 0, 5, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false }, { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 10111 */
+	{ 0 /* reserved */ },
+	/* 11010 */
+	{ 5, 3, 8, true, { 5, 5, 6 },
+	  { { 0, 0, 0, 8, false }, { 3, 2, 1, 1, false }, { 2, 2, 4, 1, false },
+	    { 0, 1, 0, 8, false }, { 2, 2, 5, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 8, false }, { 3, 2, 5, 1, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 5, false }, { 3, 1, 4, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 5, false }, { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 6, false }, { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false }, { 3, 2, 3, 1, false },
+	    { -1 } }
+	},
+	/* 11011 */
+	{ 0 /* reserved */ },
+	/* 11110 */
+	{ 5, 3, 6, false, { 6, 6, 6 },
+	  { { 0, 0, 0, 6, false }, { 3, 1, 4, 1, false }, { 3, 2, 0, 1, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 4, 1, false }, { 0, 1, 0, 6, false },
+	    { 2, 1, 5, 1, false }, { 2, 2, 5, 1, false }, { 3, 2, 2, 1, false },
+	    { 2, 1, 4, 1, false }, { 0, 2, 0, 6, false }, { 3, 1, 5, 1, false },
+	    { 3, 2, 3, 1, false }, { 3, 2, 5, 1, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 6, false }, { 2, 1, 0, 4, false }, { 1, 1, 0, 6, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 6, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 6, false }, { 3, 0, 0, 6, false },
+	    { -1 } }
+	},
+	/* 11111 */
+	{ 0 /* reserved */ },
+};
+
+static const uint8_t
+anchor_indices[][64] = {
+	/* Anchor index values for the second subset of two-subset partitioning */
+	{
+		0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,
+		0xf,0x2,0x8,0x2,0x2,0x8,0x8,0xf,0x2,0x8,0x2,0x2,0x8,0x8,0x2,0x2,
+		0xf,0xf,0x6,0x8,0x2,0x8,0xf,0xf,0x2,0x8,0x2,0x2,0x2,0xf,0xf,0x6,
+		0x6,0x2,0x6,0x8,0xf,0xf,0x2,0x2,0xf,0xf,0xf,0xf,0xf,0x2,0x2,0xf
+	},
+
+	/* Anchor index values for the second subset of three-subset partitioning */
+	{
+		0x3,0x3,0xf,0xf,0x8,0x3,0xf,0xf,0x8,0x8,0x6,0x6,0x6,0x5,0x3,0x3,
+		0x3,0x3,0x8,0xf,0x3,0x3,0x6,0xa,0x5,0x8,0x8,0x6,0x8,0x5,0xf,0xf,
+		0x8,0xf,0x3,0x5,0x6,0xa,0x8,0xf,0xf,0x3,0xf,0x5,0xf,0xf,0xf,0xf,
+		0x3,0xf,0x5,0x5,0x5,0x8,0x5,0xa,0x5,0xa,0x8,0xd,0xf,0xc,0x3,0x3
+	},
+
+	/* Anchor index values for the third subset of three-subset
+	 * partitioning
+	 */
+	{
+		0xf,0x8,0x8,0x3,0xf,0xf,0x3,0x8,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0x8,
+		0xf,0x8,0xf,0x3,0xf,0x8,0xf,0x8,0x3,0xf,0x6,0xa,0xf,0xf,0xa,0x8,
+		0xf,0x3,0xf,0xa,0xa,0x8,0x9,0xa,0x6,0xf,0x8,0xf,0x3,0x6,0x6,0x8,
+		0xf,0x3,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0xf,0x3,0xf,0xf,0x8
+	}
+};
+
+/** Subset of each texel for the 64 two-subset partitions, one bit each. */
+static const uint16_t
+partition_table1[64] = {
+	0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+	0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+	0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+	0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+	0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+	0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+	0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+	0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+};
+
+/** Subset of each texel for the 64 three-subset partitions, two bits each. */
+static const uint32_t
+partition_table2[64] = {
+	0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8,
+	0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+	0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090,
+	0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+	0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0,
+	0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+	0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400,
+	0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+	0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424,
+	0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+	0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0,
+	0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+	0xaa444444, 0x54a854a8, 0x95809580, 0x96969600,
+	0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+	0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000,
+	0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+};
+
+static const uint8_t weights2[] = { 0, 21, 43, 64 };
+static const uint8_t weights3[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t weights4[] = {
+	0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+static const int etc1_modifier_tables[8][2] = {
+	{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+	{ 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int etc2_distance_table[8] = {
+	3, 6, 11, 16, 23, 32, 41, 64
+};
+
+static const int eac_modifier_tables[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static enum codec
+get_codec(GLenum format)
+{
+	switch (format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		return CODEC_DXT1_RGB;
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		return CODEC_DXT1_RGBA;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		return CODEC_DXT3;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		return CODEC_DXT5;
+	case GL_COMPRESSED_RED_RGTC1:
+		return CODEC_RGTC1;
+	case GL_COMPRESSED_SIGNED_RED_RGTC1:
+		return CODEC_RGTC1_SIGNED;
+	case GL_COMPRESSED_RG_RGTC2:
+		return CODEC_RGTC2;
+	case GL_COMPRESSED_SIGNED_RG_RGTC2:
+		return CODEC_RGTC2_SIGNED;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		return CODEC_BPTC_UNORM;
+	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		return CODEC_BPTC_FLOAT;
+	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+		return CODEC_BPTC_SIGNED_FLOAT;
+	case GL_ETC1_RGB8_OES:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+		return CODEC_ETC2_RGB;
+	case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+	case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+		return CODEC_ETC2_PUNCHTHROUGH;
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+		return CODEC_ETC2_EAC;
+	case GL_COMPRESSED_R11_EAC:
+		return CODEC_EAC_R11;
+	case GL_COMPRESSED_SIGNED_R11_EAC:
+		return CODEC_EAC_R11_SIGNED;
+	case GL_COMPRESSED_RG11_EAC:
+		return CODEC_EAC_RG11;
+	case GL_COMPRESSED_SIGNED_RG11_EAC:
+		return CODEC_EAC_RG11_SIGNED;
+	default:
+		return CODEC_NONE;
+	}
+}
+
+bool
+piglit_texcompress_is_supported(GLenum format)
+{
+	return get_codec(format) != CODEC_NONE;
+}
+
+unsigned
+piglit_texcompress_block_bytes(GLenum format)
+{
+	switch (get_codec(format)) {
+	case CODEC_NONE:
+		return 0;
+	case CODEC_DXT1_RGB:
+	case CODEC_DXT1_RGBA:
+	case CODEC_RGTC1:
+	case CODEC_RGTC1_SIGNED:
+	case CODEC_ETC2_RGB:
+	case CODEC_ETC2_PUNCHTHROUGH:
+	case CODEC_EAC_R11:
+	case CODEC_EAC_R11_SIGNED:
+		return 8;
+	default:
+		return 16;
+	}
+}
+
+size_t
+piglit_texcompress_image_size(GLenum format, unsigned width, unsigned height)
+{
+	size_t blocks_wide = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	size_t blocks_high = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	return blocks_wide * blocks_high * piglit_texcompress_block_bytes(format);
+}
+
+static void
+set_texel(float *texel, float r, float g, float b, float a)
+{
+	texel[0] = r;
+	texel[1] = g;
+	texel[2] = b;
+	texel[3] = a;
+}
+
+static int
+quantize(float value, int max)
+{
+	return (int) (CLAMP(value, 0.0f, 1.0f) * max + 0.5f);
+}
+
+static int
+quantize_signed(float value, int max)
+{
+	return (int) floorf(CLAMP(value, -1.0f, 1.0f) * max + 0.5f);
+}
+
+static int
+sign_extend(int value, int n_bits)
+{
+	int shift = 8 * sizeof(int) - n_bits;
+
+	return (int) ((unsigned) value << shift) >> shift;
+}
+
+static float
+half_to_float(uint16_t half)
+{
+	int exponent = (half >> 10) & 0x1f;
+	int mantissa = half & 0x3ff;
+	float value;
+
+	if (exponent == 0)
+		value = ldexpf(mantissa, -24);
+	else if (exponent == 31)
+		value = mantissa ? NAN : INFINITY;
+	else
+		value = ldexpf(mantissa | 0x400, exponent - 25);
+
+	return (half & 0x8000) ? -value : value;
+}
+
+/*
+ * Little-endian bitstreams of BPTC.
+ */
+
+static unsigned
+extract_bits(const uint8_t *block, int *offset, int n_bits)
+{
+	int byte_index = *offset / 8;
+	uint32_t bits = 0;
+	int i;
+
+	for (i = 0; i < 4 && byte_index + i < BPTC_BLOCK_BYTES; i++)
+		bits |= (uint32_t) block[byte_index + i] << (8 * i);
+
+	bits >>= *offset % 8;
+	*offset += n_bits;
+
+	return bits & ((1u << n_bits) - 1);
+}
+
+static void
+write_bits(uint8_t *out, int *offset, int value, int n_bits)
+{
+	int bit_index = *offset % 8;
+	int byte_index = *offset / 8;
+	int n_bits_in_byte = MIN2(n_bits, 8 - bit_index);
+
+	*offset += n_bits;
+
+	while (n_bits > 0) {
+		out[byte_index] |= ((value & ((1 << n_bits_in_byte) - 1)) <<
+				    bit_index);
+
+		n_bits -= n_bits_in_byte;
+		value >>= n_bits_in_byte;
+		byte_index++;
+		bit_index = 0;
+		n_bits_in_byte = MIN2(n_bits, 8);
+	}
+}
+
+static int
+get_subset(int n_subsets, int partition, int texel)
+{
+	switch (n_subsets) {
+	case 2:
+		return (partition_table1[partition] >> texel) & 1;
+	case 3:
+		return (partition_table2[partition] >> (texel * 2)) & 3;
+	default:
+		return 0;
+	}
+}
+
+static bool
+is_anchor(int n_subsets, int partition, int texel)
+{
+	if (texel == 0)
+		return true;
+
+	switch (n_subsets) {
+	case 2:
+		return anchor_indices[0][partition] == texel;
+	case 3:
+		return (anchor_indices[1][partition] == texel ||
+			anchor_indices[2][partition] == texel);
+	default:
+		return false;
+	}
+}
+
+static int
+interpolate(int a, int b, int index, int n_bits)
+{
+	const uint8_t *weights = (n_bits == 2 ? weights2 :
+				  n_bits == 3 ? weights3 : weights4);
+
+	return (a * (64 - weights[index]) + b * weights[index] + 32) >> 6;
+}
+
+/*
+ * S3TC and RGTC.
+ */
+
+static void
+dxt_palette(unsigned c0, unsigned c1, bool four_colors, bool transparent,
+	    float palette[4][4])
+{
+	const unsigned colors[2] = { c0, c1 };
+	int i, c;
+
+	for (i = 0; i < 2; i++) {
+		int r = colors[i] >> 11;
+		int g = (colors[i] >> 5) & 0x3f;
+		int b = colors[i] & 0x1f;
+
+		set_texel(palette[i],
+			  ((r << 3) | (r >> 2)) / 255.0f,
+			  ((g << 2) | (g >> 4)) / 255.0f,
+			  ((b << 3) | (b >> 2)) / 255.0f,
+			  1.0f);
+	}
+
+	if (four_colors || c0 > c1) {
+		for (c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		palette[2][3] = palette[3][3] = 1.0f;
+	} else {
+		for (c = 0; c < 3; c++)
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+		palette[2][3] = 1.0f;
+		set_texel(palette[3], 0.0f, 0.0f, 0.0f,
+			  transparent ? 0.0f : 1.0f);
+	}
+}
+
+static void
+decode_dxt_color(const uint8_t *src, bool four_colors, bool transparent,
+		 float *dst)
+{
+	uint32_t bits = (src[4] | src[5] << 8 | src[6] << 16 |
+			 (uint32_t) src[7] << 24);
+	float palette[4][4];
+	int i;
+
+	dxt_palette(src[0] | src[1] << 8, src[2] | src[3] << 8,
+		    four_colors, transparent, palette);
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		memcpy(dst + i * 4, palette[(bits >> (i * 2)) & 3],
+		       sizeof(palette[0]));
+}
+
+/**
+ * Values of the eight indices of an alpha block.  \c lo and \c hi are the
+ * extra values of the six-value mode.
+ */
+static void
+alpha_palette(int a0, int a1, int lo, int hi, float palette[8])
+{
+	int i;
+
+	palette[0] = a0;
+	palette[1] = a1;
+
+	if (a0 > a1) {
+		for (i = 2; i < 8; i++)
+			palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7.0f;
+	} else {
+		for (i = 2; i < 6; i++)
+			palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5.0f;
+		palette[6] = lo;
+		palette[7] = hi;
+	}
+}
+
+/**
+ * Decode a DXT5 alpha or RGTC block into one component of \c dst.
+ */
+static void
+decode_alpha(const uint8_t *src, bool is_signed, float *dst)
+{
+	uint64_t bits = 0;
+	float palette[8];
+	float scale;
+	int i;
+
+	for (i = 7; i >= 2; i--)
+		bits = bits << 8 | src[i];
+
+	if (is_signed) {
+		alpha_palette(MAX2((int8_t) src[0], -127),
+			      MAX2((int8_t) src[1], -127),
+			      -127, 127, palette);
+		scale = 1.0f / 127;
+	} else {
+		alpha_palette(src[0], src[1], 0, 255, palette);
+		scale = 1.0f / 255;
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		dst[i * 4] = palette[(bits >> (i * 3)) & 7] * scale;
+}
+
+static void
+decode_dxt3_alpha(const uint8_t *src, float *dst)
+{
+	int i;
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		dst[i * 4] = ((src[i / 2] >> (i % 2 * 4)) & 0xf) / 15.0f;
+}
+
+static unsigned
+pack_565(const float *rgb)
+{
+	return (quantize(rgb[0], 31) << 11 |
+		quantize(rgb[1], 63) << 5 |
+		quantize(rgb[2], 31));
+}
+
+static float
+distance_squared(const float *a, const float *b, int n)
+{
+	float sum = 0.0f;
+	int i;
+
+	for (i = 0; i < n; i++)
+		sum += (a[i] - b[i]) * (a[i] - b[i]);
+
+	return sum;
+}
+
+/**
+ * Encode the color part of an S3TC block.  With \c punchthrough, texels
+ * with an alpha below 0.5 use the transparent index of the three-color
+ * mode.
+ */
+static void
+encode_dxt_color(const float *src, bool four_colors, bool punchthrough,
+		 uint8_t *dst)
+{
+	float lo[3] = { 1.0f, 1.0f, 1.0f }, hi[3] = { 0.0f, 0.0f, 0.0f };
+	bool transparent[BLOCK_TEXELS];
+	bool any_transparent = false;
+	float palette[4][4];
+	unsigned c0, c1, tmp;
+	uint32_t bits = 0;
+	int i, c;
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		transparent[i] = punchthrough && src[i * 4 + 3] < 0.5f;
+		if (transparent[i]) {
+			any_transparent = true;
+			continue;
+		}
+		for (c = 0; c < 3; c++) {
+			lo[c] = MIN2(lo[c], src[i * 4 + c]);
+			hi[c] = MAX2(hi[c], src[i * 4 + c]);
+		}
+	}
+
+	c0 = pack_565(hi);
+	c1 = pack_565(lo);
+	if (c0 < c1 || (any_transparent && c0 > c1)) {
+		tmp = c0;
+		c0 = c1;
+		c1 = tmp;
+	}
+
+	dxt_palette(c0, c1, four_colors, punchthrough, palette);
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		int n_colors = (four_colors || c0 > c1) ? 4 : 3;
+		int best = 0;
+		float best_distance = INFINITY;
+
+		if (transparent[i]) {
+			bits |= 3u << (i * 2);
+			continue;
+		}
+
+		for (c = 0; c < n_colors; c++) {
+			float d = distance_squared(src + i * 4,
+						   palette[c], 3);
+			if (d < best_distance) {
+				best_distance = d;
+				best = c;
+			}
+		}
+		bits |= (uint32_t) best << (i * 2);
+	}
+
+	dst[0] = c0;
+	dst[1] = c0 >> 8;
+	dst[2] = c1;
+	dst[3] = c1 >> 8;
+	for (i = 0; i < 4; i++)
+		dst[4 + i] = bits >> (i * 8);
+}
+
+/**
+ * Encode one component of \c src as a DXT5 alpha or RGTC block.
+ */
+static void
+encode_alpha(const float *src, bool is_signed, uint8_t *dst)
+{
+	int values[BLOCK_TEXELS];
+	int a0 = is_signed ? -127 : 0, a1 = is_signed ? 127 : 255;
+	float palette[8];
+	uint64_t bits = 0;
+	int i, j;
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		values[i] = (is_signed ? quantize_signed(src[i * 4], 127) :
+			     quantize(src[i * 4], 255));
+		a0 = MAX2(a0, values[i]);
+		a1 = MIN2(a1, values[i]);
+	}
+
+	if (is_signed)
+		alpha_palette(a0, a1, -127, 127, palette);
+	else
+		alpha_palette(a0, a1, 0, 255, palette);
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		int best = 0;
+		float best_distance = INFINITY;
+
+		for (j = 0; j < 8; j++) {
+			float d = fabsf(palette[j] - values[i]);
+			if (d < best_distance) {
+				best_distance = d;
+				best = j;
+			}
+		}
+		bits |= (uint64_t) best << (i * 3);
+	}
+
+	dst[0] = a0;
+	dst[1] = a1;
+	for (i = 0; i < 6; i++)
+		dst[2 + i] = bits >> (i * 8);
+}
+
+static void
+encode_dxt3_alpha(const float *src, uint8_t *dst)
+{
+	int i;
+
+	memset(dst, 0, 8);
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		dst[i / 2] |= quantize(src[i * 4], 15) << (i % 2 * 4);
+}
+
+/*
+ * BPTC unorm.
+ */
+
+static void
+decode_bptc_unorm(const uint8_t *src, float *dst)
+{
+	const struct bptc_mode *mode;
+	int mode_num, partition, rotation, index_selection;
+	int n_color_bits, n_alpha_bits;
+	int endpoints[2 * 3][4];
+	int primary[BLOCK_TEXELS], secondary[BLOCK_TEXELS];
+	int offset, subset, endpoint, component, pbit;
+	int i;
+
+	for (mode_num = 0; mode_num < 8; mode_num++) {
+		if (src[0] & (1 << mode_num))
+			break;
+	}
+
+	if (mode_num == 8) {
+		/* Reserved mode */
+		memset(dst, 0, BLOCK_TEXELS * 4 * sizeof(float));
+		return;
+	}
+
+	mode = bptc_modes + mode_num;
+	offset = mode_num + 1;
+	partition = extract_bits(src, &offset, mode->n_partition_bits);
+	rotation = extract_bits(src, &offset,
+				mode->has_rotation_bits ? 2 : 0);
+	index_selection = extract_bits(src, &offset,
+				       mode->has_index_selection_bit);
+
+	for (component = 0; component < 3; component++) {
+		for (subset = 0; subset < mode->n_subsets; subset++) {
+			for (endpoint = 0; endpoint < 2; endpoint++) {
+				endpoints[subset * 2 + endpoint][component] =
+					extract_bits(src, &offset,
+						     mode->n_color_bits);
+			}
+		}
+	}
+
+	for (subset = 0; subset < mode->n_subsets; subset++) {
+		for (endpoint = 0; endpoint < 2; endpoint++) {
+			endpoints[subset * 2 + endpoint][3] =
+				extract_bits(src, &offset, mode->n_alpha_bits);
+		}
+	}
+
+	n_color_bits = mode->n_color_bits;
+	n_alpha_bits = mode->n_alpha_bits;
+
+	if (mode->has_endpoint_pbits) {
+		for (i = 0; i < mode->n_subsets * 2; i++) {
+			pbit = extract_bits(src, &offset, 1);
+			for (component = 0; component < 4; component++) {
+				endpoints[i][component] =
+					endpoints[i][component] << 1 | pbit;
+			}
+		}
+		n_color_bits++;
+		n_alpha_bits++;
+	}
+
+	if (mode->has_shared_pbits) {
+		for (subset = 0; subset < mode->n_subsets; subset++) {
+			pbit = extract_bits(src, &offset, 1);
+			for (i = subset * 2; i < subset * 2 + 2; i++) {
+				for (component = 0; component < 4; component++) {
+					endpoints[i][component] =
+						endpoints[i][component] << 1 |
+						pbit;
+				}
+			}
+		}
+		n_color_bits++;
+		n_alpha_bits++;
+	}
+
+	for (i = 0; i < mode->n_subsets * 2; i++) {
+		for (component = 0; component < 3; component++) {
+			int value = endpoints[i][component] <<
+				(8 - n_color_bits);
+			endpoints[i][component] = value | value >> n_color_bits;
+		}
+
+		if (mode->n_alpha_bits) {
+			int value = endpoints[i][3] << (8 - n_alpha_bits);
+			endpoints[i][3] = value | value >> n_alpha_bits;
+		} else {
+			endpoints[i][3] = 255;
+		}
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		primary[i] = extract_bits(src, &offset,
+					  mode->n_index_bits -
+					  is_anchor(mode->n_subsets,
+						    partition, i));
+	}
+
+	for (i = 0; i < BLOCK_TEXELS && mode->n_secondary_index_bits; i++) {
+		secondary[i] = extract_bits(src, &offset,
+					    mode->n_secondary_index_bits -
+					    (i == 0));
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		const int *e = endpoints[get_subset(mode->n_subsets,
+						    partition, i) * 2];
+		int color_index = primary[i], color_bits = mode->n_index_bits;
+		int alpha_index = primary[i], alpha_bits = mode->n_index_bits;
+		int texel[4];
+
+		if (mode->n_secondary_index_bits) {
+			if (index_selection) {
+				color_index = secondary[i];
+				color_bits = mode->n_secondary_index_bits;
+			} else {
+				alpha_index = secondary[i];
+				alpha_bits = mode->n_secondary_index_bits;
+			}
+		}
+
+		for (component = 0; component < 3; component++) {
+			texel[component] = interpolate(e[component],
+						       e[4 + component],
+						       color_index,
+						       color_bits);
+		}
+		texel[3] = interpolate(e[3], e[7], alpha_index, alpha_bits);
+
+		if (rotation) {
+			int tmp = texel[3];
+			texel[3] = texel[rotation - 1];
+			texel[rotation - 1] = tmp;
+		}
+
+		set_texel(dst + i * 4,
+			  texel[0] / 255.0f, texel[1] / 255.0f,
+			  texel[2] / 255.0f, texel[3] / 255.0f);
+	}
+}
+
+void
+piglit_bptc_pack_block(const struct piglit_bptc_block *block, void *out)
+{
+	const struct bptc_mode *mode = bptc_modes + block->mode;
+	uint8_t *dst = out;
+	int offset = 0;
+	int component;
+	int subset;
+	int endpoint;
+	int n_bits;
+	int i;
+
+	memset(dst, 0, BPTC_BLOCK_BYTES);
+
+	write_bits(dst, &offset, 1 << block->mode, block->mode + 1);
+
+	write_bits(dst, &offset, block->partition, mode->n_partition_bits);
+
+	write_bits(dst, &offset, block->rotation,
+		   mode->has_rotation_bits ? 2 : 0);
+
+	write_bits(dst, &offset, block->index_selection,
+		   mode->has_index_selection_bit);
+
+	for (component = 0; component < 3; component++) {
+		for (subset = 0; subset < mode->n_subsets; subset++) {
+			for (endpoint = 0; endpoint < 2; endpoint++) {
+				write_bits(dst, &offset,
+					   block->endpoints[subset * 2 +
+							    endpoint][component],
+					   mode->n_color_bits);
+			}
+		}
+	}
+
+	for (subset = 0; subset < mode->n_subsets; subset++) {
+		for (endpoint = 0; endpoint < 2; endpoint++) {
+			write_bits(dst, &offset,
+				   block->endpoints[subset * 2 + endpoint][3],
+				   mode->n_alpha_bits);
+		}
+	}
+
+	for (subset = 0; subset < mode->n_subsets; subset++) {
+		for (endpoint = 0; endpoint < 2; endpoint++) {
+			write_bits(dst, &offset,
+				   block->pbits[subset * 2 + endpoint],
+				   mode->has_endpoint_pbits);
+		}
+	}
+
+	for (subset = 0; subset < mode->n_subsets; subset++) {
+		write_bits(dst, &offset,
+			   block->pbits[subset],
+			   mode->has_shared_pbits);
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		n_bits = mode->n_index_bits;
+
+		if (is_anchor(mode->n_subsets, block->partition, i))
+			n_bits--;
+
+		write_bits(dst, &offset, block->primary_indices[i], n_bits);
+	}
+
+	if (mode->n_secondary_index_bits) {
+		for (i = 0; i < BLOCK_TEXELS; i++) {
+			n_bits = mode->n_secondary_index_bits;
+
+			if (i == 0)
+				n_bits--;
+
+			write_bits(dst, &offset,
+				   block->secondary_indices[i], n_bits);
+		}
+	}
+
+	assert(offset == BPTC_BLOCK_BYTES * 8);
+}
+
+/**
+ * Encode a block with mode 6: one subset, 7-bit RGBA endpoints with a
+ * p-bit each, and 4-bit indices.
+ */
+static void
+encode_bptc_unorm(const float *src, uint8_t *dst)
+{
+	struct piglit_bptc_block block;
+	int values[BLOCK_TEXELS][4];
+	int lo[4] = { 255, 255, 255, 255 }, hi[4] = { 0, 0, 0, 0 };
+	int e[2][4];
+	int i, j, c;
+
+	memset(&block, 0, sizeof(block));
+	block.mode = 6;
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		for (c = 0; c < 4; c++) {
+			values[i][c] = quantize(src[i * 4 + c], 255);
+			lo[c] = MIN2(lo[c], values[i][c]);
+			hi[c] = MAX2(hi[c], values[i][c]);
+		}
+	}
+
+	/* Pick the p-bit that most components of each endpoint want,
+	 * then the closest 7-bit values for that p-bit.
+	 */
+	for (i = 0; i < 2; i++) {
+		const int *target = i ? hi : lo;
+		int pbit = ((target[0] & 1) + (target[1] & 1) +
+			    (target[2] & 1) + (target[3] & 1)) >= 2;
+
+		block.pbits[i] = pbit;
+		for (c = 0; c < 4; c++) {
+			block.endpoints[i][c] =
+				MIN2((target[c] - pbit + 1) / 2, 127);
+			e[i][c] = block.endpoints[i][c] << 1 | pbit;
+		}
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		int best = 0, best_distance = INT_MAX;
+
+		for (j = 0; j < 16; j++) {
+			int d = 0;
+
+			for (c = 0; c < 4; c++) {
+				int v = interpolate(e[0][c], e[1][c], j, 4);
+				d += (v - values[i][c]) * (v - values[i][c]);
+			}
+			if (d < best_distance) {
+				best_distance = d;
+				best = j;
+			}
+		}
+		block.primary_indices[i] = best;
+	}
+
+	/* The anchor texel has no room for the high bit of its index. */
+	if (block.primary_indices[0] & 8) {
+		for (c = 0; c < 4; c++) {
+			uint8_t tmp = block.endpoints[0][c];
+			block.endpoints[0][c] = block.endpoints[1][c];
+			block.endpoints[1][c] = tmp;
+		}
+		block.pbits[0] ^= block.pbits[1];
+		block.pbits[1] ^= block.pbits[0];
+		block.pbits[0] ^= block.pbits[1];
+		for (i = 0; i < BLOCK_TEXELS; i++)
+			block.primary_indices[i] = 15 - block.primary_indices[i];
+	}
+
+	piglit_bptc_pack_block(&block, dst);
+}
+
+/*
+ * BPTC float.
+ */
+
+static const struct bptc_float_mode *
+get_float_mode(int mode)
+{
+	if (mode & 2)
+		return bptc_float_modes + (((mode >> 1) & 0xe) | (mode & 1)) + 2;
+	else
+		return bptc_float_modes + (mode & 1);
+}
+
+static int
+unquantize(int value, int n_bits, bool is_signed)
+{
+	bool negative = false;
+	int result;
+
+	if (!is_signed) {
+		if (n_bits >= 15 || value == 0)
+			return value;
+		if (value == (1 << n_bits) - 1)
+			return 0xffff;
+		return ((value << 16) + 0x8000) >> n_bits;
+	}
+
+	if (n_bits >= 16)
+		return value;
+
+	if (value < 0) {
+		negative = true;
+		value = -value;
+	}
+
+	if (value == 0)
+		result = 0;
+	else if (value >= (1 << (n_bits - 1)) - 1)
+		result = 0x7fff;
+	else
+		result = ((value << 15) + 0x4000) >> (n_bits - 1);
+
+	return negative ? -result : result;
+}
+
+static uint16_t
+finish_unquantize(int value, bool is_signed)
+{
+	if (!is_signed)
+		return value * 31 / 64;
+	else if (value < 0)
+		return (-value * 31 / 32) | 0x8000;
+	else
+		return value * 31 / 32;
+}
+
+/**
+ * Read the endpoints of a BPTC float block and unquantize them.  Returns
+ * the mode or NULL for a reserved mode.
+ */
+static const struct bptc_float_mode *
+read_float_endpoints(const uint8_t *src, bool is_signed, int *offset,
+		     int endpoints[4][3])
+{
+	const struct bptc_float_mode *mode;
+	const struct bptc_float_bitfield *bitfield;
+	int mode_bits;
+	int n_endpoints;
+	int i, c;
+
+	mode_bits = extract_bits(src, offset, 2);
+	if (mode_bits & 2) {
+		*offset = 0;
+		mode_bits = extract_bits(src, offset, 5);
+	}
+
+	mode = get_float_mode(mode_bits);
+	if (mode->n_endpoint_bits == 0)
+		return NULL;
+
+	memset(endpoints, 0, 4 * sizeof(endpoints[0]));
+
+	for (bitfield = mode->bitfields; bitfield->endpoint != -1; bitfield++) {
+		int value = extract_bits(src, offset, bitfield->n_bits);
+
+		if (bitfield->reverse) {
+			int reversed = 0;
+
+			for (i = 0; i < bitfield->n_bits; i++)
+				reversed |= ((value >> i) & 1) <<
+					(bitfield->n_bits - 1 - i);
+			value = reversed;
+		}
+
+		endpoints[bitfield->endpoint][bitfield->component] |=
+			value << bitfield->offset;
+	}
+
+	n_endpoints = mode->n_partition_bits ? 4 : 2;
+
+	if (is_signed) {
+		for (c = 0; c < 3; c++) {
+			endpoints[0][c] = sign_extend(endpoints[0][c],
+						      mode->n_endpoint_bits);
+		}
+	}
+
+	for (i = 1; i < n_endpoints; i++) {
+		for (c = 0; c < 3; c++) {
+			int value = endpoints[i][c];
+
+			if (mode->transformed_endpoints) {
+				value = sign_extend(value,
+						    mode->n_delta_bits[c]);
+				value = ((endpoints[0][c] + value) &
+					 ((1 << mode->n_endpoint_bits) - 1));
+			}
+			if (is_signed)
+				value = sign_extend(value,
+						    mode->n_endpoint_bits);
+			endpoints[i][c] = value;
+		}
+	}
+
+	for (i = 0; i < n_endpoints; i++) {
+		for (c = 0; c < 3; c++) {
+			endpoints[i][c] = unquantize(endpoints[i][c],
+						     mode->n_endpoint_bits,
+						     is_signed);
+		}
+	}
+
+	return mode;
+}
+
+static void
+decode_bptc_float(const uint8_t *src, bool is_signed, float *dst)
+{
+	const struct bptc_float_mode *mode;
+	int endpoints[4][3];
+	int offset = 0;
+	int n_subsets, partition;
+	int i, c;
+
+	mode = read_float_endpoints(src, is_signed, &offset, endpoints);
+	if (mode == NULL) {
+		for (i = 0; i < BLOCK_TEXELS; i++)
+			set_texel(dst + i * 4, 0.0f, 0.0f, 0.0f, 1.0f);
+		return;
+	}
+
+	n_subsets = mode->n_partition_bits ? 2 : 1;
+	partition = extract_bits(src, &offset, mode->n_partition_bits);
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		int index = extract_bits(src, &offset,
+					 mode->n_index_bits -
+					 is_anchor(n_subsets, partition, i));
+		const int *e = endpoints[get_subset(n_subsets,
+						    partition, i) * 2];
+
+		for (c = 0; c < 3; c++) {
+			int value = interpolate(e[c], e[3 + c], index,
+						mode->n_index_bits);
+			dst[i * 4 + c] =
+				half_to_float(finish_unquantize(value,
+								is_signed));
+		}
+		dst[i * 4 + 3] = 1.0f;
+	}
+}
+
+void
+piglit_bptc_float_pack_block(const struct piglit_bptc_float_block *block,
+			     void *out)
+{
+	const struct bptc_float_mode *mode = get_float_mode(block->mode);
+	const struct bptc_float_bitfield *bitfield;
+	uint8_t *dst = out;
+	int n_subsets = mode->n_partition_bits ? 2 : 1;
+	int offset = 0;
+	int n_bits;
+	int value;
+	int i;
+
+	memset(dst, 0, BPTC_BLOCK_BYTES);
+
+	if (block->mode < 2)
+		write_bits(dst, &offset, block->mode, 2);
+	else
+		write_bits(dst, &offset, block->mode, 5);
+
+	for (bitfield = mode->bitfields; bitfield->endpoint != -1; bitfield++) {
+		value = ((block->endpoints[bitfield->endpoint]
+			  [bitfield->component] >> bitfield->offset) &
+			 ((1 << bitfield->n_bits) - 1));
+
+		if (bitfield->reverse) {
+			int reversed = 0;
+
+			for (i = 0; i < bitfield->n_bits; i++)
+				reversed |= ((value >> i) & 1) <<
+					(bitfield->n_bits - 1 - i);
+			value = reversed;
+		}
+
+		write_bits(dst, &offset, value, bitfield->n_bits);
+	}
+
+	write_bits(dst, &offset, block->partition, mode->n_partition_bits);
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		n_bits = mode->n_index_bits;
+
+		if (is_anchor(n_subsets, block->partition, i))
+			n_bits--;
+
+		write_bits(dst, &offset, block->indices[i], n_bits);
+	}
+
+	assert(offset == BPTC_BLOCK_BYTES * 8);
+}
+
+/**
+ * Quantize a float to the 10-bit endpoints of mode 0x03, as the inverse
+ * of unquantize() and finish_unquantize().
+ */
+static int
+quantize_float_endpoint(float value, bool is_signed)
+{
+	uint16_t half;
+	int magnitude;
+
+	if (!is_signed)
+		value = MAX2(value, 0.0f);
+	half = piglit_half_from_float(CLAMP(value, -65504.0f, 65504.0f));
+	magnitude = half & 0x7fff;
+
+	if (!is_signed)
+		return MIN2(magnitude / 31, 1023);
+
+	magnitude = MIN2(magnitude / 62, 511);
+	return (half & 0x8000) ? -magnitude : magnitude;
+}
+
+/**
+ * Encode a block with mode 0x03: one subset, untransformed 10-bit
+ * endpoints, and 4-bit indices.
+ */
+static void
+encode_bptc_float(const float *src, bool is_signed, uint8_t *dst)
+{
+	struct piglit_bptc_float_block block;
+	float lo[3] = { INFINITY, INFINITY, INFINITY };
+	float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+	float palette[16][3];
+	int e[2][3];
+	int i, j, c;
+
+	memset(&block, 0, sizeof(block));
+	block.mode = 0x03;
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		for (c = 0; c < 3; c++) {
+			lo[c] = MIN2(lo[c], src[i * 4 + c]);
+			hi[c] = MAX2(hi[c], src[i * 4 + c]);
+		}
+	}
+
+	for (c = 0; c < 3; c++) {
+		int q0 = quantize_float_endpoint(lo[c], is_signed);
+		int q1 = quantize_float_endpoint(hi[c], is_signed);
+
+		block.endpoints[0][c] = q0 & 0x3ff;
+		block.endpoints[1][c] = q1 & 0x3ff;
+		e[0][c] = unquantize(q0, 10, is_signed);
+		e[1][c] = unquantize(q1, 10, is_signed);
+	}
+
+	for (j = 0; j < 16; j++) {
+		for (c = 0; c < 3; c++) {
+			int value = interpolate(e[0][c], e[1][c], j, 4);
+			palette[j][c] =
+				half_to_float(finish_unquantize(value,
+								is_signed));
+		}
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		int best = 0;
+		float best_distance = INFINITY;
+
+		for (j = 0; j < 16; j++) {
+			float d = distance_squared(src + i * 4,
+						   palette[j], 3);
+			if (d < best_distance) {
+				best_distance = d;
+				best = j;
+			}
+		}
+		block.indices[i] = best;
+	}
+
+	/* The anchor texel has no room for the high bit of its index. */
+	if (block.indices[0] & 8) {
+		for (c = 0; c < 3; c++) {
+			uint16_t tmp = block.endpoints[0][c];
+			block.endpoints[0][c] = block.endpoints[1][c];
+			block.endpoints[1][c] = tmp;
+		}
+		for (i = 0; i < BLOCK_TEXELS; i++)
+			block.indices[i] = 15 - block.indices[i];
+	}
+
+	piglit_bptc_float_pack_block(&block, dst);
+}
+
+/*
+ * ETC1 and ETC2.  Blocks are big-endian and texels are stored in
+ * column-major order.
+ */
+
+static int
+clamp_byte(int value)
+{
+	return CLAMP(value, 0, 255);
+}
+
+static int
+extend_bits(int value, int n_bits)
+{
+	return (value << (8 - n_bits)) | (value >> (2 * n_bits - 8));
+}
+
+static void
+decode_etc2_paints(const uint8_t *src, const int paints[4][3],
+		   bool opaque, int texels[BLOCK_TEXELS][4])
+{
+	uint32_t indices = ((uint32_t) src[4] << 24 | src[5] << 16 |
+			    src[6] << 8 | src[7]);
+	int x, y, c;
+
+	for (y = 0; y < BLOCK_SIZE; y++) {
+		for (x = 0; x < BLOCK_SIZE; x++) {
+			int k = x * 4 + y;
+			int index = (((indices >> (k + 15)) & 2) |
+				     ((indices >> k) & 1));
+			int *texel = texels[y * 4 + x];
+
+			if (!opaque && index == 2) {
+				memset(texel, 0, 4 * sizeof(int));
+				continue;
+			}
+
+			for (c = 0; c < 3; c++)
+				texel[c] = paints[index][c];
+			texel[3] = 255;
+		}
+	}
+}
+
+static void
+decode_etc2_planar(const uint8_t *src, int texels[BLOCK_TEXELS][4])
+{
+	int o[3], h[3], v[3];
+	int x, y, c;
+
+	o[0] = extend_bits((src[0] >> 1) & 0x3f, 6);
+	o[1] = extend_bits(((src[0] & 1) << 6) | ((src[1] >> 1) & 0x3f), 7);
+	o[2] = extend_bits(((src[1] & 1) << 5) | (src[2] & 0x18) |
+			   ((src[2] & 3) << 1) | (src[3] >> 7), 6);
+	h[0] = extend_bits(((src[3] >> 1) & 0x3e) | (src[3] & 1), 6);
+	h[1] = extend_bits(src[4] >> 1, 7);
+	h[2] = extend_bits(((src[4] & 1) << 5) | (src[5] >> 3), 6);
+	v[0] = extend_bits(((src[5] & 7) << 3) | (src[6] >> 5), 6);
+	v[1] = extend_bits(((src[6] & 0x1f) << 2) | (src[7] >> 6), 7);
+	v[2] = extend_bits(src[7] & 0x3f, 6);
+
+	for (y = 0; y < BLOCK_SIZE; y++) {
+		for (x = 0; x < BLOCK_SIZE; x++) {
+			int *texel = texels[y * 4 + x];
+
+			for (c = 0; c < 3; c++) {
+				texel[c] = clamp_byte((x * (h[c] - o[c]) +
+						       y * (v[c] - o[c]) +
+						       4 * o[c] + 2) >> 2);
+			}
+			texel[3] = 255;
+		}
+	}
+}
+
+/**
+ * Decode an ETC2 RGB block, which is also an ETC1 block when it uses
+ * neither of the T, H and planar modes, to 8-bit values.
+ */
+static void
+decode_etc2_rgb_ubyte(const uint8_t *src, bool punchthrough,
+		      int texels[BLOCK_TEXELS][4])
+{
+	uint32_t indices = ((uint32_t) src[4] << 24 | src[5] << 16 |
+			    src[6] << 8 | src[7]);
+	bool opaque = !punchthrough || (src[3] & 2);
+	bool differential = punchthrough || (src[3] & 2);
+	int base[2][3];
+	int tables[2] = { (src[3] >> 5) & 7, (src[3] >> 2) & 7 };
+	bool flip = src[3] & 1;
+	int x, y, c;
+
+	if (!differential) {
+		for (c = 0; c < 3; c++) {
+			base[0][c] = extend_bits(src[c] >> 4, 4);
+			base[1][c] = extend_bits(src[c] & 0xf, 4);
+		}
+	} else {
+		int base5[2][3];
+
+		for (c = 0; c < 3; c++) {
+			base5[0][c] = src[c] >> 3;
+			base5[1][c] = base5[0][c] + sign_extend(src[c] & 7, 3);
+		}
+
+		if (base5[1][0] < 0 || base5[1][0] > 31) {
+			/* T mode */
+			int paints[4][3];
+			int d = etc2_distance_table[((src[3] >> 1) & 6) |
+						    (src[3] & 1)];
+
+			paints[0][0] = extend_bits(((src[0] >> 1) & 0xc) |
+						   (src[0] & 3), 4);
+			paints[0][1] = extend_bits(src[1] >> 4, 4);
+			paints[0][2] = extend_bits(src[1] & 0xf, 4);
+			paints[2][0] = extend_bits(src[2] >> 4, 4);
+			paints[2][1] = extend_bits(src[2] & 0xf, 4);
+			paints[2][2] = extend_bits(src[3] >> 4, 4);
+			for (c = 0; c < 3; c++) {
+				paints[1][c] = clamp_byte(paints[2][c] + d);
+				paints[3][c] = clamp_byte(paints[2][c] - d);
+			}
+
+			decode_etc2_paints(src, paints, opaque, texels);
+			return;
+		}
+
+		if (base5[1][1] < 0 || base5[1][1] > 31) {
+			/* H mode */
+			int paints[4][3];
+			int b1[3], b2[3];
+			int d;
+
+			b1[0] = extend_bits((src[0] >> 3) & 0xf, 4);
+			b1[1] = extend_bits(((src[0] & 7) << 1) |
+					    ((src[1] >> 4) & 1), 4);
+			b1[2] = extend_bits((src[1] & 8) | ((src[1] & 3) << 1) |
+					    (src[2] >> 7), 4);
+			b2[0] = extend_bits((src[2] >> 3) & 0xf, 4);
+			b2[1] = extend_bits(((src[2] & 7) << 1) |
+					    (src[3] >> 7), 4);
+			b2[2] = extend_bits((src[3] >> 3) & 0xf, 4);
+
+			d = etc2_distance_table[(src[3] & 4) |
+						((src[3] & 1) << 1) |
+						((b1[0] << 16 | b1[1] << 8 |
+						  b1[2]) >=
+						 (b2[0] << 16 | b2[1] << 8 |
+						  b2[2]))];
+
+			for (c = 0; c < 3; c++) {
+				paints[0][c] = clamp_byte(b1[c] + d);
+				paints[1][c] = clamp_byte(b1[c] - d);
+				paints[2][c] = clamp_byte(b2[c] + d);
+				paints[3][c] = clamp_byte(b2[c] - d);
+			}
+
+			decode_etc2_paints(src, paints, opaque, texels);
+			return;
+		}
+
+		if (base5[1][2] < 0 || base5[1][2] > 31) {
+			decode_etc2_planar(src, texels);
+			return;
+		}
+
+		for (c = 0; c < 3; c++) {
+			base[0][c] = extend_bits(base5[0][c], 5);
+			base[1][c] = extend_bits(base5[1][c], 5);
+		}
+	}
+
+	for (y = 0; y < BLOCK_SIZE; y++) {
+		for (x = 0; x < BLOCK_SIZE; x++) {
+			int k = x * 4 + y;
+			int index = (((indices >> (k + 15)) & 2) |
+				     ((indices >> k) & 1));
+			int subblock = flip ? y >= 2 : x >= 2;
+			int modifier =
+				etc1_modifier_tables[tables[subblock]][index & 1];
+			int *texel = texels[y * 4 + x];
+
+			if (!opaque && index == 2) {
+				memset(texel, 0, 4 * sizeof(int));
+				continue;
+			}
+
+			if (!opaque && index == 0)
+				modifier = 0;
+			if (index & 2)
+				modifier = -modifier;
+
+			for (c = 0; c < 3; c++)
+				texel[c] = clamp_byte(base[subblock][c] +
+						      modifier);
+			texel[3] = 255;
+		}
+	}
+}
+
+static void
+decode_etc2_rgb(const uint8_t *src, bool punchthrough, float *dst)
+{
+	int texels[BLOCK_TEXELS][4];
+	int i;
+
+	decode_etc2_rgb_ubyte(src, punchthrough, texels);
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		set_texel(dst + i * 4,
+			  texels[i][0] / 255.0f, texels[i][1] / 255.0f,
+			  texels[i][2] / 255.0f, texels[i][3] / 255.0f);
+	}
+}
+
+/**
+ * Error of the best indices of an ETC1-style subblock for one modifier
+ * table.  Transparent texels take index 2, which leaves the other
+ * indices of a non-opaque block with modifiers 0 and +/-b.
+ */
+static int
+etc_subblock_error(const int texels[BLOCK_TEXELS][3],
+		   const bool *transparent, const int *members,
+		   const int *base, int table, bool opaque,
+		   int indices[8])
+{
+	int total = 0;
+	int i, index, c;
+
+	for (i = 0; i < 8; i++) {
+		const int *texel = texels[members[i]];
+		int best_error = INT_MAX;
+
+		if (transparent[members[i]]) {
+			indices[i] = 2;
+			continue;
+		}
+
+		for (index = 0; index < 4; index++) {
+			int modifier = etc1_modifier_tables[table][index & 1];
+			int error = 0;
+
+			if (!opaque && index == 2)
+				continue;
+			if (!opaque && index == 0)
+				modifier = 0;
+			if (index & 2)
+				modifier = -modifier;
+
+			for (c = 0; c < 3; c++) {
+				int d = clamp_byte(base[c] + modifier) -
+					texel[c];
+				error += d * d;
+			}
+
+			if (error < best_error) {
+				best_error = error;
+				indices[i] = index;
+			}
+		}
+
+		total += best_error;
+	}
+
+	return total;
+}
+
+/**
+ * Encode with the ETC1 individual and differential modes, trying both
+ * subblock orientations.  Punchthrough blocks only have the differential
+ * mode, whose bit says instead whether the block is opaque.
+ */
+static void
+encode_etc2_rgb(const float *src, bool punchthrough, uint8_t *dst)
+{
+	int texels[BLOCK_TEXELS][3];
+	bool transparent[BLOCK_TEXELS];
+	bool opaque = true;
+	int best_error = INT_MAX;
+	int i, c, flip, differential;
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		for (c = 0; c < 3; c++)
+			texels[i][c] = quantize(src[i * 4 + c], 255);
+		transparent[i] = punchthrough && src[i * 4 + 3] < 0.5f;
+		if (transparent[i])
+			opaque = false;
+	}
+
+	for (flip = 0; flip < 2; flip++) {
+		int members[2][8];
+		int average[2][3];
+		int n[2] = { 0, 0 };
+		int x, y, s;
+
+		for (y = 0; y < BLOCK_SIZE; y++) {
+			for (x = 0; x < BLOCK_SIZE; x++) {
+				s = flip ? y >= 2 : x >= 2;
+				members[s][n[s]++] = y * 4 + x;
+			}
+		}
+
+		for (s = 0; s < 2; s++) {
+			int sum[3] = { 0, 0, 0 }, count = 0;
+
+			for (i = 0; i < 8; i++) {
+				if (transparent[members[s][i]])
+					continue;
+				for (c = 0; c < 3; c++)
+					sum[c] += texels[members[s][i]][c];
+				count++;
+			}
+			for (c = 0; c < 3; c++) {
+				average[s][c] = count ?
+					(sum[c] + count / 2) / count : 0;
+			}
+		}
+
+		for (differential = punchthrough; differential < 2;
+		     differential++) {
+			int q[2][3], base[2][3];
+			int tables[2], indices[2][8];
+			int error = 0;
+			uint32_t bits = 0;
+
+			for (c = 0; c < 3; c++) {
+				if (differential) {
+					int delta;
+
+					q[0][c] = (average[0][c] * 31 + 127) / 255;
+					q[1][c] = (average[1][c] * 31 + 127) / 255;
+					delta = CLAMP(q[1][c] - q[0][c], -4, 3);
+					q[1][c] = q[0][c] + delta;
+					base[0][c] = extend_bits(q[0][c], 5);
+					base[1][c] = extend_bits(q[1][c], 5);
+				} else {
+					q[0][c] = (average[0][c] * 15 + 127) / 255;
+					q[1][c] = (average[1][c] * 15 + 127) / 255;
+					base[0][c] = q[0][c] * 17;
+					base[1][c] = q[1][c] * 17;
+				}
+			}
+
+			for (s = 0; s < 2; s++) {
+				int table_error = INT_MAX;
+				int table, table_indices[8];
+
+				for (table = 0; table < 8; table++) {
+					int e = etc_subblock_error(texels,
+								   transparent,
+								   members[s],
+								   base[s],
+								   table,
+								   opaque,
+								   table_indices);
+					if (e < table_error) {
+						table_error = e;
+						tables[s] = table;
+						memcpy(indices[s], table_indices,
+						       sizeof(table_indices));
+					}
+				}
+				error += table_error;
+			}
+
+			if (error >= best_error)
+				continue;
+			best_error = error;
+
+			for (c = 0; c < 3; c++) {
+				if (differential)
+					dst[c] = q[0][c] << 3 |
+						((q[1][c] - q[0][c]) & 7);
+				else
+					dst[c] = q[0][c] << 4 | q[1][c];
+			}
+			dst[3] = (tables[0] << 5 | tables[1] << 2 |
+				  (punchthrough ? opaque : differential) << 1 |
+				  flip);
+
+			for (s = 0; s < 2; s++) {
+				for (i = 0; i < 8; i++) {
+					int texel = members[s][i];
+					int k = (texel % 4) * 4 + texel / 4;
+
+					bits |= (uint32_t) (indices[s][i] >> 1)
+						<< (k + 16);
+					bits |= (uint32_t) (indices[s][i] & 1)
+						<< k;
+				}
+			}
+			for (i = 0; i < 4; i++)
+				dst[4 + i] = bits >> (24 - i * 8);
+		}
+	}
+}
+
+/*
+ * EAC.
+ */
+
+enum eac_kind {
+	EAC_ALPHA8,
+	EAC_UNSIGNED11,
+	EAC_SIGNED11,
+};
+
+/**
+ * Value of an EAC texel: 8 bits for alpha, 11 bits otherwise.
+ */
+static int
+eac_value(enum eac_kind kind, int base, int multiplier, int modifier)
+{
+	switch (kind) {
+	case EAC_ALPHA8:
+		return clamp_byte(base + modifier * multiplier);
+	case EAC_UNSIGNED11:
+		if (multiplier)
+			modifier *= multiplier * 8;
+		return CLAMP(base * 8 + 4 + modifier, 0, 2047);
+	default:
+		if (multiplier)
+			modifier *= multiplier * 8;
+		return CLAMP(MAX2(base, -127) * 8 + modifier, -1023, 1023);
+	}
+}
+
+/**
+ * Decode an EAC block into one component of \c dst.
+ */
+static void
+decode_eac(const uint8_t *src, enum eac_kind kind, float *dst)
+{
+	const int *modifiers = eac_modifier_tables[src[1] & 0xf];
+	int base = kind == EAC_SIGNED11 ? (int8_t) src[0] : src[0];
+	int multiplier = src[1] >> 4;
+	uint64_t indices = 0;
+	int x, y, i;
+
+	for (i = 2; i < 8; i++)
+		indices = indices << 8 | src[i];
+
+	for (y = 0; y < BLOCK_SIZE; y++) {
+		for (x = 0; x < BLOCK_SIZE; x++) {
+			int index = (indices >> (45 - 3 * (x * 4 + y))) & 7;
+			int value = eac_value(kind, base, multiplier,
+					      modifiers[index]);
+			int magnitude;
+			float *texel = dst + (y * 4 + x) * 4;
+
+			switch (kind) {
+			case EAC_ALPHA8:
+				*texel = value / 255.0f;
+				break;
+			case EAC_UNSIGNED11:
+				*texel = ((value << 5) | (value >> 6)) /
+					65535.0f;
+				break;
+			case EAC_SIGNED11:
+				magnitude = abs(value);
+				magnitude = (magnitude << 5) | (magnitude >> 5);
+				*texel = (value < 0 ? -magnitude : magnitude) /
+					32767.0f;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Encode one component of \c src as an EAC block.  The base is the
+ * middle of the range of the block, and each table is tried with the
+ * multipliers that make its modifiers span about that range.
+ */
+static void
+encode_eac(const float *src, enum eac_kind kind, uint8_t *dst)
+{
+	int values[BLOCK_TEXELS];
+	int lo = INT_MAX, hi = INT_MIN;
+	int base, scale;
+	int best_error = INT_MAX;
+	int best_table = 0, best_multiplier = 1;
+	uint64_t bits = 0;
+	int table, multiplier;
+	int i, j;
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		switch (kind) {
+		case EAC_ALPHA8:
+			values[i] = quantize(src[i * 4], 255);
+			break;
+		case EAC_UNSIGNED11:
+			values[i] = quantize(src[i * 4], 2047);
+			break;
+		case EAC_SIGNED11:
+			values[i] = quantize_signed(src[i * 4], 1023);
+			break;
+		}
+		lo = MIN2(lo, values[i]);
+		hi = MAX2(hi, values[i]);
+	}
+
+	switch (kind) {
+	case EAC_ALPHA8:
+		base = (lo + hi + 1) / 2;
+		scale = 1;
+		break;
+	case EAC_UNSIGNED11:
+		base = CLAMP((lo + hi) / 16, 0, 255);
+		scale = 8;
+		break;
+	default:
+		base = CLAMP((int) floorf((lo + hi) / 16.0f + 0.5f),
+			     -127, 127);
+		scale = 8;
+		break;
+	}
+
+	for (table = 0; table < 16; table++) {
+		const int *modifiers = eac_modifier_tables[table];
+		int span = (modifiers[7] - modifiers[3]) * scale;
+		int center = MAX2((hi - lo + span / 2) / span, 1);
+
+		for (multiplier = MAX2(center - 1, 1);
+		     multiplier <= MIN2(center + 1, 15); multiplier++) {
+			int error = 0;
+
+			for (i = 0; i < BLOCK_TEXELS && error < best_error;
+			     i++) {
+				int texel_error = INT_MAX;
+
+				for (j = 0; j < 8; j++) {
+					int d = eac_value(kind, base,
+							  multiplier,
+							  modifiers[j]) -
+						values[i];
+					texel_error = MIN2(texel_error, d * d);
+				}
+				error += texel_error;
+			}
+
+			if (error < best_error) {
+				best_error = error;
+				best_table = table;
+				best_multiplier = multiplier;
+			}
+		}
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		int x = i % 4, y = i / 4;
+		int best = 0, best_distance = INT_MAX;
+
+		for (j = 0; j < 8; j++) {
+			int d = abs(eac_value(kind, base, best_multiplier,
+					      eac_modifier_tables[best_table][j]) -
+				    values[i]);
+			if (d < best_distance) {
+				best_distance = d;
+				best = j;
+			}
+		}
+		bits |= (uint64_t) best << (45 - 3 * (x * 4 + y));
+	}
+
+	dst[0] = base;
+	dst[1] = best_multiplier << 4 | best_table;
+	for (i = 0; i < 6; i++)
+		dst[2 + i] = bits >> (40 - i * 8);
+}
+
+/*
+ * Blocks.
+ */
+
+static void
+set_opaque_black(float *dst)
+{
+	int i;
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		set_texel(dst + i * 4, 0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void
+piglit_texcompress_decode_block(GLenum format, const void *src,
+				float dst[16 * 4])
+{
+	const uint8_t *block = src;
+
+	switch (get_codec(format)) {
+	case CODEC_NONE:
+		assert(!"unsupported compressed format");
+		break;
+	case CODEC_DXT1_RGB:
+		decode_dxt_color(block, false, false, dst);
+		break;
+	case CODEC_DXT1_RGBA:
+		decode_dxt_color(block, false, true, dst);
+		break;
+	case CODEC_DXT3:
+		decode_dxt_color(block + 8, true, false, dst);
+		decode_dxt3_alpha(block, dst + 3);
+		break;
+	case CODEC_DXT5:
+		decode_dxt_color(block + 8, true, false, dst);
+		decode_alpha(block, false, dst + 3);
+		break;
+	case CODEC_RGTC1:
+		set_opaque_black(dst);
+		decode_alpha(block, false, dst);
+		break;
+	case CODEC_RGTC1_SIGNED:
+		set_opaque_black(dst);
+		decode_alpha(block, true, dst);
+		break;
+	case CODEC_RGTC2:
+		set_opaque_black(dst);
+		decode_alpha(block, false, dst);
+		decode_alpha(block + 8, false, dst + 1);
+		break;
+	case CODEC_RGTC2_SIGNED:
+		set_opaque_black(dst);
+		decode_alpha(block, true, dst);
+		decode_alpha(block + 8, true, dst + 1);
+		break;
+	case CODEC_BPTC_UNORM:
+		decode_bptc_unorm(block, dst);
+		break;
+	case CODEC_BPTC_FLOAT:
+		decode_bptc_float(block, false, dst);
+		break;
+	case CODEC_BPTC_SIGNED_FLOAT:
+		decode_bptc_float(block, true, dst);
+		break;
+	case CODEC_ETC2_RGB:
+		decode_etc2_rgb(block, false, dst);
+		break;
+	case CODEC_ETC2_PUNCHTHROUGH:
+		decode_etc2_rgb(block, true, dst);
+		break;
+	case CODEC_ETC2_EAC:
+		decode_etc2_rgb(block + 8, false, dst);
+		decode_eac(block, EAC_ALPHA8, dst + 3);
+		break;
+	case CODEC_EAC_R11:
+		set_opaque_black(dst);
+		decode_eac(block, EAC_UNSIGNED11, dst);
+		break;
+	case CODEC_EAC_R11_SIGNED:
+		set_opaque_black(dst);
+		decode_eac(block, EAC_SIGNED11, dst);
+		break;
+	case CODEC_EAC_RG11:
+		set_opaque_black(dst);
+		decode_eac(block, EAC_UNSIGNED11, dst);
+		decode_eac(block + 8, EAC_UNSIGNED11, dst + 1);
+		break;
+	case CODEC_EAC_RG11_SIGNED:
+		set_opaque_black(dst);
+		decode_eac(block, EAC_SIGNED11, dst);
+		decode_eac(block + 8, EAC_SIGNED11, dst + 1);
+		break;
+	}
+}
+
+void
+piglit_texcompress_encode_block(GLenum format, const float src[16 * 4],
+				void *dst)
+{
+	uint8_t *block = dst;
+
+	switch (get_codec(format)) {
+	case CODEC_NONE:
+		assert(!"unsupported compressed format");
+		break;
+	case CODEC_DXT1_RGB:
+		encode_dxt_color(src, false, false, block);
+		break;
+	case CODEC_DXT1_RGBA:
+		encode_dxt_color(src, false, true, block);
+		break;
+	case CODEC_DXT3:
+		encode_dxt3_alpha(src + 3, block);
+		encode_dxt_color(src, true, false, block + 8);
+		break;
+	case CODEC_DXT5:
+		encode_alpha(src + 3, false, block);
+		encode_dxt_color(src, true, false, block + 8);
+		break;
+	case CODEC_RGTC2:
+		encode_alpha(src + 1, false, block + 8);
+		/* fallthrough */
+	case CODEC_RGTC1:
+		encode_alpha(src, false, block);
+		break;
+	case CODEC_RGTC2_SIGNED:
+		encode_alpha(src + 1, true, block + 8);
+		/* fallthrough */
+	case CODEC_RGTC1_SIGNED:
+		encode_alpha(src, true, block);
+		break;
+	case CODEC_BPTC_UNORM:
+		encode_bptc_unorm(src, block);
+		break;
+	case CODEC_BPTC_FLOAT:
+		encode_bptc_float(src, false, block);
+		break;
+	case CODEC_BPTC_SIGNED_FLOAT:
+		encode_bptc_float(src, true, block);
+		break;
+	case CODEC_ETC2_RGB:
+		encode_etc2_rgb(src, false, block);
+		break;
+	case CODEC_ETC2_PUNCHTHROUGH:
+		encode_etc2_rgb(src, true, block);
+		break;
+	case CODEC_ETC2_EAC:
+		encode_eac(src + 3, EAC_ALPHA8, block);
+		encode_etc2_rgb(src, false, block + 8);
+		break;
+	case CODEC_EAC_RG11:
+		encode_eac(src + 1, EAC_UNSIGNED11, block + 8);
+		/* fallthrough */
+	case CODEC_EAC_R11:
+		encode_eac(src, EAC_UNSIGNED11, block);
+		break;
+	case CODEC_EAC_RG11_SIGNED:
+		encode_eac(src + 1, EAC_SIGNED11, block + 8);
+		/* fallthrough */
+	case CODEC_EAC_R11_SIGNED:
+		encode_eac(src, EAC_SIGNED11, block);
+		break;
+	}
+}
+
+/*
+ * Images.
+ */
+
+struct image_job {
+	GLenum format;
+	bool encode;
+	uint8_t *blocks;
+	float *texels;
+	unsigned width, height;
+	unsigned blocks_wide, blocks_high;
+	unsigned block_bytes;
+};
+
+static void
+process_block_row(void *data, unsigned row)
+{
+	const struct image_job *job = data;
+	float block[BLOCK_TEXELS * 4];
+	unsigned bx, x, y;
+
+	for (bx = 0; bx < job->blocks_wide; bx++) {
+		uint8_t *data = job->blocks +
+			(row * job->blocks_wide + bx) * job->block_bytes;
+
+		if (!job->encode)
+			piglit_texcompress_decode_block(job->format, data,
+							block);
+
+		for (y = 0; y < BLOCK_SIZE; y++) {
+			unsigned ty = row * BLOCK_SIZE + y;
+
+			for (x = 0; x < BLOCK_SIZE; x++) {
+				unsigned tx = bx * BLOCK_SIZE + x;
+				float *texel = block + (y * 4 + x) * 4;
+
+				if (job->encode) {
+					tx = MIN2(tx, job->width - 1);
+					ty = MIN2(ty, job->height - 1);
+					memcpy(texel,
+					       job->texels +
+					       ((size_t) ty * job->width + tx) * 4,
+					       4 * sizeof(float));
+				} else if (tx < job->width &&
+					   ty < job->height) {
+					memcpy(job->texels +
+					       ((size_t) ty * job->width + tx) * 4,
+					       texel, 4 * sizeof(float));
+				}
+			}
+		}
+
+		if (job->encode)
+			piglit_texcompress_encode_block(job->format, block,
+							data);
+	}
+}
+
+static void
+process_image(struct image_job *job)
+{
+	piglit_parallel_for(job->blocks_high, "PIGLIT_TEXCOMPRESS_THREADS",
+			    process_block_row, job);
+}
+
+static void
+init_job(struct image_job *job, GLenum format, bool encode,
+	 unsigned width, unsigned height)
+{
+	assert(piglit_texcompress_is_supported(format));
+
+	job->format = format;
+	job->encode = encode;
+	job->width = width;
+	job->height = height;
+	job->blocks_wide = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	job->blocks_high = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	job->block_bytes = piglit_texcompress_block_bytes(format);
+}
+
+void
+piglit_texcompress_decode(GLenum format, const void *src,
+			  unsigned width, unsigned height, float *dst)
+{
+	struct image_job job;
+
+	init_job(&job, format, false, width, height);
+	job.blocks = (uint8_t *) src;
+	job.texels = dst;
+	process_image(&job);
+}
+
+void
+piglit_texcompress_encode(GLenum format, const float *src,
+			  unsigned width, unsigned height, void *dst)
+{
+	struct image_job job;
+
+	init_job(&job, format, true, width, height);
+	job.blocks = dst;
+	job.texels = (float *) src;
+	process_image(&job);
+}
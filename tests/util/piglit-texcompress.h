@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Software codec for block-compressed texture formats.
+ *
+ * Decodes and encodes the 4x4 block formats of S3TC, RGTC, BPTC (unorm
+ * and float) and ETC1/ETC2/EAC, so tests can build compressed textures
+ * of any size together with the values the GL should return for them.
+ *
+ * Decoded texels are RGBA floats.  Components missing from a format are
+ * 0, except alpha which is 1.  Unsigned normalized formats give k / 255
+ * for 8-bit data and k / 65535 for EAC's 16-bit expansion, signed ones
+ * k / 127 and k / 32767, and the BPTC float formats give the exact value
+ * of the decoded half float.  sRGB formats are not converted to linear.
+ *
+ * The encoders aim for speed rather than quality: each format is
+ * encoded with a single, simple mode.  Whole images are split into rows
+ * of blocks that are processed in parallel.
+ */
+
+#ifndef PIGLIT_TEXCOMPRESS_H
+#define PIGLIT_TEXCOMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <piglit/gl_wrap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Width and height of a block, in texels. */
+#define PIGLIT_TEXCOMPRESS_BLOCK_SIZE 4
+
+/**
+ * Fields of a BPTC unorm block, in the order of the bitstream.
+ *
+ * Endpoints are stored per subset and per endpoint, without the p-bits,
+ * and indices are given in row-major texel order, anchor texels included.
+ */
+struct piglit_bptc_block {
+	int mode;
+	int partition;
+	int rotation;
+	int index_selection;
+	uint8_t endpoints[2 * 3][4];
+	uint8_t pbits[3 * 2];
+	uint8_t primary_indices[16];
+	uint8_t secondary_indices[16];
+};
+
+/**
+ * Fields of a BPTC float block.
+ *
+ * \c mode is the value of the 2 or 5 mode bits.  The endpoints are the
+ * raw values of the bitstream: for the modes with transformed endpoints,
+ * every endpoint but the first one is a delta.
+ */
+struct piglit_bptc_float_block {
+	int mode;
+	int partition;
+	uint16_t endpoints[2 * 2][3];
+	uint8_t indices[16];
+};
+
+/**
+ * Determine if \c format is handled by this codec.
+ */
+bool
+piglit_texcompress_is_supported(GLenum format);
+
+/**
+ * Size in bytes of one block of \c format.
+ */
+unsigned
+piglit_texcompress_block_bytes(GLenum format);
+
+/**
+ * Size in bytes of a \c width x \c height image of \c format.
+ */
+size_t
+piglit_texcompress_image_size(GLenum format, unsigned width, unsigned height);
+
+/**
+ * Decode one block to 16 RGBA texels in row-major order.
+ */
+void
+piglit_texcompress_decode_block(GLenum format, const void *src,
+				float dst[16 * 4]);
+
+/**
+ * Encode 16 RGBA texels in row-major order to one block.
+ */
+void
+piglit_texcompress_encode_block(GLenum format, const float src[16 * 4],
+				void *dst);
+
+/**
+ * Decode a whole image to \c width * \c height RGBA texels.
+ *
+ * The number of threads defaults to the number of online CPUs and can be
+ * set with the PIGLIT_TEXCOMPRESS_THREADS environment variable.
+ */
+void
+piglit_texcompress_decode(GLenum format, const void *src,
+			  unsigned width, unsigned height, float *dst);
+
+/**
+ * Encode \c width * \c height RGBA texels to a whole image.
+ *
+ * Partial blocks at the right and bottom edges are padded by repeating
+ * the last column and row.  Threads are used as in
+ * piglit_texcompress_decode().
+ */
+void
+piglit_texcompress_encode(GLenum format, const float *src,
+			  unsigned width, unsigned height, void *dst);
+
+/**
+ * Pack the fields of a BPTC unorm block into its 16 bytes.
+ */
+void
+piglit_bptc_pack_block(const struct piglit_bptc_block *block, void *out);
+
+/**
+ * Pack the fields of a BPTC float block into its 16 bytes.
+ */
+void
+piglit_bptc_float_pack_block(const struct piglit_bptc_float_block *block,
+			     void *out);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
+
+#endif /* PIGLIT_TEXCOMPRESS_H */
@@ -0,0 +1,236 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Startup-phase tracing, see piglit-trace.h.
+ */
+
+#include "piglit-util.h"
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#define MAX_EVENTS 256
+#define MAX_DEPTH 16
+
+struct trace_event {
+	const char *name;
+	int64_t begin;
+	int64_t end;
+};
+
+static struct {
+	bool initialized;
+	bool atexit_registered;
+	const char *path;
+
+	struct trace_event events[MAX_EVENTS];
+	unsigned num_events;
+
+	/** Indices in \c events of the open phases, innermost last. */
+	unsigned open[MAX_DEPTH];
+	unsigned depth;
+
+	/** Phases not recorded because the buffers were full. */
+	unsigned skipped;
+} trace;
+
+/**
+ * Return when the process was created, on the clock used by
+ * piglit_time_get_nano(), or 0 if it isn't known.
+ *
+ * Linux reports the start time in clock ticks since boot, usually 10 ms,
+ * which is good enough to see how long loading the test binary took.
+ */
+static int64_t
+process_start_time(void)
+{
+#if defined(__linux__) && defined(CLOCK_BOOTTIME)
+	char buf[1024];
+	unsigned long long start_ticks;
+	struct timespec boottime;
+	const char *p;
+	size_t len;
+	FILE *f;
+	int i;
+
+	f = fopen("/proc/self/stat", "r");
+	if (f == NULL)
+		return 0;
+	len = fread(buf, 1, sizeof(buf) - 1, f);
+	fclose(f);
+	buf[len] = '\0';
+
+	/* The command name may contain spaces, so count the fields from the
+	 * closing parenthesis.  The start time is field 22, the state after
+	 * the parenthesis is field 3.
+	 */
+	p = strrchr(buf, ')');
+	if (p == NULL)
+		return 0;
+	for (i = 2; i < 22; i++) {
+		p = strchr(p + 1, ' ');
+		if (p == NULL)
+			return 0;
+	}
+	if (sscanf(p, "%llu", &start_ticks) != 1)
+		return 0;
+
+	if (clock_gettime(CLOCK_BOOTTIME, &boottime) != 0)
+		return 0;
+
+	/* Convert from time since boot to the monotonic clock. */
+	return piglit_time_get_nano() -
+	       (boottime.tv_sec * INT64_C(1000000000) + boottime.tv_nsec) +
+	       (int64_t) start_ticks * INT64_C(1000000000) / sysconf(_SC_CLK_TCK);
+#else
+	return 0;
+#endif
+}
+
+static void
+write_event(FILE *f, const struct trace_event *event, int pid, bool first)
+{
+	fprintf(f, "%s\n{\"name\": \"%s\", \"cat\": \"piglit\", \"ph\": \"X\", "
+		"\"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, \"tid\": %d}",
+		first ? "" : ",", event->name,
+		event->begin / 1000.0, (event->end - event->begin) / 1000.0,
+		pid, pid);
+}
+
+static void
+write_trace(void)
+{
+	struct trace_event startup;
+	int64_t now = piglit_time_get_nano();
+	int pid = getpid();
+	unsigned i;
+	FILE *f;
+
+	if (trace.path == NULL)
+		return;
+
+	while (trace.depth > 0)
+		trace.events[trace.open[--trace.depth]].end = now;
+
+	f = fopen(trace.path, "w");
+	if (f == NULL) {
+		fprintf(stderr, "piglit: failed to write trace to %s\n",
+			trace.path);
+		return;
+	}
+
+	fprintf(f, "{\"traceEvents\": [");
+
+	/* From process creation to the first phase: loading the binary and
+	 * its libraries, and anything main() did before.
+	 */
+	startup.name = "process startup";
+	startup.begin = process_start_time();
+	startup.end = trace.num_events ? trace.events[0].begin : now;
+	if (startup.begin == 0 || startup.begin > startup.end)
+		startup.begin = startup.end;
+	write_event(f, &startup, pid, true);
+
+	for (i = 0; i < trace.num_events; i++)
+		write_event(f, &trace.events[i], pid, false);
+
+	fprintf(f, "\n]}\n");
+	fclose(f);
+}
+
+bool
+piglit_trace_enabled(void)
+{
+	if (!trace.initialized) {
+		const char *env = getenv("PIGLIT_TRACE");
+
+		trace.initialized = true;
+		if (env != NULL && env[0] != '\0') {
+			trace.path = env;
+			if (!trace.atexit_registered) {
+				atexit(write_trace);
+				trace.atexit_registered = true;
+			}
+		}
+	}
+
+	return trace.path != NULL;
+}
+
+void
+piglit_trace_reset(void)
+{
+	bool atexit_registered = trace.atexit_registered;
+
+	memset(&trace, 0, sizeof(trace));
+	trace.atexit_registered = atexit_registered;
+}
+
+void
+piglit_trace_begin(const char *name)
+{
+	struct trace_event *event;
+
+	if (!piglit_trace_enabled())
+		return;
+
+	/* Once full, drop the phase and everything nested in it. */
+	if (trace.skipped > 0 || trace.depth == MAX_DEPTH ||
+	    trace.num_events == MAX_EVENTS) {
+		trace.skipped++;
+		return;
+	}
+
+	event = &trace.events[trace.num_events];
+	event->name = name;
+	event->begin = piglit_time_get_nano();
+	event->end = event->begin;
+	trace.open[trace.depth++] = trace.num_events++;
+}
+
+void
+piglit_trace_end(void)
+{
+	if (!piglit_trace_enabled())
+		return;
+
+	if (trace.skipped > 0) {
+		trace.skipped--;
+		return;
+	}
+
+	if (trace.depth > 0)
+		trace.events[trace.open[--trace.depth]].end =
+			piglit_time_get_nano();
+}
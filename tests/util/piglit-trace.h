@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2026 The Piglit project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Startup-phase tracing.
+ *
+ * If the environment variable PIGLIT_TRACE names a file, each phase marked
+ * with piglit_trace_begin() and piglit_trace_end() is timestamped with
+ * piglit_time_get_nano(), and the phases are written to that file when the
+ * process exits, in the Chrome trace event format that chrome://tracing
+ * and Perfetto load.  Timestamps use the monotonic clock, so the traces of
+ * several processes can be merged into one timeline.
+ */
+
+#pragma once
+#ifndef PIGLIT_TRACE_H
+#define PIGLIT_TRACE_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Return true if PIGLIT_TRACE is set.
+ */
+bool
+piglit_trace_enabled(void);
+
+/**
+ * Start a phase named \a name, which must stay valid until the process
+ * exits.  Phases nest.
+ */
+void
+piglit_trace_begin(const char *name);
+
+/**
+ * End the innermost phase.  Phases still open at exit end there.
+ */
+void
+piglit_trace_end(void);
+
+/**
+ * Drop the phases recorded so far and read PIGLIT_TRACE again when next
+ * needed.  A test forked by the fork server starts from the server's
+ * state, which belongs to another environment.
+ */
+void
+piglit_trace_reset(void);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
+
+#endif /* PIGLIT_TRACE_H */
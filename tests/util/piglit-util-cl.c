@@ -23,6 +23,10 @@
 
 #include <inttypes.h>
 
+#ifdef PIGLIT_HAS_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "piglit-util-cl.h"
 
 bool
@@ -493,17 +497,103 @@ piglit_cl_get_event_profiling_info(cl_event event, cl_profiling_info param) {
 	return piglit_cl_get_info(clGetEventProfilingInfo, &event, param);
 }
 
-bool
-piglit_cl_is_platform_extension_supported(cl_platform_id platform,
-                                          const char *name)
+/*
+ * Extension sets of the platforms and devices queried so far.
+ *
+ * Platform and device extension lists don't change during a run, so each
+ * set is built once and kept until exit.  The lock is needed because
+ * per-device tests may run on worker threads.
+ */
+static struct {
+	unsigned count;
+	unsigned capacity;
+	const void **ids;
+	struct piglit_extension_set **sets;
+} extension_sets;
+
+#ifdef PIGLIT_HAS_PTHREADS
+static pthread_mutex_t extension_sets_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* Look \c id up, with extension_sets_lock held. */
+static struct piglit_extension_set *
+find_extension_set(const void *id)
+{
+	unsigned i;
+
+	for (i = 0; i < extension_sets.count; i++) {
+		if (extension_sets.ids[i] == id)
+			return extension_sets.sets[i];
+	}
+
+	return NULL;
+}
+
+static const struct piglit_extension_set *
+get_extension_set(const void *id, bool is_device)
 {
-	char* extensions = piglit_cl_get_platform_info(platform,
-	                                               CL_PLATFORM_EXTENSIONS);
-	bool supported = piglit_is_extension_in_string(extensions, name);
+	struct piglit_extension_set *set, *found;
+	char *extensions;
+
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_lock(&extension_sets_lock);
+#endif
+	set = find_extension_set(id);
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_unlock(&extension_sets_lock);
+#endif
 
+	if (set != NULL)
+		return set;
+
+	/*
+	 * Query without the lock: a failed query reports a result, which
+	 * on a worker thread unwinds out of the test.
+	 */
+	if (is_device) {
+		extensions = piglit_cl_get_device_info(
+			(cl_device_id)id, CL_DEVICE_EXTENSIONS);
+	} else {
+		extensions = piglit_cl_get_platform_info(
+			(cl_platform_id)id, CL_PLATFORM_EXTENSIONS);
+	}
+	set = piglit_extension_set_from_string(extensions);
 	free(extensions);
 
-	return supported;
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_lock(&extension_sets_lock);
+#endif
+	/* Another thread may have added it meanwhile. */
+	found = find_extension_set(id);
+	if (found != NULL) {
+		piglit_extension_set_destroy(set);
+		set = found;
+	} else {
+		if (extension_sets.count == extension_sets.capacity) {
+			extension_sets.capacity = extension_sets.capacity ?
+				2 * extension_sets.capacity : 8;
+			extension_sets.ids = realloc(extension_sets.ids,
+				extension_sets.capacity * sizeof(void*));
+			extension_sets.sets = realloc(extension_sets.sets,
+				extension_sets.capacity * sizeof(set));
+		}
+		extension_sets.ids[extension_sets.count] = id;
+		extension_sets.sets[extension_sets.count] = set;
+		extension_sets.count++;
+	}
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_unlock(&extension_sets_lock);
+#endif
+
+	return set;
+}
+
+bool
+piglit_cl_is_platform_extension_supported(cl_platform_id platform,
+                                          const char *name)
+{
+	return piglit_extension_set_contains(get_extension_set(platform, false),
+	                                     name);
 }
 
 void
@@ -528,12 +618,8 @@ piglit_cl_require_not_platform_extension(cl_platform_id platform,
 bool
 piglit_cl_is_device_extension_supported(cl_device_id device, const char *name)
 {
-	char* extensions = piglit_cl_get_device_info(device, CL_DEVICE_EXTENSIONS);
-	bool supported = piglit_is_extension_in_string(extensions, name);
-
-	free(extensions);
-
-	return supported;
+	return piglit_extension_set_contains(get_extension_set(device, true),
+	                                     name);
 }
 
 void
@@ -655,6 +741,235 @@ piglit_cl_get_device_ids(cl_platform_id platform_id, cl_device_type device_type,
 	return 0;
 }
 
+/* Event profiling */
+
+enum profile_category {
+	PROFILE_KERNEL,
+	PROFILE_WRITE,
+	PROFILE_READ,
+	PROFILE_CATEGORY_COUNT
+};
+
+static const char* const profile_category_names[PROFILE_CATEGORY_COUNT] = {
+	"cl_kernel",
+	"cl_write",
+	"cl_read",
+};
+
+/* Maximum number of unfinished events kept before waiting on them. */
+#define PROFILE_MAX_PENDING 1024
+
+static struct {
+	bool initialized;
+	bool enabled;
+
+	struct {
+		unsigned count;
+		uint64_t queue_ns;  /* queued -> submit */
+		uint64_t submit_ns; /* submit -> start */
+		uint64_t exec_ns;   /* start -> end */
+	} totals[PROFILE_CATEGORY_COUNT];
+
+	unsigned build_count;
+	uint64_t build_ns;
+
+	unsigned num_pending;
+	cl_event pending[PROFILE_MAX_PENDING];
+	enum profile_category pending_category[PROFILE_MAX_PENDING];
+} profiling;
+
+#ifdef PIGLIT_HAS_PTHREADS
+static pthread_once_t profiling_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t profiling_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void
+profiling_lock_acquire(void)
+{
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_lock(&profiling_lock);
+#endif
+}
+
+static void
+profiling_lock_release(void)
+{
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_unlock(&profiling_lock);
+#endif
+}
+
+static void
+profiling_init(void)
+{
+	const char *env = getenv("PIGLIT_CL_PROFILE");
+
+	profiling.enabled = env != NULL && env[0] != '\0' &&
+	                    strcmp(env, "0") != 0;
+	profiling.initialized = true;
+}
+
+static bool
+profiling_enabled(void)
+{
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_once(&profiling_once, profiling_init);
+#else
+	if (!profiling.initialized) {
+		profiling_init();
+	}
+#endif
+
+	return profiling.enabled;
+}
+
+/*
+ * Returns where an enqueue call should store its event: NULL unless
+ * profiling is enabled.
+ */
+static cl_event*
+profile_event_ptr(cl_event* event)
+{
+	*event = NULL;
+	return profiling_enabled() ? event : NULL;
+}
+
+/* Add the timestamps of a completed event to the totals and release it. */
+static void
+profile_accumulate(cl_event event, enum profile_category category)
+{
+	static const cl_profiling_info params[] = {
+		CL_PROFILING_COMMAND_QUEUED,
+		CL_PROFILING_COMMAND_SUBMIT,
+		CL_PROFILING_COMMAND_START,
+		CL_PROFILING_COMMAND_END,
+	};
+	cl_ulong t[ARRAY_SIZE(params)];
+	int i;
+
+	for(i = 0; i < ARRAY_SIZE(params); i++) {
+		/* Queues not created by piglit may lack profiling. */
+		if(clGetEventProfilingInfo(event, params[i], sizeof(cl_ulong),
+		                           &t[i], NULL) != CL_SUCCESS) {
+			clReleaseEvent(event);
+			return;
+		}
+	}
+	clReleaseEvent(event);
+
+	profiling_lock_acquire();
+	profiling.totals[category].count++;
+	profiling.totals[category].queue_ns += t[1] - t[0];
+	profiling.totals[category].submit_ns += t[2] - t[1];
+	profiling.totals[category].exec_ns += t[3] - t[2];
+	profiling_lock_release();
+}
+
+/* Wait for all pending events and add them to the totals. */
+static void
+profile_flush_pending(void)
+{
+	cl_event events[PROFILE_MAX_PENDING];
+	enum profile_category categories[PROFILE_MAX_PENDING];
+	unsigned num_events;
+	unsigned i;
+
+	profiling_lock_acquire();
+	num_events = profiling.num_pending;
+	memcpy(events, profiling.pending, num_events * sizeof(cl_event));
+	memcpy(categories, profiling.pending_category,
+	       num_events * sizeof(enum profile_category));
+	profiling.num_pending = 0;
+	profiling_lock_release();
+
+	for(i = 0; i < num_events; i++) {
+		if(clWaitForEvents(1, &events[i]) == CL_SUCCESS) {
+			profile_accumulate(events[i], categories[i]);
+		} else {
+			clReleaseEvent(events[i]);
+		}
+	}
+}
+
+/* Record an event of a command that may still be running. */
+static void
+profile_add_pending(cl_event event, enum profile_category category)
+{
+	if(event == NULL) {
+		return;
+	}
+
+	/*
+	 * Make room before inserting, other threads may fill the buffer
+	 * again while this one waits on the flushed events.
+	 */
+	profiling_lock_acquire();
+	while(profiling.num_pending == PROFILE_MAX_PENDING) {
+		profiling_lock_release();
+		profile_flush_pending();
+		profiling_lock_acquire();
+	}
+	profiling.pending[profiling.num_pending] = event;
+	profiling.pending_category[profiling.num_pending] = category;
+	profiling.num_pending++;
+	profiling_lock_release();
+}
+
+/* Record an event of a command that has already completed. */
+static void
+profile_add_completed(cl_event event, enum profile_category category)
+{
+	if(event != NULL) {
+		profile_accumulate(event, category);
+	}
+}
+
+static int64_t
+profile_build_begin(void)
+{
+	return profiling_enabled() ? piglit_time_get_nano() : 0;
+}
+
+static void
+profile_build_end(int64_t begin)
+{
+	if(!profiling_enabled()) {
+		return;
+	}
+
+	profiling_lock_acquire();
+	profiling.build_count++;
+	profiling.build_ns += piglit_time_get_nano() - begin;
+	profiling_lock_release();
+}
+
+void
+piglit_cl_report_profiling(void)
+{
+	int i;
+
+	if(!profiling_enabled()) {
+		return;
+	}
+
+	profile_flush_pending();
+
+	printf("PIGLIT: {\"profile\": {"
+	       "\"cl_build\": {\"count\": %u, \"time_ns\": %"PRIu64"}",
+	       profiling.build_count, profiling.build_ns);
+	for(i = 0; i < PROFILE_CATEGORY_COUNT; i++) {
+		printf(", \"%s\": {\"count\": %u, \"queue_ns\": %"PRIu64", "
+		       "\"submit_ns\": %"PRIu64", \"exec_ns\": %"PRIu64"}",
+		       profile_category_names[i],
+		       profiling.totals[i].count,
+		       profiling.totals[i].queue_ns,
+		       profiling.totals[i].submit_ns,
+		       profiling.totals[i].exec_ns);
+	}
+	printf("}}\n");
+	fflush(stdout);
+}
+
 piglit_cl_context
 piglit_cl_create_context(cl_platform_id platform_id,
                          const cl_device_id device_ids[],
@@ -664,6 +979,8 @@ piglit_cl_create_context(cl_platform_id platform_id,
 
 	int i;
 	cl_int errNo;
+	cl_command_queue_properties queue_properties =
+		profiling_enabled() ? CL_QUEUE_PROFILING_ENABLE : 0;
 	cl_context_properties cl_ctx_properties[] = {
 		CL_CONTEXT_PLATFORM, (cl_context_properties)platform_id,
 		0
@@ -698,7 +1015,7 @@ piglit_cl_create_context(cl_platform_id platform_id,
 	for(i = 0; i < num_devices; i++) {
 		context->command_queues[i] = clCreateCommandQueue(context->cl_ctx,
 		                                                  context->device_ids[i],
-		                                                  0,
+		                                                  queue_properties,
 		                                                  &errNo);
 		if(errNo != CL_SUCCESS) {
 			clReleaseContext(context->cl_ctx);
@@ -742,6 +1059,351 @@ piglit_cl_release_context(piglit_cl_context context)
 	free(context);
 }
 
+/* Program binary cache */
+
+static struct {
+	bool initialized;
+	const char *dir;
+	unsigned hits;
+	unsigned misses;
+	unsigned rejected;
+	unsigned stored;
+} program_cache;
+
+#ifdef PIGLIT_HAS_PTHREADS
+static pthread_once_t program_cache_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t program_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void
+program_cache_init(void)
+{
+	const char *env = getenv("PIGLIT_CL_PROGRAM_CACHE");
+
+	program_cache.dir = (env != NULL && env[0] != '\0') ? env : NULL;
+	program_cache.initialized = true;
+}
+
+static const char *
+program_cache_dir(void)
+{
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_once(&program_cache_once, program_cache_init);
+#else
+	if (!program_cache.initialized) {
+		program_cache_init();
+	}
+#endif
+
+	return program_cache.dir;
+}
+
+/* Bump one of the statistics, which worker threads share. */
+static void
+program_cache_count(unsigned *counter)
+{
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_lock(&program_cache_lock);
+#endif
+	(*counter)++;
+#ifdef PIGLIT_HAS_PTHREADS
+	pthread_mutex_unlock(&program_cache_lock);
+#endif
+}
+
+/* 64-bit FNV-1a, fed incrementally. */
+static uint64_t
+program_cache_hash(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= UINT64_C(0x100000001b3);
+	}
+
+	return hash;
+}
+
+static uint64_t
+program_cache_hash_string(uint64_t hash, const char *s)
+{
+	/* Include the terminator so that adjacent strings can't alias. */
+	return program_cache_hash(hash, s != NULL ? s : "", s != NULL ? strlen(s) + 1 : 1);
+}
+
+/*
+ * The key covers everything that can change the binary: the sources,
+ * the build options and the identity of every device and driver the
+ * program is built for.
+ */
+static uint64_t
+program_cache_key(piglit_cl_context context, cl_uint count, char** strings,
+                  const char* options)
+{
+	static const cl_device_info device_params[] = {
+		CL_DEVICE_NAME,
+		CL_DEVICE_VENDOR,
+		CL_DEVICE_VERSION,
+		CL_DRIVER_VERSION,
+	};
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+	char* platform_version;
+	int i, j;
+
+	for(i = 0; i < count; i++) {
+		hash = program_cache_hash_string(hash, strings[i]);
+	}
+	hash = program_cache_hash_string(hash, options);
+
+	platform_version = piglit_cl_get_platform_info(context->platform_id,
+	                                               CL_PLATFORM_VERSION);
+	hash = program_cache_hash_string(hash, platform_version);
+	free(platform_version);
+
+	for(i = 0; i < context->num_devices; i++) {
+		for(j = 0; j < ARRAY_SIZE(device_params); j++) {
+			char* value = piglit_cl_get_device_info(context->device_ids[i],
+			                                        device_params[j]);
+			hash = program_cache_hash_string(hash, value);
+			free(value);
+		}
+	}
+
+	return hash;
+}
+
+static void
+program_cache_path(char *buf, size_t buf_size, uint64_t key)
+{
+	char name[32];
+
+	snprintf(name, sizeof(name), "%016"PRIx64".clbin", key);
+	piglit_join_paths(buf, buf_size, 2, program_cache.dir, name);
+}
+
+/*
+ * Cache file layout: magic, device count, then for every device the
+ * binary size followed by the binary itself.
+ */
+static const uint32_t program_cache_magic = 0x6e696263; /* "cbin" */
+
+static bool
+program_cache_load(piglit_cl_context context, uint64_t key,
+                   size_t* lengths, unsigned char** binaries)
+{
+	char path[4096];
+	FILE* f;
+	uint32_t magic, num_devices;
+	int i;
+	bool success = false;
+
+	program_cache_path(path, sizeof(path), key);
+	f = fopen(path, "rb");
+	if(f == NULL) {
+		return false;
+	}
+
+	memset(binaries, 0, context->num_devices * sizeof(unsigned char*));
+
+	if(   fread(&magic, sizeof(magic), 1, f) != 1
+	   || fread(&num_devices, sizeof(num_devices), 1, f) != 1
+	   || magic != program_cache_magic
+	   || num_devices != context->num_devices) {
+		goto out;
+	}
+
+	for(i = 0; i < context->num_devices; i++) {
+		uint64_t length;
+
+		if(fread(&length, sizeof(length), 1, f) != 1 || length == 0) {
+			goto out;
+		}
+
+		lengths[i] = length;
+		binaries[i] = malloc(length);
+		if(   binaries[i] == NULL
+		   || fread(binaries[i], 1, length, f) != length) {
+			goto out;
+		}
+	}
+
+	success = true;
+
+out:
+	fclose(f);
+	if(!success) {
+		for(i = 0; i < context->num_devices; i++) {
+			free(binaries[i]);
+			binaries[i] = NULL;
+		}
+	}
+	return success;
+}
+
+static void
+program_cache_store(piglit_cl_context context, uint64_t key,
+                    cl_program program)
+{
+	char path[4096];
+	char tmp_path[4096];
+	size_t* lengths;
+	unsigned char** binaries;
+	uint32_t header[2] = { program_cache_magic, context->num_devices };
+	cl_int errNo;
+	FILE* f;
+	int i;
+	bool success = false;
+
+	lengths = piglit_cl_get_program_info(program, CL_PROGRAM_BINARY_SIZES);
+	if(lengths == NULL) {
+		return;
+	}
+
+	binaries = calloc(context->num_devices, sizeof(unsigned char*));
+	if(binaries == NULL) {
+		free(lengths);
+		return;
+	}
+	for(i = 0; i < context->num_devices; i++) {
+		/* Some implementations don't provide binaries at all. */
+		if(lengths[i] == 0) {
+			goto out;
+		}
+		binaries[i] = malloc(lengths[i]);
+		if(binaries[i] == NULL) {
+			goto out;
+		}
+	}
+
+	errNo = clGetProgramInfo(program,
+	                         CL_PROGRAM_BINARIES,
+	                         context->num_devices * sizeof(unsigned char*),
+	                         binaries,
+	                         NULL);
+	if(errNo != CL_SUCCESS) {
+		goto out;
+	}
+
+	/*
+	 * Write to a unique temporary file and rename it into place, so
+	 * that concurrent tests never see a partially written binary.
+	 */
+	program_cache_path(path, sizeof(path), key);
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%"PRIx64".tmp",
+	         path, (uint64_t)piglit_time_get_nano());
+
+	f = fopen(tmp_path, "wb");
+	if(f == NULL) {
+		goto out;
+	}
+
+	success = fwrite(header, sizeof(header), 1, f) == 1;
+	for(i = 0; success && i < context->num_devices; i++) {
+		uint64_t length = lengths[i];
+
+		success = fwrite(&length, sizeof(length), 1, f) == 1 &&
+		          fwrite(binaries[i], 1, lengths[i], f) == lengths[i];
+	}
+
+	if(fclose(f) != 0 || !success || rename(tmp_path, path) != 0) {
+		remove(tmp_path);
+		success = false;
+	}
+
+out:
+	if(success) {
+		program_cache_count(&program_cache.stored);
+	}
+	for(i = 0; i < context->num_devices; i++) {
+		free(binaries[i]);
+	}
+	free(binaries);
+	free(lengths);
+}
+
+/*
+ * Quietly build a program from cached binaries.  Unlike
+ * piglit_cl_build_program_with_binary() a rejected binary is not an
+ * error, the caller just falls back to building from source.
+ */
+static cl_program
+program_cache_build(piglit_cl_context context, size_t* lengths,
+                    unsigned char** binaries, const char* options)
+{
+	cl_int errNo;
+	cl_program program;
+	int64_t build_begin;
+	cl_int* binary_status = malloc(sizeof(cl_int) * context->num_devices);
+
+	program = clCreateProgramWithBinary(context->cl_ctx,
+	                                    context->num_devices,
+	                                    context->device_ids,
+	                                    lengths,
+	                                    (const unsigned char**)binaries,
+	                                    binary_status,
+	                                    &errNo);
+	free(binary_status);
+	if(errNo != CL_SUCCESS) {
+		return NULL;
+	}
+
+	build_begin = profile_build_begin();
+	errNo = clBuildProgram(program,
+	                       context->num_devices,
+	                       context->device_ids,
+	                       options,
+	                       NULL,
+	                       NULL);
+	profile_build_end(build_begin);
+	if(errNo != CL_SUCCESS) {
+		clReleaseProgram(program);
+		return NULL;
+	}
+
+	return program;
+}
+
+static cl_program
+program_cache_lookup(piglit_cl_context context, uint64_t key,
+                     const char* options)
+{
+	cl_program program = NULL;
+	size_t* lengths = malloc(context->num_devices * sizeof(size_t));
+	unsigned char** binaries =
+		malloc(context->num_devices * sizeof(unsigned char*));
+	int i;
+
+	if(lengths != NULL && binaries != NULL &&
+	   program_cache_load(context, key, lengths, binaries)) {
+		program = program_cache_build(context, lengths, binaries, options);
+		if(program == NULL) {
+			program_cache_count(&program_cache.rejected);
+		}
+
+		for(i = 0; i < context->num_devices; i++) {
+			free(binaries[i]);
+		}
+	}
+
+	free(binaries);
+	free(lengths);
+	return program;
+}
+
+void
+piglit_cl_print_program_cache_stats(void)
+{
+	if(program_cache_dir() == NULL) {
+		return;
+	}
+
+	printf("# Program cache: %u hits, %u misses, %u rejected, %u stored\n",
+	       program_cache.hits, program_cache.misses,
+	       program_cache.rejected, program_cache.stored);
+}
+
 cl_program
 piglit_cl_build_program_with_source_extended(piglit_cl_context context,
                                              cl_uint count, char** strings,
@@ -749,6 +1411,25 @@ piglit_cl_build_program_with_source_extended(piglit_cl_context context,
 {
 	cl_int errNo;
 	cl_program program;
+	int64_t build_begin;
+	uint64_t cache_key = 0;
+	/*
+	 * Kernel argument info is only kept for programs built from
+	 * source, so those must not come from the cache.
+	 */
+	bool use_cache = !fail && program_cache_dir() != NULL &&
+	                 (options == NULL ||
+	                  strstr(options, "-cl-kernel-arg-info") == NULL);
+
+	if(use_cache) {
+		cache_key = program_cache_key(context, count, strings, options);
+		program = program_cache_lookup(context, cache_key, options);
+		if(program != NULL) {
+			program_cache_count(&program_cache.hits);
+			return program;
+		}
+		program_cache_count(&program_cache.misses);
+	}
 
 	program = clCreateProgramWithSource(context->cl_ctx,
 	                                    count,
@@ -762,12 +1443,14 @@ piglit_cl_build_program_with_source_extended(piglit_cl_context context,
 		return NULL;
 	}
 	
+	build_begin = profile_build_begin();
 	errNo = clBuildProgram(program,
 	                       context->num_devices,
 	                       context->device_ids,
 	                       options,
 	                       NULL,
 	                       NULL);
+	profile_build_end(build_begin);
 	if(   (!fail && errNo != CL_SUCCESS)
 	   || ( fail && errNo == CL_SUCCESS)) {
 		int i;
@@ -801,6 +1484,10 @@ piglit_cl_build_program_with_source_extended(piglit_cl_context context,
 		return NULL;
 	}
 
+	if(use_cache) {
+		program_cache_store(context, cache_key, program);
+	}
+
 	return program;
 }
 
@@ -827,6 +1514,7 @@ piglit_cl_build_program_with_binary_extended(piglit_cl_context context,
 {
 	cl_int errNo;
 	cl_program program;
+	int64_t build_begin;
 
 	cl_int* binary_status = malloc(sizeof(cl_int) * context->num_devices);
 
@@ -861,12 +1549,14 @@ piglit_cl_build_program_with_binary_extended(piglit_cl_context context,
 	}
 	free(binary_status);
 	
+	build_begin = profile_build_begin();
 	errNo = clBuildProgram(program,
 	                       context->num_devices,
 	                       context->device_ids,
 	                       options,
 	                       NULL,
 	                       NULL);
+	profile_build_end(build_begin);
 	if(   (!fail && errNo != CL_SUCCESS)
 	   || ( fail && errNo == CL_SUCCESS)) {
 		int i;
@@ -943,9 +1633,10 @@ piglit_cl_write_buffer(cl_command_queue command_queue, cl_mem buffer,
                        size_t offset, size_t cb, const void *ptr)
 {
 	cl_int errNo;
+	cl_event event;
 
 	errNo = clEnqueueWriteBuffer(command_queue, buffer, CL_TRUE, offset, cb,
-	                             ptr, 0, NULL, NULL);
+	                             ptr, 0, NULL, profile_event_ptr(&event));
 	if(!piglit_cl_check_error(errNo, CL_SUCCESS)) {
 		fprintf(stderr,
 		        "Could not enqueue buffer write: %s\n",
@@ -953,6 +1644,8 @@ piglit_cl_write_buffer(cl_command_queue command_queue, cl_mem buffer,
 		return false;
 	}
 
+	profile_add_completed(event, PROFILE_WRITE);
+
 	return true;
 }
 
@@ -976,9 +1669,10 @@ piglit_cl_read_buffer(cl_command_queue command_queue, cl_mem buffer,
                       size_t offset, size_t cb, void *ptr)
 {
 	cl_int errNo;
+	cl_event event;
 
 	errNo = clEnqueueReadBuffer(command_queue, buffer, CL_TRUE, offset, cb, ptr,
-	                            0, NULL, NULL);
+	                            0, NULL, profile_event_ptr(&event));
 	if(!piglit_cl_check_error(errNo, CL_SUCCESS)) {
 		fprintf(stderr,
 		        "Could not enqueue buffer read: %s\n",
@@ -986,6 +1680,8 @@ piglit_cl_read_buffer(cl_command_queue command_queue, cl_mem buffer,
 		return false;
 	}
 
+	profile_add_completed(event, PROFILE_READ);
+
 	return true;
 }
 
@@ -1042,9 +1738,10 @@ piglit_cl_write_image(cl_command_queue command_queue, cl_mem image,
                       const void *ptr)
 {
 	cl_int errNo;
+	cl_event event;
 
 	errNo = clEnqueueWriteImage(command_queue, image, CL_TRUE, origin, region,
-	                            0, 0, ptr, 0, NULL, NULL);
+	                            0, 0, ptr, 0, NULL, profile_event_ptr(&event));
 	if(!piglit_cl_check_error(errNo, CL_SUCCESS)) {
 		fprintf(stderr,
 		        "Could not enqueue image write: %s\n",
@@ -1052,6 +1749,8 @@ piglit_cl_write_image(cl_command_queue command_queue, cl_mem image,
 		return false;
 	}
 
+	profile_add_completed(event, PROFILE_WRITE);
+
 	return true;
 }
 
@@ -1126,9 +1825,10 @@ piglit_cl_read_image(cl_command_queue command_queue, cl_mem image,
                      void *ptr)
 {
 	cl_int errNo;
+	cl_event event;
 
 	errNo = clEnqueueReadImage(command_queue, image, CL_TRUE, origin, region,
-	                           0, 0, ptr, 0, NULL, NULL);
+	                           0, 0, ptr, 0, NULL, profile_event_ptr(&event));
 	if(!piglit_cl_check_error(errNo, CL_SUCCESS)) {
 		fprintf(stderr,
 		        "Could not enqueue image read: %s\n",
@@ -1136,6 +1836,8 @@ piglit_cl_read_image(cl_command_queue command_queue, cl_mem image,
 		return false;
 	}
 
+	profile_add_completed(event, PROFILE_READ);
+
 	return true;
 }
 
@@ -1233,10 +1935,11 @@ piglit_cl_enqueue_ND_range_kernel(cl_command_queue command_queue,
                                   const size_t* local_work_size)
 {
 	cl_int errNo;
+	cl_event event;
 
 	errNo = clEnqueueNDRangeKernel(command_queue, kernel, work_dim,
 	                               NULL, global_work_size, local_work_size,
-	                               0, NULL, NULL);
+	                               0, NULL, profile_event_ptr(&event));
 	if(!piglit_cl_check_error(errNo, CL_SUCCESS)) {
 		fprintf(stderr,
 		        "Could not enqueue ND range kernel: %s\n",
@@ -1244,6 +1947,8 @@ piglit_cl_enqueue_ND_range_kernel(cl_command_queue command_queue,
 		return false;
 	}
 
+	profile_add_pending(event, PROFILE_KERNEL);
+
 	return true;
 }
 
@@ -1278,9 +1983,10 @@ bool
 piglit_cl_enqueue_task(cl_command_queue command_queue, cl_kernel kernel)
 {
 	cl_int errNo;
+	cl_event event;
 
 	errNo = clEnqueueTask(command_queue, kernel,
-	                      0, NULL, NULL);
+	                      0, NULL, profile_event_ptr(&event));
 	if(!piglit_cl_check_error(errNo, CL_SUCCESS)) {
 		fprintf(stderr,
 		        "Could not enqueue task: %s\n",
@@ -1288,6 +1994,8 @@ piglit_cl_enqueue_task(cl_command_queue command_queue, cl_kernel kernel)
 		return false;
 	}
 
+	profile_add_pending(event, PROFILE_KERNEL);
+
 	return true;
 }
 
@@ -355,6 +355,10 @@ typedef struct _piglit_cl_context* piglit_cl_context;
  * Create a helper context from platform id \c platform_id and
  * device ids \c device_ids.
  *
+ * If the \c PIGLIT_CL_PROFILE environment variable is set, the command
+ * queues are created with \c CL_QUEUE_PROFILING_ENABLE and the enqueue
+ * helpers below collect the timestamps of every command they enqueue.
+ *
  * @param context      Context struct to fill.
  * @param platform_id  Platform from which to create context.
  * @param device_ids   Device ids to add to context.
@@ -383,6 +387,12 @@ piglit_cl_release_context(piglit_cl_context context);
  * Create and build a program with source for all devices in
  * \c piglit_cl_context.
  *
+ * If the \c PIGLIT_CL_PROGRAM_CACHE environment variable names a
+ * directory, program binaries are cached there, keyed on the source,
+ * the build options and the platform, device and driver versions.  On a
+ * cache hit the program is built from the cached binaries instead, and
+ * if the implementation rejects them it is rebuilt from source.
+ *
  * @param context      Context on which to create and build program.
  * @param count        Number of strings in \c strings.
  * @param string       Array of pointers to NULL-terminated source strings.
@@ -449,6 +459,26 @@ piglit_cl_fail_build_program_with_binary(piglit_cl_context context,
                                          unsigned char** binaries,
                                          const char* options);
 
+/**
+ * \brief Print program binary cache statistics.
+ *
+ * Does nothing if the cache is disabled.
+ */
+void
+piglit_cl_print_program_cache_stats(void);
+
+/**
+ * \brief Report collected profiling information.
+ *
+ * Waits for all profiled commands and prints the total queue, submit and
+ * execution times per kind of command, and the total program build time,
+ * as a \c profile entry of the test result.
+ *
+ * Does nothing if profiling is disabled.
+ */
+void
+piglit_cl_report_profiling(void);
+
 /**
  * \brief Create a buffer.
  *
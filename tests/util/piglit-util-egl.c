@@ -131,11 +131,27 @@ piglit_egl_get_default_display(EGLenum platform)
 	return peglGetPlatformDisplayEXT(platform, EGL_DEFAULT_DISPLAY, NULL);
 }
 
+/**
+ * The extension set of the display last queried.
+ *
+ * The extensions of a display don't change, so the set is rebuilt only
+ * when another display is queried.  The string eglQueryString() returned
+ * is not a key: it may be freed and its address reused.
+ */
+static struct {
+	EGLDisplay dpy;
+	struct piglit_extension_set *set;
+} egl_extensions;
+
 bool
 piglit_is_egl_extension_supported(EGLDisplay egl_dpy, const char *name)
 {
-	const char *const egl_extension_list =
-		eglQueryString(egl_dpy, EGL_EXTENSIONS);
+	const char *egl_extension_list;
+
+	if (egl_extensions.set != NULL && egl_extensions.dpy == egl_dpy)
+		return piglit_extension_set_contains(egl_extensions.set, name);
+
+	egl_extension_list = eglQueryString(egl_dpy, EGL_EXTENSIONS);
 
 	/*
 	 * If EGL does not support EGL_EXT_client_extensions, then
@@ -147,7 +163,19 @@ piglit_is_egl_extension_supported(EGLDisplay egl_dpy, const char *name)
 			piglit_check_egl_error(EGL_BAD_DISPLAY))
 		return false;
 
-	return piglit_is_extension_in_string(egl_extension_list, name);
+	/*
+	 * A display that isn't initialized yet has no extension string.
+	 * Don't cache that: the display gains its extensions once it's
+	 * initialized.
+	 */
+	if (!egl_extension_list)
+		return false;
+
+	piglit_extension_set_destroy(egl_extensions.set);
+	egl_extensions.set = piglit_extension_set_from_string(egl_extension_list);
+	egl_extensions.dpy = egl_dpy;
+
+	return piglit_extension_set_contains(egl_extensions.set, name);
 }
 
 void piglit_require_egl_extension(EGLDisplay dpy, const char *name)
@@ -22,18 +22,18 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-ref-volume.h"
 #include <ctype.h>
 
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
 
 /**
- * An array of pointers to extension strings.
+ * The extensions supported by the current context.
  *
- * Each extension is pointed to by a separate entry in the array.
- *
- * The end of the array is indicated by a NULL pointer.
+ * Built on the first query and dropped by
+ * piglit_gl_reinitialize_extensions().
  */
-static const char **gl_extensions = NULL;
+static struct piglit_extension_set *gl_extensions = NULL;
 
 static const float color_wheel[4][4] = {
 	{1, 0, 0, 1}, /* red */
@@ -71,15 +71,16 @@ int piglit_get_gl_version(void)
 	return 10*major+minor;
 }
 
-static const char** gl_extension_array_from_getstring()
+static struct piglit_extension_set *gl_extension_set_from_getstring()
 {
 	const char *gl_extensions_string;
 	gl_extensions_string = (const char *) glGetString(GL_EXTENSIONS);
-	return piglit_split_string_to_array(gl_extensions_string, " ");
+	return piglit_extension_set_from_string(gl_extensions_string);
 }
 
-static const char** gl_extension_array_from_getstringi()
+static struct piglit_extension_set *gl_extension_set_from_getstringi()
 {
+	struct piglit_extension_set *set;
 	const char **strings;
 	int loop, num_extensions;
 
@@ -93,7 +94,9 @@ static const char** gl_extension_array_from_getstringi()
 
 	strings[loop] = NULL;
 
-	return (const char**) strings;
+	set = piglit_extension_set_from_array(strings);
+	free(strings);
+	return set;
 }
 
 static void initialize_piglit_extension_support(void)
@@ -102,25 +105,25 @@ static void initialize_piglit_extension_support(void)
 		return;
 	}
 
+	piglit_trace_begin("extension list");
 	if (piglit_get_gl_version() < 30) {
-		gl_extensions = gl_extension_array_from_getstring();
+		gl_extensions = gl_extension_set_from_getstring();
 	} else {
-		gl_extensions = gl_extension_array_from_getstringi();
+		gl_extensions = gl_extension_set_from_getstringi();
 	}
+	piglit_trace_end();
 }
 
 void piglit_gl_reinitialize_extensions()
 {
-	if (gl_extensions != NULL) {
-		free(gl_extensions);
-		gl_extensions = NULL;
-	}
+	piglit_extension_set_destroy(gl_extensions);
+	gl_extensions = NULL;
 }
 
 bool piglit_is_extension_supported(const char *name)
 {
 	initialize_piglit_extension_support();
-	return piglit_is_extension_in_array(gl_extensions, name);
+	return piglit_extension_set_contains(gl_extensions, name);
 }
 
 void piglit_require_gl_version(int required_version_times_10)
@@ -408,7 +411,8 @@ piglit_probe_rect_halves_equal_rgba(int x, int y, int w, int h)
 
 			for (p = 0; p < 4; ++p) {
 				if (fabs(probe1[p] - probe2[p]) >= piglit_tolerance[p]) {
-					printf("Probe color at (%i,%i)\n", x+i, x+j);
+					piglit_report_probe_failure("Probe color at (%i,%i)\n",
+					                            x+i, x+j);
 					printf("  Left: %f %f %f %f\n",
 					       probe1[0], probe1[1], probe1[2], probe1[3]);
 					printf("  Right: %f %f %f %f\n",
@@ -1121,7 +1125,7 @@ piglit_probe_pixel_rgb(int x, int y, const float* expected)
 	if (pass)
 		return 1;
 
-	printf("Probe color at (%i,%i)\n", x, y);
+	piglit_report_probe_failure("Probe color at (%i,%i)\n", x, y);
 	printf("  Expected: %f %f %f\n", expected[0], expected[1], expected[2]);
 	printf("  Observed: %f %f %f\n", probe[0], probe[1], probe[2]);
 
@@ -1151,7 +1155,7 @@ piglit_probe_pixel_rgba(int x, int y, const float* expected)
 	if (pass)
 		return 1;
 
-	printf("Probe color at (%i,%i)\n", x, y);
+	piglit_report_probe_failure("Probe color at (%i,%i)\n", x, y);
 	printf("  Expected: %f %f %f %f\n", expected[0], expected[1], expected[2], expected[3]);
 	printf("  Observed: %f %f %f %f\n", probe[0], probe[1], probe[2], probe[3]);
 
@@ -1202,7 +1206,8 @@ piglit_probe_rect_r_ubyte(int x, int y, int w, int h, GLubyte expected)
 			GLubyte probe = pixels[j*w_aligned+i];
 
 			if (abs((int)probe - (int)expected) >= tolerance) {
-				printf("Probe color at (%i,%i)\n", x+i, y+j);
+				piglit_report_probe_failure("Probe color at (%i,%i)\n",
+				                            x+i, y+j);
 				printf("  Expected: %u\n", expected);
 				printf("  Observed: %u\n", probe);
 
@@ -1231,7 +1236,8 @@ piglit_probe_rect_rgb(int x, int y, int w, int h, const float *expected)
 
 			for (p = 0; p < 3; ++p) {
 				if (fabs(probe[p] - expected[p]) >= piglit_tolerance[p]) {
-					printf("Probe color at (%i,%i)\n", x+i, y+j);
+					piglit_report_probe_failure("Probe color at (%i,%i)\n",
+					                            x+i, y+j);
 					printf("  Expected: %f %f %f\n",
 					       expected[0], expected[1], expected[2]);
 					printf("  Observed: %f %f %f\n",
@@ -1298,7 +1304,8 @@ piglit_probe_rect_rgba(int x, int y, int w, int h, const float *expected)
 
 			for (p = 0; p < 4; ++p) {
 				if (fabs(probe[p] - expected[p]) >= piglit_tolerance[p]) {
-					printf("Probe color at (%i,%i)\n", x+i, y+j);
+					piglit_report_probe_failure("Probe color at (%i,%i)\n",
+					                            x+i, y+j);
 					printf("  Expected: %f %f %f %f\n",
 					       expected[0], expected[1], expected[2], expected[3]);
 					printf("  Observed: %f %f %f %f\n",
@@ -1330,7 +1337,8 @@ piglit_probe_rect_rgba_int(int x, int y, int w, int h, const int *expected)
 
 			for (p = 0; p < 4; ++p) {
 				if (abs(probe[p] - expected[p]) >= piglit_tolerance[p]) {
-					printf("Probe color at (%d,%d)\n", x+i, y+j);
+					piglit_report_probe_failure("Probe color at (%d,%d)\n",
+					                            x+i, y+j);
 					printf("  Expected: %d %d %d %d\n",
 					       expected[0], expected[1], expected[2], expected[3]);
 					printf("  Observed: %d %d %d %d\n",
@@ -1363,7 +1371,8 @@ piglit_probe_rect_rgba_uint(int x, int y, int w, int h,
 
 			for (p = 0; p < 4; ++p) {
 				if (abs((int) (probe[p] - expected[p])) >= piglit_tolerance[p]) {
-					printf("Probe color at (%d,%d)\n", x+i, y+j);
+					piglit_report_probe_failure("Probe color at (%d,%d)\n",
+					                            x+i, y+j);
 					printf("  Expected: %u %u %u %u\n",
 					       expected[0], expected[1], expected[2], expected[3]);
 					printf("  Observed: %u %u %u %u\n",
@@ -1428,7 +1437,7 @@ piglit_compare_pixels(int x, int y, const float *expected, const float *probe,
 
 	for (p = 0; p < num_components; ++p) {
 		if (fabs(probe[p] - expected[p]) >= tolerance[p]) {
-			printf("Probe at (%i,%i)\n", x, y);
+			piglit_report_probe_failure("Probe at (%i,%i)\n", x, y);
 			printf("  Expected:");
 			print_pixel_float(expected, num_components);
 			printf("\n  Observed:");
@@ -1486,7 +1495,8 @@ piglit_compare_images_color(int x, int y, int w, int h, int num_components,
 			for (p = 0; p < num_components; ++p) {
 				if (fabs(probe[p] - expected[p])
 				    >= tolerance[p]) {
-					printf("Probe at (%i,%i)\n", x+i, y+j);
+					piglit_report_probe_failure("Probe at (%i,%i)\n",
+					                            x+i, y+j);
 					printf("  Expected:");
 					print_pixel_float(expected, num_components);
 					printf("\n  Observed:");
@@ -1560,7 +1570,8 @@ piglit_compare_images_ubyte(int x, int y, int w, int h,
 			const GLubyte probe = observed_image[j*w+i];
 
 			if (probe != expected) {
-				printf("Probe at (%i,%i)\n", x+i, y+j);
+				piglit_report_probe_failure("Probe at (%i,%i)\n",
+				                            x+i, y+j);
 				printf("  Expected: %d\n", expected);
 				printf("  Observed: %d\n", probe);
 
@@ -1588,48 +1599,19 @@ piglit_equal_images_update_rgba8(const GLubyte *expected_original,
 				 unsigned uw, unsigned uh, unsigned ud,
 				 unsigned bits)
 {
-	assert(bits > 0 && bits <= 8);
-
-	unsigned x, y, z;
-	const uint8_t compare_mask = 0xff << (8 - bits);
-
-	for (z = 0; z < d; ++z) {
-		for (y = 0; y < h; y++) {
-			for (x = 0; x < w; x++) {
-				const GLubyte *ref;
-
-				if (x >= ux && x < ux + uw &&
-				    y >= uy && y < uy + uh &&
-				    z >= uz && z < uz + ud)
-					ref = expected_updated;
-				else
-					ref = expected_original;
-
-				bool fail =
-					((ref[0] ^ observed[0]) |
-					 (ref[1] ^ observed[1]) |
-					 (ref[2] ^ observed[2]) |
-					 (ref[3] ^ observed[3])) &
-					compare_mask;
-				if (fail) {
-					printf("%u,%u,%u: test = %u,%u,%u,%u "
-						"ref = %u,%u,%u,%u (comparing %u bits)\n",
-						x, y, z,
-						observed[0], observed[1],
-						observed[2], observed[3],
-						ref[0], ref[1], ref[2], ref[3],
-						bits);
-					return 0;
-				}
+	const struct piglit_ref_volume_box box = { ux, uy, uz, uw, uh, ud };
+	struct piglit_ref_volume *vol =
+		piglit_ref_volume_create(PIGLIT_REF_VOLUME_RGBA8,
+					 w, h, d, expected_original);
+	bool pass;
 
-				observed += 4;
-				expected_original += 4;
-				expected_updated += 4;
-			}
-		}
-	}
+	/* The volume only wraps the images, nothing is copied. */
+	piglit_ref_volume_set_bits(vol, bits);
+	pass = piglit_ref_volume_compare_update(vol, expected_updated, &box,
+						observed);
+	piglit_ref_volume_destroy(vol);
 
-	return 1;
+	return pass;
 }
 
 /**
@@ -1679,7 +1661,8 @@ piglit_probe_image_ubyte(int x, int y, int w, int h, GLenum format,
 				if (probe[p] == expected[p])
 					continue;
 
-				printf("Probe at (%i,%i)\n", x + i, y + j);
+				piglit_report_probe_failure("Probe at (%i,%i)\n",
+				                            x + i, y + j);
 				printf("  Expected:");
 				print_pixel_ubyte(expected, c);
 				printf("\n  Observed:");
@@ -1729,7 +1712,8 @@ int piglit_probe_texel_rect_rgb(int target, int level, int x, int y,
 
 			for (p = 0; p < 3; ++p) {
 				if (fabs(probe[p] - expected[p]) >= piglit_tolerance[p]) {
-					printf("Probe color at (%i,%i)\n", i, j);
+					piglit_report_probe_failure("Probe color at (%i,%i)\n",
+					                            i, j);
 					printf("  Expected: %f %f %f\n",
 					       expected[0], expected[1], expected[2]);
 					printf("  Observed: %f %f %f\n",
@@ -1792,7 +1776,8 @@ int piglit_probe_texel_rect_rgba(int target, int level, int x, int y,
 
 			for (p = 0; p < 4; ++p) {
 				if (fabs(probe[p] - expected[p]) >= piglit_tolerance[p]) {
-					printf("Probe color at (%i,%i)\n", i, j);
+					piglit_report_probe_failure("Probe color at (%i,%i)\n",
+					                            i, j);
 					printf("  Expected: %f %f %f %f\n",
 					       expected[0], expected[1], expected[2], expected[3]);
 					printf("  Observed: %f %f %f %f\n",
@@ -1861,7 +1846,8 @@ int piglit_probe_texel_volume_rgba(int target, int level, int x, int y, int z,
 
 				for (p = 0; p < 4; ++p) {
 					if (fabs(probe[p] - expected[p]) >= piglit_tolerance[p]) {
-						printf("Probe color at (%i,%i,%i)\n", i, j, k);
+						piglit_report_probe_failure("Probe color at (%i,%i,%i)\n",
+						                            i, j, k);
 						printf("  Expected: %f %f %f %f\n",
 						       expected[0], expected[1], expected[2], expected[3]);
 						printf("  Observed: %f %f %f %f\n",
@@ -1897,7 +1883,7 @@ int piglit_probe_pixel_depth(int x, int y, float expected)
 	if (fabs(delta) < 0.01)
 		return 1;
 
-	printf("Probe depth at (%i,%i)\n", x, y);
+	piglit_report_probe_failure("Probe depth at (%i,%i)\n", x, y);
 	printf("  Expected: %f\n", expected);
 	printf("  Observed: %f\n", probe);
 
@@ -1917,7 +1903,8 @@ int piglit_probe_rect_depth(int x, int y, int w, int h, float expected)
 			probe = &pixels[j*w+i];
 
 			if (fabs(*probe - expected) >= 0.01) {
-				printf("Probe depth at (%i,%i)\n", x+i, y+j);
+				piglit_report_probe_failure("Probe depth at (%i,%i)\n",
+				                            x+i, y+j);
 				printf("  Expected: %f\n", expected);
 				printf("  Observed: %f\n", *probe);
 
@@ -1939,7 +1926,7 @@ int piglit_probe_pixel_stencil(int x, int y, unsigned expected)
 	if (probe == expected)
 		return 1;
 
-	printf("Probe stencil at (%i, %i)\n", x, y);
+	piglit_report_probe_failure("Probe stencil at (%i, %i)\n", x, y);
 	printf("  Expected: %u\n", expected);
 	printf("  Observed: %u\n", probe);
 
@@ -1957,7 +1944,8 @@ int piglit_probe_rect_stencil(int x, int y, int w, int h, unsigned expected)
 		for (i = 0; i < w; i++) {
 			GLuint probe = pixels[j * w + i];
 			if (probe != expected) {
-				printf("Probe stencil at (%i, %i)\n", x + i, y + j);
+				piglit_report_probe_failure("Probe stencil at (%i, %i)\n",
+				                            x + i, y + j);
 				printf("  Expected: %u\n", expected);
 				printf("  Observed: %u\n", probe);
 				free(pixels);
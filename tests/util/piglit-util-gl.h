@@ -322,6 +322,35 @@ void
 piglit_write_png(const char *filename, GLenum base_format,
                  int width, int height, GLubyte *data, bool flip_y);
 
+void
+piglit_write_pnm(const char *filename, GLenum base_format,
+                 int width, int height, GLubyte *data, bool flip_y);
+
+/**
+ * Write an image dump named \c name plus an extension.
+ *
+ * The file format and compression come from the PIGLIT_DUMP_*
+ * environment variables, see piglit-util-png.c.  The image is written
+ * on a background thread where possible.  \c data must come from
+ * malloc(), and is freed once the image is written.
+ */
+void
+piglit_dump_image(const char *name, GLenum base_format,
+                  int width, int height, GLubyte *data, bool flip_y);
+
+/**
+ * Return true if piglit_dump_image() writes on a background thread.
+ */
+bool
+piglit_dump_image_is_async(void);
+
+/**
+ * Wait until all images passed to piglit_dump_image() are written.  This
+ * also runs at exit.
+ */
+void
+piglit_dump_image_flush(void);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
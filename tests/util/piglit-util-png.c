@@ -22,18 +22,26 @@
  * IN THE SOFTWARE.
  */
 
+#include <inttypes.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef PIGLIT_HAS_PNG
 #include <png.h>
 #endif
+#if defined(PIGLIT_HAS_PTHREADS) && !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#define DUMP_USE_THREAD
+#endif
 
-#include <piglit/gl_wrap.h>
+#include "piglit-util-gl.h"
 
 #define aborts(s) _abortf("piglit_write_png: %s", s)
-#define abortf(s, ...) _abortf("piglit_write_png" s, __VA_ARGS__)
+#define abortf(s, ...) _abortf("piglit_write_png: " s, __VA_ARGS__)
 static void
 _abortf(const char *s, ...)
 {
@@ -45,6 +53,72 @@ _abortf(const char *s, ...)
 	abort();
 }
 
+enum dump_format {
+	DUMP_PNG,
+	DUMP_PNM,
+};
+
+/**
+ * Image dump settings, read from the environment once:
+ *
+ * PIGLIT_DUMP_FORMAT: "png" (default if libpng is available) or "pnm",
+ *     which writes uncompressed PPM (RGB) or PAM (RGBA) files.
+ * PIGLIT_DUMP_PNG_LEVEL: zlib level 0-9, or "fast" for level 1 with no
+ *     row filtering.  The libpng default is used if unset.
+ * PIGLIT_DUMP_DIR: if set, images are named after a hash of their
+ *     contents and stored in this directory, so identical images from
+ *     different tests are written once.
+ * PIGLIT_DUMP_SYNC: if set to 1, piglit_dump_image() writes before
+ *     returning instead of on a background thread.
+ */
+static struct {
+	bool initialized;
+	enum dump_format format;
+	int png_level;
+	bool png_fast;
+	const char *dir;
+	bool sync;
+} dump_config;
+
+static void
+dump_config_init(void)
+{
+	const char *env;
+
+	if (dump_config.initialized)
+		return;
+	dump_config.initialized = true;
+
+#ifdef PIGLIT_HAS_PNG
+	dump_config.format = DUMP_PNG;
+#else
+	dump_config.format = DUMP_PNM;
+#endif
+	env = getenv("PIGLIT_DUMP_FORMAT");
+	if (env && strcmp(env, "pnm") == 0)
+		dump_config.format = DUMP_PNM;
+	else if (env && strcmp(env, "png") == 0)
+		dump_config.format = DUMP_PNG;
+
+	dump_config.png_level = -1;
+	env = getenv("PIGLIT_DUMP_PNG_LEVEL");
+	if (env && strcmp(env, "fast") == 0) {
+		dump_config.png_level = 1;
+		dump_config.png_fast = true;
+	} else if (env && env[0] >= '0' && env[0] <= '9') {
+		dump_config.png_level = atoi(env);
+		if (dump_config.png_level > 9)
+			dump_config.png_level = 9;
+	}
+
+	env = getenv("PIGLIT_DUMP_DIR");
+	if (env && env[0] != '\0')
+		dump_config.dir = env;
+
+	env = getenv("PIGLIT_DUMP_SYNC");
+	dump_config.sync = env && strcmp(env, "1") == 0;
+}
+
 /* Write a PNG file.
  *
  * \param filename    The filename to write (i.e. "foo.png")
@@ -112,6 +186,12 @@ piglit_write_png(const char *filename,
 		     8, color_type, PNG_INTERLACE_NONE,
 		     PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
 
+	dump_config_init();
+	if (dump_config.png_level >= 0)
+		png_set_compression_level(png, dump_config.png_level);
+	if (dump_config.png_fast)
+		png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+
 	png_write_info(png, info);
 
 	if (flip_y) {
@@ -133,3 +213,300 @@ piglit_write_png(const char *filename,
 	fclose(fp);
 #endif
 }
+
+/* Write a binary PPM (for GL_RGB) or PAM (for GL_RGBA) file.
+ *
+ * Takes the same parameters as piglit_write_png().
+ */
+void
+piglit_write_pnm(const char *filename,
+		 GLenum base_format,
+		 int width,
+		 int height,
+		 GLubyte *data,
+		 bool flip_y)
+{
+	FILE *fp;
+	int bytes;
+	int y;
+
+	switch (base_format) {
+	case GL_RGBA:
+		bytes = 4;
+		break;
+	case GL_RGB:
+		bytes = 3;
+		break;
+	default:
+		abortf("unknown format %04x", base_format);
+		return;
+	}
+
+	fp = fopen(filename, "wb");
+	if (!fp)
+		abortf("failed to open `%s'", filename);
+
+	if (bytes == 3)
+		fprintf(fp, "P6\n%d %d\n255\n", width, height);
+	else
+		fprintf(fp, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\n"
+			"TUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+
+	for (y = 0; y < height; ++y) {
+		int row = flip_y ? height - 1 - y : y;
+		fwrite(data + (size_t)row * width * bytes, bytes, width, fp);
+	}
+
+	if (fclose(fp) != 0)
+		abortf("failed to write `%s'", filename);
+}
+
+struct dump_job {
+	char *filename;
+	/** If set, \c filename is renamed to this once it's written. */
+	char *final_path;
+	GLenum base_format;
+	int width;
+	int height;
+	GLubyte *data;
+	bool flip_y;
+	struct dump_job *next;
+};
+
+static void
+dump_job_run(struct dump_job *job)
+{
+	if (dump_config.format == DUMP_PNG)
+		piglit_write_png(job->filename, job->base_format, job->width,
+				 job->height, job->data, job->flip_y);
+	else
+		piglit_write_pnm(job->filename, job->base_format, job->width,
+				 job->height, job->data, job->flip_y);
+
+	/* Another process may have stored the same image meanwhile; its
+	 * copy is identical, so losing the race is fine.
+	 */
+	if (job->final_path && rename(job->filename, job->final_path) != 0)
+		remove(job->filename);
+
+	free(job->final_path);
+	free(job->filename);
+	free(job->data);
+	free(job);
+}
+
+#ifdef DUMP_USE_THREAD
+/* Jobs waiting for the writer thread.  At most DUMP_MAX_PENDING are
+ * queued; piglit_dump_image() waits when the queue is full so that
+ * memory use stays bounded.
+ */
+#define DUMP_MAX_PENDING 4
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+	bool started;
+	struct dump_job *head, *tail;
+	unsigned pending;
+	bool busy;
+} dump_queue = {
+	PTHREAD_MUTEX_INITIALIZER,
+	PTHREAD_COND_INITIALIZER,
+};
+
+static void *
+dump_thread(void *arg)
+{
+	(void) arg;
+
+	pthread_mutex_lock(&dump_queue.lock);
+	while (true) {
+		struct dump_job *job;
+
+		while (dump_queue.head == NULL)
+			pthread_cond_wait(&dump_queue.cond, &dump_queue.lock);
+
+		job = dump_queue.head;
+		dump_queue.head = job->next;
+		if (dump_queue.head == NULL)
+			dump_queue.tail = NULL;
+		dump_queue.busy = true;
+		pthread_mutex_unlock(&dump_queue.lock);
+
+		dump_job_run(job);
+
+		pthread_mutex_lock(&dump_queue.lock);
+		dump_queue.busy = false;
+		dump_queue.pending--;
+		pthread_cond_broadcast(&dump_queue.cond);
+	}
+
+	return NULL;
+}
+
+static void
+dump_queue_push(struct dump_job *job)
+{
+	pthread_mutex_lock(&dump_queue.lock);
+
+	if (!dump_queue.started) {
+		if (pthread_create(&dump_queue.thread, NULL, dump_thread,
+				   NULL) != 0) {
+			pthread_mutex_unlock(&dump_queue.lock);
+			dump_job_run(job);
+			return;
+		}
+		pthread_detach(dump_queue.thread);
+		atexit(piglit_dump_image_flush);
+		dump_queue.started = true;
+	}
+
+	while (dump_queue.pending >= DUMP_MAX_PENDING)
+		pthread_cond_wait(&dump_queue.cond, &dump_queue.lock);
+
+	job->next = NULL;
+	if (dump_queue.tail)
+		dump_queue.tail->next = job;
+	else
+		dump_queue.head = job;
+	dump_queue.tail = job;
+	dump_queue.pending++;
+
+	pthread_cond_broadcast(&dump_queue.cond);
+	pthread_mutex_unlock(&dump_queue.lock);
+}
+#endif
+
+bool
+piglit_dump_image_is_async(void)
+{
+#ifdef DUMP_USE_THREAD
+	dump_config_init();
+	return !dump_config.sync;
+#else
+	return false;
+#endif
+}
+
+void
+piglit_dump_image_flush(void)
+{
+#ifdef DUMP_USE_THREAD
+	pthread_mutex_lock(&dump_queue.lock);
+	while (dump_queue.pending > 0)
+		pthread_cond_wait(&dump_queue.cond, &dump_queue.lock);
+	pthread_mutex_unlock(&dump_queue.lock);
+#endif
+}
+
+static uint64_t
+dump_hash(const void *data, size_t size, uint64_t h)
+{
+	const uint8_t *p = data;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		h ^= p[i];
+		h *= UINT64_C(0x100000001b3);
+	}
+	return h;
+}
+
+/**
+ * Record \c hash as dumped.  Returns false if it already was.
+ *
+ * This catches repeats within the process whose first copy may still be
+ * queued; file_exists() catches the ones from earlier runs.
+ */
+static bool
+dump_hash_insert(uint64_t hash)
+{
+	static uint64_t *hashes;
+	static unsigned count, capacity;
+	unsigned i;
+
+	for (i = 0; i < count; i++)
+		if (hashes[i] == hash)
+			return false;
+
+	if (count == capacity) {
+		capacity = capacity ? 2 * capacity : 16;
+		hashes = realloc(hashes, capacity * sizeof(*hashes));
+	}
+	hashes[count++] = hash;
+	return true;
+}
+
+static bool
+file_exists(const char *filename)
+{
+	FILE *fp = fopen(filename, "rb");
+
+	if (fp == NULL)
+		return false;
+	fclose(fp);
+	return true;
+}
+
+void
+piglit_dump_image(const char *name, GLenum base_format, int width, int height,
+		  GLubyte *data, bool flip_y)
+{
+	const char *ext;
+	struct dump_job *job;
+	int bytes = base_format == GL_RGBA ? 4 : 3;
+
+	dump_config_init();
+
+	if (dump_config.format == DUMP_PNG)
+		ext = "png";
+	else
+		ext = bytes == 4 ? "pam" : "ppm";
+
+	if (dump_config.dir) {
+		uint64_t h = UINT64_C(0xcbf29ce484222325);
+		int header[4] = { base_format, width, height, flip_y };
+		char *filename;
+
+		h = dump_hash(header, sizeof(header), h);
+		h = dump_hash(data, (size_t)width * height * bytes, h);
+		asprintf(&filename, "%s/%016" PRIx64 ".%s",
+			 dump_config.dir, h, ext);
+
+		printf("Writing %s (%s)...\n", filename, name);
+		if (!dump_hash_insert(h) || file_exists(filename)) {
+			free(filename);
+			free(data);
+			return;
+		}
+
+		/*
+		 * Write to a unique temporary file and rename it into place,
+		 * so that concurrent tests dumping the same image don't
+		 * interleave and a partial file never looks stored.
+		 */
+		job = calloc(1, sizeof(*job));
+		job->final_path = filename;
+		asprintf(&job->filename, "%s.%" PRIx64 ".tmp",
+			 filename, (uint64_t)piglit_time_get_nano());
+	} else {
+		job = calloc(1, sizeof(*job));
+		asprintf(&job->filename, "%s.%s", name, ext);
+		printf("Writing %s...\n", job->filename);
+	}
+
+	job->base_format = base_format;
+	job->width = width;
+	job->height = height;
+	job->data = data;
+	job->flip_y = flip_y;
+
+#ifdef DUMP_USE_THREAD
+	if (!dump_config.sync) {
+		dump_queue_push(job);
+		return;
+	}
+#endif
+	dump_job_run(job);
+}
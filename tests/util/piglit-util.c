@@ -66,6 +66,26 @@
 # define USE_STDIO
 #endif
 
+#if !defined(_WIN32)
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#define USE_SUBTEST_PROCESSES
+#define USE_RESULT_CHANNEL
+#endif
+
+#if defined(PIGLIT_HAS_PTHREADS) && !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#define USE_PARALLEL_FOR
+#define USE_THREAD_RESULT_SINK
+#endif
+
+#if defined(HAVE_EXECINFO_H) && defined(PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD)
+#include <execinfo.h>
+#define USE_WATCHDOG_BACKTRACE
+#endif
+
 #include "piglit-util.h"
 
 
@@ -221,6 +241,165 @@ bool piglit_is_extension_in_string(const char *haystack, const char *needle)
 	return false;
 }
 
+/**
+ * A set of extension names with constant-time lookup.
+ *
+ * The names are copied into one buffer and indexed by an open-addressed
+ * hash table of at least twice the number of names.
+ */
+struct piglit_extension_set {
+	char *buffer;
+	const char **names;
+	unsigned count;
+	unsigned mask;
+	int *slots;
+};
+
+static uint32_t
+extension_set_hash(const char *name, size_t len)
+{
+	uint32_t h = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		h ^= (uint8_t) name[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/**
+ * Find the slot holding \c name, or the empty slot where it would go.
+ */
+static int *
+extension_set_find_slot(const struct piglit_extension_set *set,
+			const char *name, size_t len)
+{
+	unsigned i = extension_set_hash(name, len) & set->mask;
+
+	while (set->slots[i] >= 0) {
+		const char *entry = set->names[set->slots[i]];
+
+		if (strncmp(entry, name, len) == 0 && entry[len] == '\0')
+			break;
+		i = (i + 1) & set->mask;
+	}
+	return &set->slots[i];
+}
+
+static struct piglit_extension_set *
+extension_set_create(unsigned max_count, size_t buffer_size)
+{
+	struct piglit_extension_set *set = calloc(1, sizeof(*set));
+	unsigned size = 16;
+	unsigned i;
+
+	while (size < 2 * max_count)
+		size *= 2;
+
+	set->buffer = malloc(buffer_size + 1);
+	set->names = malloc(sizeof(*set->names) * (max_count + 1));
+	set->slots = malloc(sizeof(*set->slots) * size);
+	assert(set->buffer && set->names && set->slots);
+
+	set->mask = size - 1;
+	for (i = 0; i < size; i++)
+		set->slots[i] = -1;
+
+	return set;
+}
+
+/**
+ * Add the first \c len characters of \c name to the set.
+ *
+ * \c tail points to the unused part of the set's buffer and is advanced
+ * past the copy.  Duplicate names are ignored.
+ */
+static void
+extension_set_add(struct piglit_extension_set *set, char **tail,
+		  const char *name, size_t len)
+{
+	int *slot;
+
+	if (len == 0)
+		return;
+
+	slot = extension_set_find_slot(set, name, len);
+	if (*slot >= 0)
+		return;
+
+	memcpy(*tail, name, len);
+	(*tail)[len] = '\0';
+	set->names[set->count] = *tail;
+	*slot = set->count++;
+	*tail += len + 1;
+}
+
+struct piglit_extension_set *
+piglit_extension_set_from_string(const char *string)
+{
+	struct piglit_extension_set *set;
+	size_t length = string ? strlen(string) : 0;
+	char *tail;
+	const char *p;
+
+	set = extension_set_create(length / 2 + 1, length);
+	tail = set->buffer;
+
+	for (p = string; p && *p; ) {
+		size_t len = strcspn(p, " ");
+
+		extension_set_add(set, &tail, p, len);
+		p += len;
+		p += strspn(p, " ");
+	}
+
+	set->names[set->count] = NULL;
+	return set;
+}
+
+struct piglit_extension_set *
+piglit_extension_set_from_array(const char **array)
+{
+	struct piglit_extension_set *set;
+	size_t buffer_size = 0;
+	unsigned count;
+	char *tail;
+
+	for (count = 0; array[count] != NULL; count++)
+		buffer_size += strlen(array[count]) + 1;
+
+	set = extension_set_create(count, buffer_size);
+	tail = set->buffer;
+
+	for (count = 0; array[count] != NULL; count++)
+		extension_set_add(set, &tail, array[count],
+				  strlen(array[count]));
+
+	set->names[set->count] = NULL;
+	return set;
+}
+
+bool
+piglit_extension_set_contains(const struct piglit_extension_set *set,
+			      const char *name)
+{
+	return set != NULL &&
+	       *extension_set_find_slot(set, name, strlen(name)) >= 0;
+}
+
+void
+piglit_extension_set_destroy(struct piglit_extension_set *set)
+{
+	if (set == NULL)
+		return;
+
+	free(set->buffer);
+	free(set->names);
+	free(set->slots);
+	free(set);
+}
+
 /** Returns the line in the program string given the character position. */
 int piglit_find_line(const char *program, int position)
 {
@@ -246,14 +425,101 @@ piglit_result_to_string(enum piglit_result result)
         return "Unknown result";
 }
 
+#ifdef USE_RESULT_CHANNEL
+/** The result channel from PIGLIT_RESULT_FD, or -1 if there is none. */
+static int
+result_channel_fd(void)
+{
+	static int fd = -2;
+
+	if (fd == -2) {
+		const char *env = getenv("PIGLIT_RESULT_FD");
+
+		fd = env ? atoi(env) : -1;
+	}
+	return fd;
+}
+#endif
+
+static void
+write_record(enum piglit_record_type type, enum piglit_result result,
+	     int64_t value, const char *text, size_t text_len)
+{
+#ifdef USE_RESULT_CHANNEL
+	char record[PIGLIT_RECORD_MAX];
+	struct piglit_record_header header;
+	int fd = result_channel_fd();
+
+	if (fd < 0)
+		return;
+
+	text_len = MIN2(text_len, sizeof(record) - sizeof(header));
+
+	memset(&header, 0, sizeof(header));
+	header.type = type;
+	header.result = result;
+	header.size = text_len;
+	header.value = value;
+	memcpy(record, &header, sizeof(header));
+	memcpy(record + sizeof(header), text, text_len);
+
+	/* The runner still has stdout if the channel breaks. */
+	if (write(fd, record, sizeof(header) + text_len) < 0)
+		piglit_logd("Result channel: %s", strerror(errno));
+#endif
+}
+
+/** The subtest piglit_run_selected_subtests() is in, for the watchdog */
+static const char *volatile running_subtest;
+
+#ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
+/* Ensure we only report one result in case we race with the watchdog */
+static pthread_mutex_t result_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#ifdef USE_THREAD_RESULT_SINK
+static pthread_key_t result_sink_key;
+static pthread_once_t result_sink_once = PTHREAD_ONCE_INIT;
+
+static void
+create_result_sink_key(void)
+{
+	pthread_key_create(&result_sink_key, NULL);
+}
+#endif
+
+void
+piglit_set_thread_result_sink(const struct piglit_result_sink *sink)
+{
+#ifdef USE_THREAD_RESULT_SINK
+	pthread_once(&result_sink_once, create_result_sink_key);
+	pthread_setspecific(result_sink_key, sink);
+#endif
+}
+
+static const struct piglit_result_sink *
+thread_result_sink(void)
+{
+#ifdef USE_THREAD_RESULT_SINK
+	pthread_once(&result_sink_once, create_result_sink_key);
+	return pthread_getspecific(result_sink_key);
+#else
+	return NULL;
+#endif
+}
+
 void
 piglit_report_result(enum piglit_result result)
 {
 	const char *result_str = piglit_result_to_string(result);
+	const struct piglit_result_sink *sink = thread_result_sink();
+
+	if (sink) {
+		sink->result(sink->data, result);
+		abort();
+	}
 
 #ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
-	/* Ensure we only report one result in case we race with timeout */
-	static pthread_mutex_t result_lock = PTHREAD_MUTEX_INITIALIZER;
 	pthread_mutex_lock(&result_lock);
 #endif
 
@@ -261,6 +527,7 @@ piglit_report_result(enum piglit_result result)
 
 	printf("PIGLIT: {\"result\": \"%s\" }\n", result_str);
 	fflush(stdout);
+	write_record(PIGLIT_RECORD_RESULT, result, 0, NULL, 0);
 
 	switch(result) {
 	case PIGLIT_PASS:
@@ -273,51 +540,282 @@ piglit_report_result(enum piglit_result result)
 }
 
 #ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
+/**
+ * Seconds before the runner's deadline at which the watchdog fires, so the
+ * test can still print its backtrace and result before it gets killed.
+ */
+#define WATCHDOG_MARGIN 0.5
+
+/** When the watchdog fires, in CLOCK_REALTIME seconds, 0 when unarmed */
+static double watchdog_time;
+static timer_t watchdog_timer;
+/** The thread that armed the watchdog, normally the one running the test */
+static pthread_t watchdog_thread;
+
+#ifdef USE_WATCHDOG_BACKTRACE
+static volatile sig_atomic_t watchdog_backtrace_done;
+
 static void
-timeout_expired(union sigval val)
+print_watchdog_backtrace(int sig)
 {
-	piglit_loge("Test timed out.");
-	piglit_report_result(val.sival_int);
+	static const char header[] = "Backtrace at the deadline:\n";
+	void *frames[64];
+	int count = backtrace(frames, ARRAY_SIZE(frames));
+
+	/* Only async-signal-safe calls here, stdio may be locked. */
+	if (write(STDERR_FILENO, header, sizeof(header) - 1) > 0)
+		backtrace_symbols_fd(frames, count, STDERR_FILENO);
+	watchdog_backtrace_done = 1;
 }
 #endif
 
-void
-piglit_set_timeout(double seconds, enum piglit_result timeout_result)
+/**
+ * Flush \p f unless another thread holds it, which may be forever if that
+ * thread is the stuck test.
+ */
+static void
+flush_unless_locked(FILE *f)
+{
+	if (ftrylockfile(f) == 0) {
+		fflush(f);
+		funlockfile(f);
+	}
+}
+
+static void
+timeout_expired(union sigval val)
+{
+	static const char message[] = "piglit: error: Test timed out.\n";
+	char report[PIGLIT_RECORD_MAX];
+	const char *name;
+	int len;
+
+	if (val.sival_int >= 0) {
+		piglit_loge("Test timed out.");
+		piglit_report_result(val.sival_int);
+	}
+
+	/* This thread must not wait for a lock the test's thread may hold
+	 * forever, so the report goes out with write().  If the test is
+	 * reporting its result right now, that result stands.
+	 */
+	if (pthread_mutex_trylock(&result_lock) != 0)
+		return;
+
+	flush_unless_locked(stdout);
+	flush_unless_locked(stderr);
+	if (write(STDOUT_FILENO, message, sizeof(message) - 1) < 0)
+		return;
+
+#ifdef USE_WATCHDOG_BACKTRACE
+	/* The stack worth seeing is the test's, not the one of this timer
+	 * thread, so have the test's thread print its own.  A thread stuck
+	 * with the signal blocked gets a moment, then is left alone.
+	 */
+	if (pthread_kill(watchdog_thread, SIGRTMIN) == 0) {
+		const struct timespec step = { 0, 10 * 1000 * 1000 };
+		int i;
+
+		for (i = 0; i < 50 && !watchdog_backtrace_done; i++)
+			nanosleep(&step, NULL);
+	}
+#endif
+
+	/* Finished subtests are already reported, only the one that got
+	 * stuck and the overall result are missing.  Skip the exit handlers:
+	 * the test's thread may hold locks they need.
+	 */
+	name = running_subtest;
+	if (name) {
+		len = snprintf(report, sizeof(report),
+			       "PIGLIT: {\"subtest\": {\"%s\" : \"timeout\"}}\n"
+			       "PIGLIT: {\"result\": \"timeout\" }\n", name);
+	} else {
+		len = snprintf(report, sizeof(report),
+			       "PIGLIT: {\"result\": \"timeout\" }\n");
+	}
+	if (len > 0 && write(STDOUT_FILENO, report,
+			     MIN2((size_t) len, sizeof(report) - 1)) < 0)
+		piglit_logd("Cannot report the timeout");
+	write_record(PIGLIT_RECORD_TIMEOUT, PIGLIT_FAIL, 0,
+		     name ? name : "", name ? strlen(name) : 0);
+	_exit(1);
+}
+
+/**
+ * Arm the watchdog to fire at \p when, in CLOCK_REALTIME seconds, unless it
+ * is already armed to fire earlier.  It reports \p result, or a timeout if
+ * that is -1.
+ */
+static void
+arm_watchdog(double when, int result)
 {
-#ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
 	struct sigevent sev = {
 		.sigev_notify = SIGEV_THREAD,
 		.sigev_notify_function = timeout_expired,
-		.sigev_value = { .sival_int = timeout_result },
 	};
-	time_t sec = seconds;
+	time_t sec = when;
 	struct itimerspec spec = {
-		.it_value = { .tv_sec = sec, .tv_nsec = (seconds - sec) * 1e9 },
+		.it_value = { .tv_sec = sec, .tv_nsec = (when - sec) * 1e9 },
 	};
-	timer_t timerid;
-	timer_create(CLOCK_MONOTONIC, &sev, &timerid);
-	timer_settime(timerid, 0, &spec, NULL);
+
+	if (watchdog_time != 0 && watchdog_time <= when)
+		return;
+
+	if (watchdog_time != 0) {
+		timer_delete(watchdog_timer);
+	} else {
+#ifdef USE_WATCHDOG_BACKTRACE
+		void *frame;
+		struct sigaction sa;
+
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = print_watchdog_backtrace;
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGRTMIN, &sa, NULL);
+
+		/* The first backtrace() loads libgcc, which isn't safe to
+		 * do in a signal handler.
+		 */
+		backtrace(&frame, 1);
+#endif
+		watchdog_thread = pthread_self();
+	}
+
+	sev.sigev_value.sival_int = result;
+	if (timer_create(CLOCK_REALTIME, &sev, &watchdog_timer) != 0) {
+		piglit_logi("Cannot abort this test for timeout: %s",
+			    strerror(errno));
+		watchdog_time = 0;
+		return;
+	}
+	watchdog_time = when;
+	timer_settime(watchdog_timer, TIMER_ABSTIME, &spec, NULL);
+}
+
+#ifdef USE_SUBTEST_PROCESSES
+/**
+ * Move the deadline that copies of this test inherit ahead of ours, so
+ * that their watchdogs fire, print their backtraces and report their
+ * stuck subtests while this process is still there to forward them.  A
+ * copy's watchdog fires WATCHDOG_MARGIN before its deadline and may take
+ * as long again for the backtrace, hence the two margins.
+ */
+static void
+advance_copies_deadline(void)
+{
+	const char *env = getenv("PIGLIT_DEADLINE");
+	char value[32];
+	double deadline;
+
+	if (env == NULL)
+		return;
+
+	deadline = strtod(env, NULL);
+	if (deadline > 0) {
+		snprintf(value, sizeof(value), "%.3f",
+			 deadline - 2 * WATCHDOG_MARGIN);
+		setenv("PIGLIT_DEADLINE", value, 1);
+	}
+}
+#endif
+#endif
+
+void
+piglit_set_timeout(double seconds, enum piglit_result timeout_result)
+{
+#ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	arm_watchdog(now.tv_sec + now.tv_nsec / 1e9 + seconds, timeout_result);
 #else
 	piglit_logi("Cannot abort this test for timeout on this platform");
 #endif
 }
 
+void
+piglit_watch_deadline(void)
+{
+#ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
+	const char *env = getenv("PIGLIT_DEADLINE");
+	double deadline;
+
+	if (env == NULL)
+		return;
+
+	deadline = strtod(env, NULL);
+	if (deadline > 0)
+		arm_watchdog(deadline - WATCHDOG_MARGIN, -1);
+#endif
+}
+
 void
 piglit_report_subtest_result(enum piglit_result result, const char *format, ...)
 {
 	const char *result_str = piglit_result_to_string(result);
+	const struct piglit_result_sink *sink;
+	char name[PIGLIT_RECORD_MAX - sizeof(struct piglit_record_header)];
 	va_list ap;
+	int len;
 
 	va_start(ap, format);
+	len = vsnprintf(name, sizeof(name), format, ap);
+	va_end(ap);
+
+	sink = thread_result_sink();
+	if (sink) {
+		sink->subtest(sink->data, result, name);
+		return;
+	}
+
+#if defined(PIGLIT_HAS_PTHREADS) && !defined(_WIN32)
+	/* Keep the line intact if subtests report from several threads */
+	flockfile(stdout);
+#endif
 
 	printf("PIGLIT: {\"subtest\": {\"");
-	vprintf(format, ap);
+	if (len >= 0 && (size_t) len < sizeof(name)) {
+		fputs(name, stdout);
+	} else {
+		va_start(ap, format);
+		vprintf(format, ap);
+		va_end(ap);
+	}
 	printf("\" : \"%s\"}}\n", result_str);
 	fflush(stdout);
 
-	va_end(ap);
+#if defined(PIGLIT_HAS_PTHREADS) && !defined(_WIN32)
+	funlockfile(stdout);
+#endif
+
+	if (len > 0)
+		write_record(PIGLIT_RECORD_SUBTEST, result, 0, name,
+			     MIN2((size_t) len, sizeof(name) - 1));
 }
 
+void
+piglit_report_probe_failure(const char *format, ...)
+{
+	char text[PIGLIT_RECORD_MAX - sizeof(struct piglit_record_header)];
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = vsnprintf(text, sizeof(text), format, ap);
+	va_end(ap);
+
+	va_start(ap, format);
+	vprintf(format, ap);
+	va_end(ap);
+
+	if (len > 0) {
+		len = MIN2((size_t) len, sizeof(text) - 1);
+		if (text[len - 1] == '\n')
+			len--;
+		write_record(PIGLIT_RECORD_PROBE, PIGLIT_PASS, 0, text, len);
+	}
+}
 
 void
 piglit_disable_error_message_boxes(void)
@@ -646,6 +1144,19 @@ piglit_strip_arg(int *argc, char *argv[], const char *arg)
         return false;
 }
 
+/**
+ * Number of processes to spread subtests over, from -subtest-parallel or
+ * PIGLIT_SUBTEST_PARALLEL.
+ */
+static int subtest_parallel = 1;
+
+/**
+ * The command line without the subtest arguments, to start the processes
+ * that run a share of the subtests each.
+ */
+static int subtest_argc;
+static char **subtest_argv;
+
 void
 piglit_parse_subtest_args(int *argc, char *argv[],
 			  const struct piglit_subtest *subtests,
@@ -655,9 +1166,27 @@ piglit_parse_subtest_args(int *argc, char *argv[],
 	int j;
 	const char **selected_subtests = NULL;
 	size_t num_selected_subtests = 0;
+	const char *parallel = getenv("PIGLIT_SUBTEST_PARALLEL");
 
 	for (j = 1; j < *argc; j++) {
-		if (streq(argv[j], "-subtest")) {
+		if (streq(argv[j], "-subtest-parallel")) {
+			int i;
+
+			if (j + 1 >= *argc) {
+				piglit_loge("-subtest-parallel requires an "
+					    "argument");
+				piglit_report_result(PIGLIT_FAIL);
+			}
+
+			parallel = argv[j + 1];
+
+			/* Remove 2 arguments from the command line. */
+			for (i = j + 2; i < *argc; i++) {
+				argv[i - 2] = argv[i];
+			}
+			*argc -= 2;
+			j--;
+		} else if (streq(argv[j], "-subtest")) {
 			int i;
 
 			++j;
@@ -703,6 +1232,13 @@ piglit_parse_subtest_args(int *argc, char *argv[],
 		}
 	}
 
+	if (parallel)
+		subtest_parallel = MAX2(atoi(parallel), 1);
+
+	subtest_argc = *argc;
+	subtest_argv = malloc(*argc * sizeof(char *));
+	memcpy(subtest_argv, argv, *argc * sizeof(char *));
+
 	*out_selected_subtests = selected_subtests;
 	*out_num_selected_subtests = num_selected_subtests;
 }
@@ -721,6 +1257,264 @@ piglit_find_subtest(const struct piglit_subtest *subtests, const char *name)
 	return NULL;
 }
 
+#ifdef USE_SUBTEST_PROCESSES
+struct subtest_process {
+	pid_t pid;
+	int fd;
+	char line[4096];
+	size_t len;
+
+	/** Overall result the process reported, if any. */
+	bool has_result;
+	enum piglit_result result;
+
+	/** The process's watchdog stopped it at the deadline. */
+	bool timed_out;
+};
+
+static const char subtest_prefix[] = "PIGLIT: {\"subtest\": {\"";
+static const char result_prefix[] = "PIGLIT: {\"result\": \"";
+
+/** Parse the quoted result string at \a value. */
+static bool
+parse_result_value(const char *value, enum piglit_result *result)
+{
+	static const enum piglit_result results[] = {
+		PIGLIT_PASS, PIGLIT_FAIL, PIGLIT_SKIP, PIGLIT_WARN,
+	};
+	unsigned i;
+
+	for (i = 0; i < ARRAY_SIZE(results); i++) {
+		const char *s = piglit_result_to_string(results[i]);
+
+		if (strncmp(value, s, strlen(s)) == 0 &&
+		    value[strlen(s)] == '"') {
+			*result = results[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Forward one line of a subtest process's output.  Subtest results are
+ * recorded and merged into \a result.  The process's overall result line
+ * is kept back, since the parent reports the merged one.
+ */
+static void
+forward_subtest_line(struct subtest_process *proc, const char *line,
+		     size_t len, const struct piglit_subtest **subtests,
+		     size_t count, bool *reported, enum piglit_result *result)
+{
+	if (strncmp(line, result_prefix, strlen(result_prefix)) == 0) {
+		const char *value = line + strlen(result_prefix);
+
+		proc->has_result = parse_result_value(value, &proc->result);
+		proc->timed_out = strncmp(value, "timeout\"",
+					  strlen("timeout\"")) == 0;
+		return;
+	}
+
+	if (strncmp(line, subtest_prefix, strlen(subtest_prefix)) == 0) {
+		const char *name = line + strlen(subtest_prefix);
+		const char *end = strstr(name, "\" : \"");
+		enum piglit_result subtest_result;
+		size_t i;
+
+		for (i = 0; end && i < count; i++) {
+			if (reported[i] ||
+			    strlen(subtests[i]->name) != (size_t) (end - name) ||
+			    strncmp(subtests[i]->name, name, end - name) != 0)
+				continue;
+
+			reported[i] = true;
+			break;
+		}
+
+		if (end && parse_result_value(end + strlen("\" : \""),
+					      &subtest_result)) {
+			if (i < count)
+				piglit_merge_result(result, subtest_result);
+			write_record(PIGLIT_RECORD_SUBTEST, subtest_result,
+				     0, name, end - name);
+		} else if (end && strncmp(end + strlen("\" : \""), "timeout\"",
+					  strlen("timeout\"")) == 0) {
+			/* The copy's watchdog caught this one */
+			if (i < count)
+				piglit_merge_result(result, PIGLIT_FAIL);
+			write_record(PIGLIT_RECORD_TIMEOUT, PIGLIT_FAIL,
+				     0, name, end - name);
+		}
+	}
+
+	fwrite(line, 1, len, stdout);
+	fflush(stdout);
+}
+
+/**
+ * Run \a subtests in up to subtest_parallel copies of this test, each
+ * started with the original command line and a share of the subtests.
+ * Every copy creates its own context, so the subtests have to be
+ * independent of each other, as they already are when selected with
+ * -subtest.
+ */
+static void
+run_subtests_in_processes(const struct piglit_subtest **subtests,
+			  size_t count, enum piglit_result *result)
+{
+	unsigned num_procs = MIN2((size_t) subtest_parallel, count);
+	struct subtest_process *procs = calloc(num_procs, sizeof(*procs));
+	struct pollfd *fds = calloc(num_procs, sizeof(*fds));
+	bool *reported = calloc(count, sizeof(bool));
+	char **argv = malloc((subtest_argc + 2 * count + 3) *
+			     sizeof(char *));
+	unsigned open_fds = 0;
+	unsigned p;
+	size_t i;
+
+	piglit_logi("Running %u subtests in %u processes",
+		    (unsigned) count, num_procs);
+	fflush(stdout);
+	fflush(stderr);
+
+#ifdef PIGLIT_HAS_POSIX_TIMER_NOTIFY_THREAD
+	advance_copies_deadline();
+#endif
+
+	for (p = 0; p < num_procs; p++) {
+		int pipe_fds[2];
+		int argc = subtest_argc;
+
+		/* Deal the subtests out round-robin. */
+		memcpy(argv, subtest_argv, subtest_argc * sizeof(char *));
+		argv[argc++] = "-subtest-parallel";
+		argv[argc++] = "1";
+		for (i = p; i < count; i += num_procs) {
+			argv[argc++] = "-subtest";
+			argv[argc++] = (char *) subtests[i]->option;
+		}
+		argv[argc] = NULL;
+
+		procs[p].fd = -1;
+		if (pipe(pipe_fds) != 0) {
+			piglit_loge("pipe: %s", strerror(errno));
+			continue;
+		}
+
+		procs[p].pid = fork();
+		if (procs[p].pid == 0) {
+			/* Results reach the channel through the parent. */
+			unsetenv("PIGLIT_RESULT_FD");
+			dup2(pipe_fds[1], STDOUT_FILENO);
+			close(pipe_fds[0]);
+			close(pipe_fds[1]);
+			execvp(argv[0], argv);
+			fprintf(stderr, "%s: %s\n", argv[0], strerror(errno));
+			_exit(EXIT_FAILURE);
+		}
+
+		close(pipe_fds[1]);
+		if (procs[p].pid < 0) {
+			piglit_loge("fork: %s", strerror(errno));
+			close(pipe_fds[0]);
+			continue;
+		}
+
+		procs[p].fd = pipe_fds[0];
+		open_fds++;
+	}
+
+	while (open_fds > 0) {
+		for (p = 0; p < num_procs; p++) {
+			fds[p].fd = procs[p].fd;
+			fds[p].events = POLLIN;
+		}
+
+		if (poll(fds, num_procs, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			piglit_loge("poll: %s", strerror(errno));
+			break;
+		}
+
+		for (p = 0; p < num_procs; p++) {
+			struct subtest_process *proc = &procs[p];
+			char *newline;
+			ssize_t n;
+
+			if (proc->fd < 0 || !fds[p].revents)
+				continue;
+
+			n = read(proc->fd, proc->line + proc->len,
+				 sizeof(proc->line) - proc->len);
+			if (n <= 0) {
+				if (n < 0 && errno == EINTR)
+					continue;
+				/* Forward an unterminated last line. */
+				fwrite(proc->line, 1, proc->len, stdout);
+				close(proc->fd);
+				proc->fd = -1;
+				open_fds--;
+				continue;
+			}
+			proc->len += n;
+
+			while ((newline = memchr(proc->line, '\n',
+						 proc->len))) {
+				size_t len = newline - proc->line + 1;
+
+				forward_subtest_line(proc, proc->line, len,
+						     subtests, count,
+						     reported, result);
+				memmove(proc->line, proc->line + len,
+					proc->len - len);
+				proc->len -= len;
+			}
+
+			/* Pass overlong lines through in pieces. */
+			if (proc->len == sizeof(proc->line)) {
+				fwrite(proc->line, 1, proc->len, stdout);
+				proc->len = 0;
+			}
+		}
+	}
+
+	for (p = 0; p < num_procs; p++) {
+		if (procs[p].pid > 0)
+			waitpid(procs[p].pid, NULL, 0);
+	}
+
+	/* A process that stopped early with an overall result, as when a
+	 * subtest calls piglit_report_result(), passes that result on to the
+	 * subtests it didn't get to.  Those of a crashed or timed out process
+	 * fail.
+	 */
+	for (i = 0; i < count; i++) {
+		const struct subtest_process *proc = &procs[i % num_procs];
+		enum piglit_result subtest_result =
+			proc->has_result ? proc->result : PIGLIT_FAIL;
+
+		if (reported[i])
+			continue;
+		if (proc->timed_out)
+			piglit_loge("Subtest \"%s\" did not run before the "
+				    "deadline", subtests[i]->name);
+		else if (!proc->has_result)
+			piglit_loge("Subtest \"%s\" did not report a result",
+				    subtests[i]->name);
+		piglit_report_subtest_result(subtest_result, "%s",
+					     subtests[i]->name);
+		piglit_merge_result(result, subtest_result);
+	}
+
+	free(argv);
+	free(reported);
+	free(fds);
+	free(procs);
+}
+#endif
+
 enum piglit_result
 piglit_run_selected_subtests(const struct piglit_subtest *all_subtests,
 			     const char **selected_subtests,
@@ -728,40 +1522,57 @@ piglit_run_selected_subtests(const struct piglit_subtest *all_subtests,
 			     enum piglit_result previous_result)
 {
 	enum piglit_result result = previous_result;
+	const struct piglit_subtest **subtests;
+	size_t count = 0;
+	size_t i;
 
 	if (num_selected_subtests) {
-		unsigned i;
-
+		subtests = malloc(num_selected_subtests * sizeof(*subtests));
 		for (i = 0; i < num_selected_subtests; i++) {
-			enum piglit_result subtest_result;
 			const char *const name = selected_subtests[i];
-			const struct piglit_subtest *subtest =
-				piglit_find_subtest(all_subtests, name);
 
-			if (subtest == NULL) {
+			subtests[count] = piglit_find_subtest(all_subtests,
+							      name);
+			if (subtests[count] == NULL) {
 				piglit_loge("Unknown subtest \"%s\"", name);
 				piglit_report_result(PIGLIT_FAIL);
 			}
-
-			subtest_result = subtest->subtest_func(subtest->data);
-			piglit_report_subtest_result(subtest_result, "%s",
-						     subtest->name);
-
-			piglit_merge_result(&result, subtest_result);
+			count++;
 		}
 	} else {
-		unsigned i;
+		while (!PIGLIT_SUBTEST_END(&all_subtests[count]))
+			count++;
+		subtests = malloc(count * sizeof(*subtests));
+		for (i = 0; i < count; i++)
+			subtests[i] = &all_subtests[i];
+	}
 
-		for (i = 0; !PIGLIT_SUBTEST_END(&all_subtests[i]); i++) {
-			const enum piglit_result subtest_result =
-				all_subtests[i].subtest_func(all_subtests[i].data);
-			piglit_report_subtest_result(subtest_result, "%s",
-						     all_subtests[i].name);
+#ifdef USE_SUBTEST_PROCESSES
+	if (subtest_parallel > 1 && count > 1 && subtest_argv) {
+		run_subtests_in_processes(subtests, count, &result);
+		free(subtests);
+		return result;
+	}
+#endif
 
-			piglit_merge_result(&result, subtest_result);
-		}
+	for (i = 0; i < count; i++) {
+		const int64_t start = piglit_time_get_nano();
+		enum piglit_result subtest_result;
+
+		running_subtest = subtests[i]->name;
+		subtest_result = subtests[i]->subtest_func(subtests[i]->data);
+		running_subtest = NULL;
+
+		write_record(PIGLIT_RECORD_TIME, PIGLIT_PASS,
+			     piglit_time_get_nano() - start,
+			     subtests[i]->name, strlen(subtests[i]->name));
+		piglit_report_subtest_result(subtest_result, "%s",
+					     subtests[i]->name);
+
+		piglit_merge_result(&result, subtest_result);
 	}
 
+	free(subtests);
 	return result;
 }
 
@@ -775,6 +1586,82 @@ piglit_gettid(void)
 #endif
 }
 
+#ifdef USE_PARALLEL_FOR
+/** Most threads piglit_parallel_for() runs on, the calling one included */
+#define PARALLEL_FOR_MAX_THREADS 16
+
+struct parallel_for {
+	void (*func)(void *data, unsigned i);
+	void *data;
+	unsigned count;
+	unsigned next;
+	pthread_mutex_t lock;
+};
+
+static void *
+parallel_for_worker(void *arg)
+{
+	struct parallel_for *job = arg;
+
+	for (;;) {
+		unsigned i;
+
+		pthread_mutex_lock(&job->lock);
+		i = job->next++;
+		pthread_mutex_unlock(&job->lock);
+
+		if (i >= job->count)
+			return NULL;
+
+		job->func(job->data, i);
+	}
+}
+#endif
+
+void
+piglit_parallel_for(unsigned count, const char *env_var,
+		    void (*func)(void *data, unsigned i), void *data)
+{
+	unsigned i;
+#ifdef USE_PARALLEL_FOR
+	const char *env = env_var ? getenv(env_var) : NULL;
+	long n = env ? strtol(env, NULL, 0) : sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned num_threads = MIN2((unsigned)
+				    CLAMP(n, 1, PARALLEL_FOR_MAX_THREADS),
+				    count);
+
+	if (num_threads > 1) {
+		pthread_t threads[PARALLEL_FOR_MAX_THREADS];
+		struct parallel_for job;
+		unsigned started;
+
+		job.func = func;
+		job.data = data;
+		job.count = count;
+		job.next = 0;
+		pthread_mutex_init(&job.lock, NULL);
+
+		/* The calling thread is one of the workers. */
+		for (started = 0; started < num_threads - 1; started++) {
+			if (pthread_create(&threads[started], NULL,
+					   parallel_for_worker, &job) != 0)
+				break;
+		}
+
+		parallel_for_worker(&job);
+
+		for (i = 0; i < started; i++)
+			pthread_join(threads[i], NULL);
+
+		pthread_mutex_destroy(&job.lock);
+		return;
+	}
+#endif
+
+	for (i = 0; i < count; i++)
+		func(data, i);
+}
+
 
 size_t
 piglit_get_page_size(void)
@@ -56,6 +56,7 @@ extern "C" {
 #endif
 
 #include "piglit-log.h"
+#include "piglit-trace.h"
 
 #ifndef __has_attribute
 #define __has_attribute(x) 0
@@ -166,6 +167,15 @@ struct piglit_subtest {
 const struct piglit_subtest*
 piglit_find_subtest(const struct piglit_subtest *subtests, const char *name);
 
+/**
+ * Run the selected subtests, or all of them if none are selected, and
+ * report the result of each.
+ *
+ * With -subtest-parallel N or PIGLIT_SUBTEST_PARALLEL=N, the subtests are
+ * dealt out to N copies of the test, each running its share with -subtest,
+ * and their reports are merged.  This requires the subtests to be
+ * independent of each other and is only available on POSIX systems.
+ */
 enum piglit_result
 piglit_run_selected_subtests(const struct piglit_subtest *all_subtests,
 			     const char **selected_subtests,
@@ -277,14 +287,120 @@ bool piglit_is_extension_in_string(const char *haystack, const char *needle);
  */
 bool piglit_is_extension_in_array(const char **haystack, const char *needle);
 
+/**
+ * \brief A set of extension names with constant-time lookup.
+ *
+ * The GL, EGL, GLX and CL helpers build one of these per context, display
+ * or device instead of searching the extension string on every query.
+ */
+struct piglit_extension_set;
+
+/**
+ * Build an extension set from a space-separated extension string.
+ *
+ * A NULL \c string gives an empty set.
+ */
+struct piglit_extension_set *
+piglit_extension_set_from_string(const char *string);
+
+/**
+ * Build an extension set from a NULL-terminated array of names.
+ */
+struct piglit_extension_set *
+piglit_extension_set_from_array(const char **array);
+
+/**
+ * Determine if \c name is in \c set.  A NULL \c set is empty.
+ */
+bool piglit_extension_set_contains(const struct piglit_extension_set *set,
+				   const char *name);
+
+void piglit_extension_set_destroy(struct piglit_extension_set *set);
+
 int piglit_find_line(const char *program, int position);
 void piglit_merge_result(enum piglit_result *all, enum piglit_result subtest);
 const char * piglit_result_to_string(enum piglit_result result);
 NORETURN void piglit_report_result(enum piglit_result result);
 void piglit_set_timeout(double seconds, enum piglit_result timeout_result);
+
+/**
+ * Arm the watchdog for the deadline the runner passed in PIGLIT_DEADLINE,
+ * in seconds since the epoch.  Shortly before it, the test prints a
+ * backtrace of the calling thread and reports a timeout, instead of being
+ * killed without a word.
+ */
+void piglit_watch_deadline(void);
 void piglit_report_subtest_result(enum piglit_result result,
 				  const char *format, ...) PRINTFLIKE(2, 3);
 
+/**
+ * Where a thread's results go instead of stdout, for frameworks that run a
+ * test on several threads at once and merge the results themselves.
+ *
+ * \c subtest receives what the thread passes to
+ * piglit_report_subtest_result().  \c result receives what it passes to
+ * piglit_report_result(), and must not return: it typically longjmp()s
+ * back to where the framework started the test.
+ */
+struct piglit_result_sink {
+	void (*subtest)(void *data, enum piglit_result result,
+			const char *name);
+	void (*result)(void *data, enum piglit_result result);
+	void *data;
+};
+
+/**
+ * Send the calling thread's results to \c sink, or back to stdout if
+ * \c sink is NULL.  Where threads aren't available this has no effect.
+ */
+void piglit_set_thread_result_sink(const struct piglit_result_sink *sink);
+
+/**
+ * Print the first line of a probe failure, and record it on the result
+ * channel.
+ */
+void piglit_report_probe_failure(const char *format, ...) PRINTFLIKE(1, 2);
+
+/**
+ * \name Result channel
+ *
+ * When PIGLIT_RESULT_FD names an open file descriptor, results are also
+ * written to it as records, so the runner doesn't have to scan stdout for
+ * them.  A record is a piglit_record_header in native byte order followed
+ * by \c size bytes of text, and is written with a single write() so that
+ * records from several threads or processes don't interleave.
+ */
+/*@{*/
+enum piglit_record_type {
+	/** Overall result, from piglit_report_result() */
+	PIGLIT_RECORD_RESULT = 1,
+	/** Subtest result, the text is the subtest name */
+	PIGLIT_RECORD_SUBTEST = 2,
+	/** Subtest run time in nanoseconds, the text is the subtest name */
+	PIGLIT_RECORD_TIME = 3,
+	/** Probe failure, the text is the message */
+	PIGLIT_RECORD_PROBE = 4,
+	/**
+	 * The watchdog stopped the test at the runner's deadline, the text
+	 * is the subtest it was running, if any
+	 */
+	PIGLIT_RECORD_TIMEOUT = 5,
+};
+
+struct piglit_record_header {
+	uint8_t type;
+	/** enum piglit_result of RESULT and SUBTEST records */
+	uint8_t result;
+	uint16_t size;
+	uint32_t reserved;
+	/** Value of TIME records */
+	int64_t value;
+};
+
+/** Largest record, header included. */
+#define PIGLIT_RECORD_MAX 4096
+/*@}*/
+
 void piglit_disable_error_message_boxes(void);
 
 extern void piglit_set_rlimit(unsigned long lim);
@@ -355,6 +471,16 @@ piglit_parse_subtest_args(int *argc, char *argv[],
 uint64_t
 piglit_gettid(void);
 
+/**
+ * Call \c func(data, i) for every \c i below \c count, spread over up to
+ * one thread per CPU, the calling thread included.  The environment
+ * variable named \c env_var, if set, overrides the number of threads.
+ * Where threads aren't available the calls are made in order.
+ */
+void
+piglit_parallel_for(unsigned count, const char *env_var,
+		    void (*func)(void *data, unsigned i), void *data);
+
 size_t
 piglit_get_page_size(void);
 
@@ -29,6 +29,15 @@
 #include "piglit_ktx.h"
 #include "piglit-util-gl.h"
 
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_SYS_STAT_H) && \
+    defined(HAVE_FCNTL_H) && defined(HAVE_UNISTD_H) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define USE_MMAP
+#endif
+
 /* FIXME: Remove #defines when piglit-dispatch gains support for GLES. */
 #define GL_TEXTURE_1D				0x0DE0
 #define GL_TEXTURE_1D_ARRAY			0x8C18
@@ -68,6 +77,12 @@ struct piglit_ktx {
 	/** \brief The raw KTX data. */
 	void *data;
 
+	/**
+	 * \brief Length of the file mapping that holds \c data, or 0 if
+	 * \c data was allocated with malloc().
+	 */
+	size_t mapped_size;
+
 	/**
 	 * \brief Array of images.
 	 *
@@ -99,6 +114,13 @@ piglit_ktx_destroy(struct piglit_ktx *self)
 	if (self->images != NULL)
 		free(self->images);
 
+#ifdef USE_MMAP
+	if (self->mapped_size != 0) {
+		munmap(self->data, self->mapped_size);
+		self->data = NULL;
+	}
+#endif
+
 	if (self->data)
 		free(self->data);
 
@@ -331,13 +353,13 @@ piglit_ktx_parse_images(struct piglit_ktx *self)
 	for (miplevel = 0; miplevel < info->num_miplevels; ++miplevel) {
 		uint32_t image_size;
 
-		if (info->size < CUR_SIZE + 1) {
+		if (info->size < CUR_SIZE + sizeof(uint32_t)) {
 			/*
 			 * Reading the image size below would access
 			 * out-of-bounds memory.
 			 */
 			piglit_ktx_error("size of data stream must be at "
-					 "least %u", CUR_SIZE + 1);
+					 "least %zu", CUR_SIZE + sizeof(uint32_t));
 			return false;
 		}
 
@@ -394,7 +416,7 @@ piglit_ktx_parse_images(struct piglit_ktx *self)
 		 * The last image's data lies, at least partially, in
 		 * out-of-bounds memory.
 		 */
-		piglit_ktx_error("size of data stream must be at least %zd",
+		piglit_ktx_error("size of data stream must be at least %zu",
 				 CUR_SIZE);
 		return false;
 	}
@@ -422,6 +444,43 @@ piglit_ktx_parse_data(struct piglit_ktx *self)
 	return ok;
 }
 
+#ifdef USE_MMAP
+/**
+ * \brief Map the file read-only into self->data.
+ *
+ * Only the header and the image size fields are read while parsing, so
+ * the pages of an image are read from disk when the image is uploaded.
+ * Returns false if the file can't be mapped, and the caller should read
+ * it instead.
+ */
+static bool
+piglit_ktx_map_file(struct piglit_ktx *self, const char *filename)
+{
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return false;
+
+	self->data = map;
+	self->mapped_size = st.st_size;
+	self->info.size = st.st_size;
+	return true;
+}
+#endif
+
 struct piglit_ktx*
 piglit_ktx_read_file(const char *filename)
 {
@@ -437,6 +496,13 @@ piglit_ktx_read_file(const char *filename)
 	if (self == NULL)
 		goto out_of_memory;
 
+#ifdef USE_MMAP
+	if (piglit_ktx_map_file(self, filename)) {
+		ok = piglit_ktx_parse_data(self);
+		goto end;
+	}
+#endif
+
 	file = fopen(filename, "rb");
 	if (file == NULL)
 		goto bad_open;
@@ -453,10 +519,6 @@ piglit_ktx_read_file(const char *filename)
 	if (self->data == NULL)
 		goto out_of_memory;
 
-	/*
-	 * On Unix, one should mmap() here rather than copy. But this code
-	 * needs to support Windows too.
-	 */
 	size_read = fread(self->data, 1, self->info.size, file);
 	if (size_read < self->info.size)
 		goto bad_read;
@@ -492,7 +554,7 @@ end:
 }
 
 struct piglit_ktx*
-ktx_file_read_bytes(const void *bytes , size_t size)
+piglit_ktx_read_bytes(const void *bytes, size_t size)
 {
 	struct piglit_ktx *self;
 	bool ok = true;
@@ -503,6 +565,13 @@ ktx_file_read_bytes(const void *bytes , size_t size)
 		return NULL;
 	}
 
+	self->data = malloc(size);
+	if (self->data == NULL) {
+		piglit_ktx_error("%s", "out of memory");
+		free(self);
+		return NULL;
+	}
+
 	self->info.size = size;
 	memcpy(self->data, bytes, size);
 
@@ -153,3 +153,108 @@ unsigned float3_to_r11g11b10f(const float rgb[3])
           ((f32_to_uf11(rgb[1]) & 0x7ff) << 11) |
           ((f32_to_uf10(rgb[2]) & 0x3ff) << 22);
 }
+
+static float uf_to_f32(unsigned val, unsigned mantissa_bits)
+{
+   union {
+      float f;
+      uint32_t ui;
+   } f32;
+   unsigned exponent = val >> mantissa_bits;
+   unsigned mantissa = val & ((1u << mantissa_bits) - 1);
+
+   if (exponent == 0) {
+      /* Zero or denormal: 2^-14 * (M / 2^mantissa_bits) */
+      return mantissa * (1.0f / (1 << 14)) / (1 << mantissa_bits);
+   } else if (exponent == 31) {
+      f32.ui = F32_INFINITY | mantissa;
+   } else {
+      f32.ui = (exponent - 15 + 127) << 23 |
+               mantissa << (23 - mantissa_bits);
+   }
+
+   return f32.f;
+}
+
+float uf11_to_f32(unsigned val)
+{
+   return uf_to_f32(val & 0x7ff, UF11_EXPONENT_SHIFT);
+}
+
+float uf10_to_f32(unsigned val)
+{
+   return uf_to_f32(val & 0x3ff, UF10_EXPONENT_SHIFT);
+}
+
+void r11g11b10f_to_float3(unsigned rgb, float retval[3])
+{
+   retval[0] = uf11_to_f32(rgb);
+   retval[1] = uf11_to_f32(rgb >> 11);
+   retval[2] = uf10_to_f32(rgb >> 22);
+}
+
+/*
+ * f32_to_uf11() and f32_to_uf10() on the bits of the float.  The bits of a
+ * normal positive float from bit 23 - mantissa_bits up are already the
+ * exponent and truncated mantissa of the small float, only with the bias
+ * of 127 instead of 15.  max_finite is the bits of the largest finite
+ * value, that larger values are clamped to.
+ */
+static inline unsigned f32_bits_to_uf(uint32_t bits, unsigned mantissa_bits,
+                                      uint32_t max_finite)
+{
+   const unsigned inf = 31u << mantissa_bits;
+
+   if ((bits & 0x7fffffff) > F32_INFINITY)
+      return inf | 1; /* NaN of either sign */
+   if (bits & 0x80000000)
+      return 0; /* negative, including -0.0 and -Inf */
+   if (bits == F32_INFINITY)
+      return inf;
+   if (bits > max_finite)
+      bits = max_finite;
+   if (bits < (127u - 14) << 23)
+      return 0; /* denormal in the small float */
+
+   return (bits >> (23 - mantissa_bits)) - ((127u - 15) << mantissa_bits);
+}
+
+void float3_to_r11g11b10f_array(const float *rgb, unsigned *out,
+                                unsigned count)
+{
+   /* 65024 and 64512 */
+   const uint32_t uf11_max = (127u + 15) << 23 | 0x3fu << 17;
+   const uint32_t uf10_max = (127u + 15) << 23 | 0x1fu << 18;
+   unsigned i;
+
+   for (i = 0; i < count; i++) {
+      uint32_t bits[3];
+
+      memcpy(bits, &rgb[3 * i], sizeof(bits));
+      out[i] = f32_bits_to_uf(bits[0], UF11_EXPONENT_SHIFT, uf11_max) |
+               f32_bits_to_uf(bits[1], UF11_EXPONENT_SHIFT, uf11_max) << 11 |
+               f32_bits_to_uf(bits[2], UF10_EXPONENT_SHIFT, uf10_max) << 22;
+   }
+}
+
+void r11g11b10f_to_float3_array(const unsigned *in, float *rgb,
+                                unsigned count)
+{
+   static float uf11[1 << 11], uf10[1 << 10];
+   static bool tables_built = false;
+   unsigned i;
+
+   if (!tables_built) {
+      for (i = 0; i < ARRAY_SIZE(uf11); i++)
+         uf11[i] = uf11_to_f32(i);
+      for (i = 0; i < ARRAY_SIZE(uf10); i++)
+         uf10[i] = uf10_to_f32(i);
+      tables_built = true;
+   }
+
+   for (i = 0; i < count; i++) {
+      rgb[3 * i + 0] = uf11[in[i] & 0x7ff];
+      rgb[3 * i + 1] = uf11[(in[i] >> 11) & 0x7ff];
+      rgb[3 * i + 2] = uf10[(in[i] >> 22) & 0x3ff];
+   }
+}
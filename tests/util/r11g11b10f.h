@@ -32,6 +32,16 @@ unsigned f32_to_uf11(float val);
 unsigned f32_to_uf10(float val);
 unsigned float3_to_r11g11b10f(const float rgb[3]);
 
+float uf11_to_f32(unsigned val);
+float uf10_to_f32(unsigned val);
+void r11g11b10f_to_float3(unsigned rgb, float retval[3]);
+
+/* Convert count RGB triples at a time. */
+void float3_to_r11g11b10f_array(const float *rgb, unsigned *out,
+                                unsigned count);
+void r11g11b10f_to_float3_array(const unsigned *in, float *rgb,
+                                unsigned count);
+
 #ifdef __cplusplus
 }
 #endif
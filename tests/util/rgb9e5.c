@@ -26,6 +26,8 @@
 #include "rgb9e5.h"
 #include <math.h>
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
 #define MAX2( A, B )   ( (A)>(B) ? (A) : (B) )
 
@@ -175,3 +177,108 @@ void rgb9e5_to_float3(unsigned rgb, float retval[3])
    retval[1] = v.field.g * scale;
    retval[2] = v.field.b * scale;
 }
+
+/* Batch versions.  These work on the IEEE bits directly instead of going
+ * through pow() and floor(), and give the same results as the functions
+ * above.
+ */
+
+static uint32_t FloatBits(float x)
+{
+   uint32_t bits;
+   memcpy(&bits, &x, sizeof(bits));
+   return bits;
+}
+
+static float BitsFloat(uint32_t bits)
+{
+   float x;
+   memcpy(&x, &bits, sizeof(x));
+   return x;
+}
+
+/* Clamp to [0, MAX_RGB9E5] like ClampRange_for_rgb9e5, on the bits.
+ * Positive floats sort like their bit patterns, so this is integer
+ * compares only.  Negative values and NaN become 0.
+ */
+static uint32_t ClampBits_for_rgb9e5(uint32_t bits, uint32_t max_bits)
+{
+   if (bits & 0x80000000u)
+      return 0;
+   if (bits > 0x7f800000u)
+      return 0;
+   return bits < max_bits ? bits : max_bits;
+}
+
+/* Return round-half-up(x * 2^shift) for a non-negative float given by
+ * its bits, where the result is known to fit in 10 bits.
+ */
+static int ScaleAndRound(uint32_t bits, int shift)
+{
+   int biasedexponent = bits >> 23;
+   uint32_t mantissa = bits & 0x7fffff;
+   int s;
+
+   if (biasedexponent == 0) {
+      /* Denormal: same scale as the smallest normal, no implicit bit. */
+      biasedexponent = 1;
+   } else {
+      mantissa |= 0x800000;
+   }
+
+   /* x = mantissa * 2^(biasedexponent - 150) */
+   s = 150 - biasedexponent - shift;
+   if (s <= 0)
+      return mantissa << -s;
+   if (s > 25)
+      return 0;
+   return (mantissa + (1u << (s - 1))) >> s;
+}
+
+void float3_to_rgb9e5_array(const float *rgb, unsigned *out, unsigned count)
+{
+   const uint32_t max_bits = FloatBits(MAX_RGB9E5);
+   unsigned i;
+
+   for (i = 0; i < count; i++) {
+      uint32_t r = ClampBits_for_rgb9e5(FloatBits(rgb[3 * i + 0]), max_bits);
+      uint32_t g = ClampBits_for_rgb9e5(FloatBits(rgb[3 * i + 1]), max_bits);
+      uint32_t b = ClampBits_for_rgb9e5(FloatBits(rgb[3 * i + 2]), max_bits);
+      uint32_t maxbits = MAX2(MAX2(r, g), b);
+      int exp_shared, shift, maxm;
+
+      exp_shared = MAX2(-RGB9E5_EXP_BIAS - 1, (int)(maxbits >> 23) - 127) +
+                   1 + RGB9E5_EXP_BIAS;
+
+      /* Mantissas are x / 2^(exp_shared - bias - mantissa bits). */
+      shift = RGB9E5_EXP_BIAS + RGB9E5_MANTISSA_BITS - exp_shared;
+      maxm = ScaleAndRound(maxbits, shift);
+      if (maxm == MAX_RGB9E5_MANTISSA + 1) {
+         exp_shared += 1;
+         shift -= 1;
+      }
+
+      out[i] = ScaleAndRound(r, shift) |
+               ScaleAndRound(g, shift) << RGB9E5_MANTISSA_BITS |
+               ScaleAndRound(b, shift) << (2 * RGB9E5_MANTISSA_BITS) |
+               (unsigned)exp_shared << (3 * RGB9E5_MANTISSA_BITS);
+   }
+}
+
+void rgb9e5_to_float3_array(const unsigned *in, float *rgb, unsigned count)
+{
+   const unsigned mask = MAX_RGB9E5_MANTISSA;
+   unsigned i;
+
+   for (i = 0; i < count; i++) {
+      unsigned v = in[i];
+      int exponent = (v >> (3 * RGB9E5_MANTISSA_BITS)) -
+                     RGB9E5_EXP_BIAS - RGB9E5_MANTISSA_BITS;
+      /* exponent is in [-24, 7], so 2^exponent is a normal float. */
+      float scale = BitsFloat((uint32_t)(exponent + 127) << 23);
+
+      rgb[3 * i + 0] = (v & mask) * scale;
+      rgb[3 * i + 1] = ((v >> RGB9E5_MANTISSA_BITS) & mask) * scale;
+      rgb[3 * i + 2] = ((v >> (2 * RGB9E5_MANTISSA_BITS)) & mask) * scale;
+   }
+}
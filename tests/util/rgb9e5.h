@@ -31,6 +31,12 @@ extern "C" {
 void rgb9e5_to_float3(unsigned rgb, float retval[3]);
 unsigned float3_to_rgb9e5(const float rgb[3]);
 
+/* Convert count RGB triples at a time.  Same results as the functions
+ * above.
+ */
+void rgb9e5_to_float3_array(const unsigned *in, float *rgb, unsigned count);
+void float3_to_rgb9e5_array(const float *rgb, unsigned *out, unsigned count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,8 +23,11 @@
 from __future__ import (
     absolute_import, division, print_function, unicode_literals
 )
+import gzip
+import io
 import tempfile
 import textwrap
+import time
 import os
 
 try:
@@ -49,9 +52,10 @@ from framework.test.base import (
     TestRunError,
     ValgrindMixin,
     WindowResizeMixin,
+    _read_bounded,
 )
 from framework.options import _Options as Options
-from framework import log, dmesg
+from framework import log, dmesg, forkserver
 
 # pylint: disable=invalid-name
 
@@ -220,6 +224,45 @@ def test_timeout_pass():
     nt.eq_(test.result.result, 'pass')
 
 
+def test_timeout_deadline():
+    """test.base.Test: Passes the deadline to the test in PIGLIT_DEADLINE"""
+    if six.PY2:
+        utils.module_check('subprocess32')
+    utils.binary_check('sh')
+
+    test = TimeoutTest(['sh', '-c', 'printf %s "$PIGLIT_DEADLINE"'])
+    test.timeout = 10
+    start = time.time()
+    test.run()
+    # The deadline is passed with millisecond precision
+    nt.ok_(start + 9.999 <= float(test.result.out) <= time.time() + 10,
+           msg=test.result.out)
+
+
+@attr('slow')
+@nt.timed(4)
+def test_timeout_sigterm_ignored():
+    """test.base.Test: Kills a timed out test that ignores SIGTERM"""
+    if six.PY2:
+        utils.module_check('subprocess32')
+    utils.binary_check('sh')
+
+    test = TimeoutTest(['sh', '-c', 'trap "" TERM; sleep 60'])
+    test.timeout = 1
+    test.run()
+    nt.eq_(test.result.result, 'timeout')
+    nt.ok_('seconds after it' in test.result.out, msg=test.result.out)
+
+
+def test_interpret_result_timeout():
+    """test.base.Test.interpret_result: Keeps a timeout the test reported"""
+    test = TimeoutTest(['foo'])
+    test.result.result = 'timeout'
+    test.result.returncode = 1
+    test.interpret_result()
+    nt.eq_(test.result.result, 'timeout')
+
+
 def test_WindowResizeMixin_rerun():
     """test.base.WindowResizeMixin: runs multiple when spurious resize detected
     """
@@ -265,6 +308,47 @@ def test_run_command_early():
     test.run()
 
 
+@mock.patch('framework.test.base.forkserver.run')
+@mock.patch('framework.test.base.options.OPTIONS', new_callable=Options)
+def test_run_command_fork_server(mock_opts, mock_run):
+    """test.base.Test._run_command: uses the fork server when enabled"""
+    class _Test(TestTest):
+        _fork_server = True
+
+    mock_opts.fork_server = True
+    mock_run.return_value = forkserver.Run(42, b'out', b'err', -6, 0, 0, 0)
+
+    test = _Test(['foo'])
+    test._run_command()  # pylint: disable=protected-access
+    nt.eq_(mock_run.call_args[0][0], ['foo'])
+    nt.eq_((test.result.pid, test.result.out, test.result.returncode),
+           (42, 'out', -6))
+
+
+def test_read_bounded_fits():
+    """test.base._read_bounded: returns output within the limit as is"""
+    nt.eq_(_read_bounded(io.BytesIO(b'a\nb\n'), 4), (b'a\nb\n', None))
+
+
+def test_read_bounded_spill():
+    """test.base._read_bounded: keeps head, tail and PIGLIT: lines"""
+    output = (b'head\n' + b'middle\n' * 100 + b'PIGLIT: {"subtest": 1}\n' +
+              b'middle\n' * 100 + b'tail\n')
+    with utils.tempdir() as tdir:
+        spill_path = os.path.join(tdir, 'test.out.gz')
+        data, spilled = _read_bounded(io.BytesIO(output), 12, spill_path,
+                                      keep_piglit=True,
+                                      spill_name='output/test.out.gz')
+        with gzip.open(spill_path, 'rb') as f:
+            nt.eq_(f.read(), output)
+
+    nt.eq_(spilled, 'output/test.out.gz')
+    lines = data.split(b'\n')
+    nt.eq_(lines[0], b'head')
+    nt.assert_in(b'bytes of output omitted, see output/test.out.gz', lines[1])
+    nt.eq_(lines[2:], [b'PIGLIT: {"subtest": 1}', b'tail', b''])
+
+
 @nt.raises(AssertionError)
 def test_no_string():
     """test.base.Test.__init__: Asserts if it is passed a string instead of a list"""
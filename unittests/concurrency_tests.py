@@ -0,0 +1,70 @@
+# Copyright (c) 2026 The Piglit project
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for the concurrency module."""
+
+from __future__ import (
+    absolute_import, division, print_function, unicode_literals
+)
+
+import nose.tools as nt
+
+from framework import concurrency
+from framework.concurrency import Sample
+from . import utils
+
+
+def test_next_width_memory():
+    """concurrency.next_width: halves the width when memory runs low"""
+    nt.eq_(concurrency.next_width(8, 16, 8, Sample(0.5, 2, 0.05)), 4)
+
+
+def test_next_width_oversubscribed():
+    """concurrency.next_width: shrinks while too many threads are runnable"""
+    nt.eq_(concurrency.next_width(8, 16, 8, Sample(1.0, 40, 0.5)), 7)
+
+
+def test_next_width_idle():
+    """concurrency.next_width: grows while CPUs are idle"""
+    nt.eq_(concurrency.next_width(8, 16, 8, Sample(0.3, 4, 0.5)), 9)
+
+
+def test_next_width_bounds():
+    """concurrency.next_width: stays between 1 and max_width"""
+    nt.eq_(concurrency.next_width(16, 16, 8, Sample(0.1, 1, 0.5)), 16)
+    nt.eq_(concurrency.next_width(1, 16, 8, Sample(1.0, 40, 0.5)), 1)
+
+
+def test_controller_fixed():
+    """concurrency.Controller: gives no thread budget when not adapting"""
+    controller = concurrency.Controller(cpus=4)
+    nt.eq_((controller.width, controller.max_width), (4, 4))
+    with controller.slot() as budget:
+        nt.eq_(budget, None)
+    nt.eq_(controller.completed, 1)
+
+
+def test_controller_budget():
+    """concurrency.Controller: splits the CPUs between running tests"""
+    utils.platform_check('linux')
+    controller = concurrency.Controller(adaptive=True, cpus=8)
+    controller.width = 4
+    with controller.slot() as budget:
+        nt.eq_(budget, 2)
@@ -0,0 +1,163 @@
+# Copyright (c) 2026 The Piglit project
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for the forkserver module."""
+
+from __future__ import (
+    absolute_import, division, print_function, unicode_literals
+)
+import os
+import stat
+import sys
+import textwrap
+
+import nose.tools as nt
+
+from framework import forkserver
+from . import utils
+
+# Answers every request like a test that printed its arguments and aborted.
+# The comment stands in for the hook of the GL test framework.
+_FAKE_SERVER = textwrap.dedent("""\
+    # piglit_gl_fork_server
+    import socket, sys
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.bind(sys.argv[2])
+    sock.listen(1)
+    while True:
+        conn, _ = sock.accept()
+        data = b''
+        while True:
+            chunk = conn.recv(4096)
+            if not chunk:
+                break
+            data += chunk
+        fields = data.split(b'\\0')
+        argc = int(fields[3])
+        with open(fields[1], 'wb') as f:
+            f.write(b' '.join(fields[5:4 + argc]))
+        conn.sendall(b'pid 1234\\nsignal 6\\nrusage 0.5 0.25 1024\\n')
+        conn.close()
+    """)
+
+
+# Answers every request with the value of SERVER_ONLY in its own environment.
+_ENV_SERVER = _FAKE_SERVER.replace(
+    'import socket, sys', 'import os, socket, sys').replace(
+        "f.write(b' '.join(fields[5:4 + argc]))",
+        "f.write(os.environ.get('SERVER_ONLY', '').encode())")
+
+
+def _write_script(directory, name, shebang, body):
+    path = os.path.join(directory, name)
+    with open(path, 'w') as f:
+        f.write('#!{}\n{}'.format(shebang, body))
+    os.chmod(path, stat.S_IRWXU)
+    return path
+
+
+def test_run():
+    """forkserver.run: passes the command and reports the result"""
+    utils.platform_check('linux')
+    with utils.tempdir() as tdir:
+        binary = _write_script(tdir, 'server', sys.executable, _FAKE_SERVER)
+        # The first test of a binary runs directly
+        with nt.assert_raises(forkserver.ForkServerUnavailable):
+            forkserver.run([binary], tdir, {})
+        run = forkserver.run([binary, '-auto', '-fbo'], tdir, {'A': 'b'})
+
+    nt.eq_(run.pid, 1234)
+    nt.eq_(run.out, b'-auto -fbo')
+    nt.eq_(run.returncode, -6)
+    nt.eq_((run.utime, run.stime, run.maxrss), (0.5, 0.25, 1024))
+    forkserver._stop_servers()  # pylint: disable=protected-access
+
+
+def test_server_env():
+    """forkserver.run: starts the server with server_env, not the test's env"""
+    utils.platform_check('linux')
+    with utils.tempdir() as tdir:
+        binary = _write_script(tdir, 'server', sys.executable, _ENV_SERVER)
+        with nt.assert_raises(forkserver.ForkServerUnavailable):
+            forkserver.run([binary], tdir, {})
+        run = forkserver.run([binary], tdir, {'SERVER_ONLY': 'test'},
+                             server_env={'SERVER_ONLY': 'base'})
+
+    nt.eq_(run.out, b'base')
+    forkserver._stop_servers()  # pylint: disable=protected-access
+
+
+@nt.raises(forkserver.ForkServerUnavailable)
+def test_other_platform():
+    """forkserver.run: tests for another platform are run directly"""
+    forkserver.run(['test'], None, {'PIGLIT_PLATFORM': 'gbm'},
+                   server_env={'PIGLIT_PLATFORM': 'glx'})
+
+
+@nt.raises(forkserver.ForkServerUnavailable)
+def test_no_server():
+    """forkserver.run: binaries without a server are run directly"""
+    utils.platform_check('linux')
+    with utils.tempdir() as tdir:
+        binary = _write_script(tdir, 'test', '/bin/sh',
+                               '# piglit_gl_fork_server\nexit 1\n')
+        for _ in range(2):
+            try:
+                forkserver.run([binary], tdir, {})
+            except forkserver.ForkServerUnavailable:
+                pass
+        # The next attempt fails without starting the binary again
+        os.unlink(binary)
+        forkserver.run([binary], tdir, {})
+
+
+def test_no_hook():
+    """forkserver.run: binaries without the hook are never started as a server"""
+    utils.platform_check('linux')
+    with utils.tempdir() as tdir:
+        marker = os.path.join(tdir, 'started')
+        binary = _write_script(tdir, 'test', '/bin/sh',
+                               'touch {}\nsleep 10\n'.format(marker))
+        for _ in range(2):
+            with nt.assert_raises(forkserver.ForkServerUnavailable):
+                forkserver.run([binary], tdir, {})
+        nt.assert_false(os.path.exists(marker))
+
+
+def test_max_servers():
+    """forkserver.run: stops the least recently used server"""
+    utils.platform_check('linux')
+    max_servers = forkserver.MAX_SERVERS
+    forkserver.MAX_SERVERS = 1
+    try:
+        with utils.tempdir() as tdir:
+            binaries = [
+                _write_script(tdir, name, sys.executable, _FAKE_SERVER)
+                for name in ['a', 'b']]
+            for binary in binaries + binaries:
+                try:
+                    forkserver.run([binary], tdir, {})
+                except forkserver.ForkServerUnavailable:
+                    pass
+            # pylint: disable=protected-access
+            nt.eq_(list(forkserver._SERVERS), [binaries[1]])
+    finally:
+        forkserver.MAX_SERVERS = max_servers
+        forkserver._stop_servers()  # pylint: disable=protected-access
@@ -29,6 +29,8 @@ try:
 except ImportError:
     import mock
 
+import struct
+
 import nose.tools as nt
 
 from . import utils
@@ -69,6 +71,43 @@ def test_piglittest_interpret_result_subtest():
     nt.eq_(test.result.subtests['subtest'], 'pass')
 
 
+def _record(type_, result, value, text):
+    text = text.encode('utf-8')
+    return struct.pack(str('=BBHIq'), type_, result, len(text), 0,
+                       value) + text
+
+
+def test_piglittest_interpret_result_records():
+    """test.piglit_test.PiglitBaseTest.interpret_result(): prefers records"""
+    test = PiglitBaseTest(['foo'])
+    test.result.out = ('PIGLIT: {"subtest": {"stale": "pass"}}\n'
+                       'PIGLIT: {"result": "pass"}\n')
+    test.result.returncode = 1
+    # pylint: disable=protected-access
+    test._records = (_record(3, 0, 1500000000, 'sub one') +
+                     _record(2, 1, 0, 'sub one') +
+                     _record(4, 0, 0, 'Probe color at (1,2)') +
+                     _record(1, 1, 0, ''))
+    test.interpret_result()
+    nt.eq_(test.result.result, 'fail')
+    nt.eq_(dict(test.result.subtests), {'sub one': 'fail'})
+    nt.eq_(test.result.profile, {'time: sub one': 1.5})
+    nt.eq_(test.result.probes, ['Probe color at (1,2)'])
+
+
+def test_piglittest_interpret_result_watchdog():
+    """test.piglit_test.PiglitBaseTest.interpret_result(): keeps a watchdog timeout"""
+    test = PiglitBaseTest(['foo'])
+    test.result.out = 'PIGLIT: {"result": "timeout" }\n'
+    test.result.returncode = 1
+    # pylint: disable=protected-access
+    test._records = _record(2, 0, 0, 'sub one') + _record(5, 1, 0, 'sub two')
+    test.interpret_result()
+    nt.eq_(test.result.result, 'timeout')
+    nt.eq_(dict(test.result.subtests),
+           {'sub one': 'pass', 'sub two': 'timeout'})
+
+
 def test_piglitest_no_clobber():
     """test.piglit_test.PiglitBaseTest.interpret_result(): does not clobber subtest entires"""
     test = PiglitBaseTest(['a', 'command'])
@@ -96,6 +135,15 @@ def test_piglittest_command_getter_concurrent():
     nt.assert_in('-fbo', test.command)
 
 
+@mock.patch('framework.test.piglit_test.options.OPTIONS', new_callable=Options)
+def test_piglittest_command_getter_serial_surfaceless(mock_opts):
+    """test.piglit_test.PiglitGLTest.command: adds -fbo to serial tests on surfaceless_egl"""
+    mock_opts.env['PIGLIT_PLATFORM'] = 'surfaceless_egl'
+    test = PiglitGLTest(['foo'])
+    nt.assert_in('-auto', test.command)
+    nt.assert_in('-fbo', test.command)
+
+
 def test_PiglitGLTest_include_and_exclude():
     """test.piglit_test.PiglitGLTest.is_skip(): raises if include and exclude are given."""
     with nt.assert_raises(AssertionError):
@@ -23,6 +23,8 @@
 from __future__ import (
     absolute_import, division, print_function, unicode_literals
 )
+import gzip
+import os
 
 import nose.tools as nt
 import six
@@ -218,6 +220,9 @@ class TestTestResult_to_json(object):
         test.exception = 'an exception'
         test.dmesg = 'this is dmesg'
         test.pid = 1934
+        test.profile = {'cl_build': {'count': 1, 'time_ns': 100}}
+        test.spilled = {'out': 'output/foo.out.gz'}
+        test.probes = ['Probe color at (1,2)']
         test.traceback = 'a traceback'
 
         cls.test = test
@@ -272,6 +277,18 @@ class TestTestResult_to_json(object):
         """results.TestResult.to_json: Adds the pid attribute"""
         nt.eq_(self.test.pid, self.json['pid'])
 
+    def test_profile(self):
+        """results.TestResult.to_json: Adds the profile attribute"""
+        nt.eq_(self.test.profile, self.json['profile'])
+
+    def test_spilled(self):
+        """results.TestResult.to_json: Adds the spilled attribute"""
+        nt.eq_(self.test.spilled, self.json['spilled'])
+
+    def test_probes(self):
+        """results.TestResult.to_json: Adds the probes attribute"""
+        nt.eq_(self.test.probes, self.json['probes'])
+
     def test_traceback(self):
         """results.TestResult.to_json: Adds the traceback attribute"""
         nt.eq_(self.test.traceback, self.json['traceback'])
@@ -298,6 +315,9 @@ class TestTestResult_from_dict(object):
             'exception': 'an exception',
             'dmesg': 'this is dmesg',
             'pid': 1934,
+            'profile': {'cl_build': {'count': 1, 'time_ns': 100}},
+            'spilled': {'err': 'output/foo.err.gz'},
+            'probes': ['Probe color at (1,2)'],
         }
 
         cls.test = results.TestResult.from_dict(cls.dict)
@@ -354,6 +374,33 @@ class TestTestResult_from_dict(object):
         """results.TestResult.from_dict: sets pid properly"""
         nt.eq_(self.test.pid, self.dict['pid'])
 
+    def test_profile(self):
+        """results.TestResult.from_dict: sets profile properly"""
+        nt.eq_(self.test.profile, self.dict['profile'])
+
+    def test_spilled(self):
+        """results.TestResult.from_dict: sets spilled properly"""
+        nt.eq_(self.test.spilled, self.dict['spilled'])
+
+    def test_probes(self):
+        """results.TestResult.from_dict: sets probes properly"""
+        nt.eq_(self.test.probes, self.dict['probes'])
+
+
+def test_TestResult_full_output():
+    """results.TestResult.full_output: reads spilled output back"""
+    with utils.tempdir() as tdir:
+        os.mkdir(os.path.join(tdir, 'output'))
+        with gzip.open(os.path.join(tdir, 'output', 'foo.out.gz'), 'wb') as f:
+            f.write(b'all of it')
+
+        test = results.TestResult()
+        test.out = 'some of it'
+        test.err = 'err'
+        test.spilled = {'out': os.path.join('output', 'foo.out.gz')}
+        nt.eq_(test.full_output('out', tdir), 'all of it')
+        nt.eq_(test.full_output('err', tdir), 'err')
+
 
 def test_TestResult_update():
     """results.TestResult.update: result is updated"""
@@ -369,6 +416,14 @@ def test_TestResult_update_subtests():
     nt.eq_(test.subtests['result'], 'incomplete')
 
 
+def test_TestResult_update_profile():
+    """results.TestResult.update: profile is updated"""
+    test = results.TestResult('pass')
+    test.update({'profile': {'cl_kernel': {'count': 2}}})
+    test.update({'profile': {'cl_read': {'count': 1}}})
+    nt.eq_(test.profile, {'cl_kernel': {'count': 2}, 'cl_read': {'count': 1}})
+
+
 class TestStringDescriptor(object):
     """Test class for StringDescriptor."""
     @classmethod
@@ -0,0 +1,92 @@
+# Copyright (c) 2026 The Piglit project
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for the trace module."""
+
+from __future__ import (
+    absolute_import, division, print_function, unicode_literals
+)
+import json
+import os
+
+import nose.tools as nt
+
+from framework import trace
+from . import utils
+
+
+def _write_trace(directory, name, events):
+    with open(trace.trace_path(directory, name), 'w') as f:
+        json.dump({'traceEvents': events}, f)
+
+
+def test_trace_path_unique():
+    """trace.trace_path: test names with separators map to one file"""
+    path = trace.trace_path('dir', 'spec@arb_foo@a/b')
+    nt.eq_(os.path.dirname(path), 'dir')
+    nt.assert_not_in('/', os.path.basename(path))
+
+
+def test_merge():
+    """trace.merge: names each test's process and keeps its events"""
+    event = {'name': 'piglit_init', 'ph': 'X', 'ts': 1, 'dur': 2,
+             'pid': 42, 'tid': 42}
+    with utils.tempdir() as tdir:
+        _write_trace(tdir, 'spec@arb_foo@a/b', [event])
+        out = os.path.join(tdir, 'out')
+        trace.merge(tdir, out)
+        with open(out) as f:
+            events = json.load(f)['traceEvents']
+
+    nt.eq_(events, [
+        {'name': 'process_name', 'ph': 'M', 'pid': 1,
+         'args': {'name': 'spec@arb_foo@a/b'}},
+        dict(event, pid=1),
+    ])
+
+
+def test_merge_reused_pid():
+    """trace.merge: tests that ran with the same pid get separate processes"""
+    event = {'name': 'piglit_init', 'ph': 'X', 'ts': 1, 'dur': 2,
+             'pid': 42, 'tid': 42}
+    meta = {'name': 'process_name', 'ph': 'M', 'pid': 42,
+            'args': {'name': 'binary'}}
+    with utils.tempdir() as tdir:
+        _write_trace(tdir, 'a', [meta, event])
+        _write_trace(tdir, 'b', [meta, event])
+        out = os.path.join(tdir, 'out')
+        trace.merge(tdir, out)
+        with open(out) as f:
+            events = json.load(f)['traceEvents']
+
+    nt.eq_([(e['ph'], e['pid']) for e in events],
+           [('M', 1), ('X', 1), ('M', 2), ('X', 2)])
+    nt.eq_([e['args']['name'] for e in events if e['ph'] == 'M'], ['a', 'b'])
+
+
+def test_merge_skips_truncated():
+    """trace.merge: skips trace files that aren't valid JSON"""
+    with utils.tempdir() as tdir:
+        with open(trace.trace_path(tdir, 'crashed'), 'w') as f:
+            f.write('{"traceEvents": [')
+        out = os.path.join(tdir, 'out')
+        trace.merge(tdir, out)
+        with open(out) as f:
+            nt.eq_(json.load(f)['traceEvents'], [])